@@ -18,6 +18,7 @@
 //#define QBOOT_USING_GZIP
 //#define QBOOT_USING_QUICKLZ
 //#define QBOOT_USING_FASTLZ
+//#define QBOOT_USING_LZ4
 //#define QBOOT_USING_SHELL
 //#define QBOOT_USING_SYSWATCH
 //#define QBOOT_USING_OTA_DOWNLOAD
@@ -25,6 +26,27 @@
 //#define QBOOT_USING_STATUS_LED
 //#define QBOOT_USING_FACTORY_KEY
 #define QBOOT_USING_APP_CHECK
+//#define QBOOT_USING_FAST_BOOT
+//#define QBOOT_USING_FUSED_RELEASE
+//#define QBOOT_USING_HW_CRC
+//#define QBOOT_USING_CRC_SLICE8
+//#define QBOOT_USING_PIPELINE
+//#define QBOOT_USING_DIFF_WRITE
+//#define QBOOT_USING_LAZY_ERASE
+//#define QBOOT_USING_AB_SLOT
+//#define QBOOT_USING_BANK_SWAP
+//#define QBOOT_USING_EARLY_JUMP
+//#define QBOOT_USING_STATS
+//#define QBOOT_USING_BENCH
+//#define QBOOT_USING_BLOCK_INDEX
+//#define QBOOT_USING_RESUME
+//#define QBOOT_USING_MAPPED_READ
+//#define QBOOT_USING_STREAM
+//#define QBOOT_USING_HW_AES
+//#define QBOOT_USING_MANIFEST
+//#define QBOOT_USING_PROGRESS_QUIET
+//#define QBOOT_USING_CHECK_CACHE
+//#define QBOOT_USING_FAST_JUMP
 #define QBOOT_RELEASE_SIGN_ALIGN_SIZE   8//can is 4, 8, 16
 #define QBOOT_RELEASE_SIGN_WORD         0x5555AAAA
 
@@ -55,6 +77,24 @@
 #endif
 #endif
 
+#ifdef QBOOT_USING_EARLY_JUMP
+#ifndef QBOOT_EARLY_JUMP_EXPORT
+#define QBOOT_EARLY_JUMP_EXPORT         INIT_BOARD_EXPORT//use INIT_ENV_EXPORT if the download partition needs a device driver
+#endif
+#endif
+
+#ifdef QBOOT_USING_RESUME
+#ifndef QBOOT_RESUME_INTERVAL
+#define QBOOT_RESUME_INTERVAL           (32 * 1024)//code bytes released between two checkpoints, each checkpoint is a record of qbtmeta
+#endif
+#endif
+
+#ifdef QBOOT_USING_CHECK_CACHE
+#ifndef QBOOT_CHECK_CACHE_EPOCH
+#define QBOOT_CHECK_CACHE_EPOCH         1//change it to check the cached factory package again, e.g. when the check is changed
+#endif
+#endif
+
 #ifdef  RT_APP_PART_ADDR
 #define QBOOT_APP_ADDR                  RT_APP_PART_ADDR
 #else
@@ -79,6 +119,17 @@
 #define QBOOT_FACTORY_PART_NAME         "factory"
 #endif
 
+u32 qbt_app_addr_get(void);//address of application to be jumped to
+#ifdef QBOOT_USING_EARLY_JUMP
+bool qbt_early_jump_check(void);//weak, return false to go on with the full boot, e.g. when the shell is requested, it is false by default with QBOOT_USING_SHELL
+#endif
+#ifdef QBOOT_USING_STREAM
+bool qbt_stream_begin(void);//release a package while it is received, the destination is named by the package header
+bool qbt_stream_feed(const u8 *buf, u32 len);//datas of package in order from the header, any length
+bool qbt_stream_end(void);//package and code are verified, firmware information is written to the destination
+void qbt_stream_abort(void);//the destination is invalidated if it has been erased
+#endif
+
 #ifdef QBOOT_USING_AES
 #ifndef QBOOT_AES_IV
 #define QBOOT_AES_IV                    "0123456789ABCDEF"
@@ -100,6 +151,24 @@
 #endif
 #endif
 
+#ifndef QBOOT_BLOCK_SIZE
+#define QBOOT_BLOCK_SIZE                4096//raw block of release and verify, quicklz, fastlz, lz4 and block index packages must be made with blocks no larger than it
+#endif
+
+#ifndef QBOOT_PROG_UNIT_SIZE
+#define QBOOT_PROG_UNIT_SIZE            32//program unit of flash, e.g. 8 of stm32l4, 16 of some gd32, 32 of stm32h7
+#endif
+
+#ifndef QBOOT_WRITE_BURST_SIZE
+#define QBOOT_WRITE_BURST_SIZE          256//decoded datas shorter than it are gathered before programming
+#endif
+
+#ifdef QBOOT_USING_GZIP
+#ifndef QBOOT_GZIP_WINDOW_BITS
+#define QBOOT_GZIP_WINDOW_BITS          15//9 ~ 15, window of inflate is 1 << bits bytes, gzip packages must be made with the same or smaller window
+#endif
+#endif
+
 #ifndef QBOOT_THREAD_STACK_SIZE
 #define QBOOT_THREAD_STACK_SIZE         4096
 #endif
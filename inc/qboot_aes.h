@@ -4,18 +4,27 @@
  * Change Logs:
  * Date           Author            Notes
  * 2020-07-06     qiyongzhong       first version
+ * 2026-10-14     qboot             add ctr mode and hardware decryption hook
  */
 
 #ifndef __QBOOT_AES_H__
 #define __QBOOT_AES_H__
 
+#include <rtthread.h>
 #include <qboot.h>
 
 #ifdef QBOOT_USING_AES
 
-void qbt_aes_decrypt_init(void);
-void qbt_aes_decrypt(u8 *dst_buf, const u8 *src_buf, u32 len);
+#define QBOOT_AES_MODE_CBC              0
+#define QBOOT_AES_MODE_CTR              1
+#define QBOOT_AES_BLOCK_SIZE            16
+
+void qbt_aes_decrypt_init(int mode);//key and iv are reloaded, decryption starts at the package body
+void qbt_aes_decrypt(u8 *dst_buf, const u8 *src_buf, u32 len);//cbc: len is multiple of 16, ctr: any len, dst_buf can be src_buf
+void qbt_aes_ctr_seek(u32 pos);//ctr only, the next byte decrypted is at pos of package body
+bool qbt_aes_hw_decrypt(int mode, const u8 *key, const u8 *iv, u8 *dst_buf, const u8 *src_buf, u32 len);//weak, whole blocks by the crypto peripheral of soc, the counter of ctr does not carry out of its low 32 bits, return false to decrypt by software
 
 #endif
 
 #endif
+
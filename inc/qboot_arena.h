@@ -0,0 +1,55 @@
+/*
+ * qboot_arena.h
+ *
+ * Change Logs:
+ * Date           Author            Notes
+ * 2026-10-14     qboot             first version
+ */
+
+#ifndef __QBOOT_ARENA_H__
+#define __QBOOT_ARENA_H__
+
+#include <rtthread.h>
+#include <qboot.h>
+
+#define QBOOT_BUF_SIZE                  QBOOT_BLOCK_SIZE
+#define QBOOT_CMPRS_READ_SIZE           QBOOT_BUF_SIZE
+#if (defined(QBOOT_USING_QUICKLZ) || defined(QBOOT_USING_FASTLZ) || defined(QBOOT_USING_LZ4))
+#define QBOOT_CMPRS_BUF_SIZE            (QBOOT_BUF_SIZE + QBOOT_CMPRS_READ_SIZE + 32)//a whole compressed block and the next read
+#define QBOOT_CMPRS_BLOCK_MAX           (QBOOT_CMPRS_BUF_SIZE - QBOOT_CMPRS_READ_SIZE)//largest compressed block with its header
+#else
+#define QBOOT_CMPRS_BUF_SIZE            QBOOT_BUF_SIZE
+#endif
+#if (defined(QBOOT_USING_AES) || defined(QBOOT_USING_GZIP) || defined(QBOOT_USING_QUICKLZ) || defined(QBOOT_USING_FASTLZ) || defined(QBOOT_USING_LZ4) || defined(QBOOT_USING_BLOCK_INDEX))
+#define QBOOT_CRYPT_BUF_SIZE            QBOOT_BUF_SIZE
+#else
+#define QBOOT_CRYPT_BUF_SIZE            0
+#endif
+
+#ifdef QBOOT_USING_GZIP
+#ifndef QBOOT_GZIP_STATE_SIZE
+#define QBOOT_GZIP_STATE_SIZE           (7 * 1024 + 256)//inflate state of zlib
+#endif
+#define QBOOT_ARENA_GZIP_SIZE           (QBOOT_GZIP_STATE_SIZE + (1 << QBOOT_GZIP_WINDOW_BITS))
+#else
+#define QBOOT_ARENA_GZIP_SIZE           0
+#endif
+
+#ifndef QBOOT_ARENA_POOL_SIZE
+#define QBOOT_ARENA_POOL_SIZE           QBOOT_ARENA_GZIP_SIZE//the largest of the selected algorithms, blocks beyond it are taken from heap
+#endif
+
+#define QBOOT_ARENA_CMPRS_OFS           0
+#define QBOOT_ARENA_CRYPT_OFS           (QBOOT_ARENA_CMPRS_OFS + QBOOT_CMPRS_BUF_SIZE)
+#define QBOOT_ARENA_POOL_OFS            (QBOOT_ARENA_CRYPT_OFS + QBOOT_CRYPT_BUF_SIZE)
+#define QBOOT_ARENA_SIZE                (QBOOT_ARENA_POOL_OFS + ((QBOOT_ARENA_POOL_SIZE + 7) & ~7))
+
+extern u32 qbt_arena[];//working buffers of qboot, the pool part is carved by qbt_arena_alloc
+#define QBOOT_ARENA_AT(ofs)             ((u8 *)qbt_arena + (ofs))
+
+void qbt_arena_reset(void);//start of a phase, e.g. check, release, verify or clone, blocks carved by the last phase are dropped
+void *qbt_arena_alloc(u32 size);//carved from the pool, taken from heap when the pool is used up
+void qbt_arena_free(void *ptr);//the pool is reused when all of its blocks are freed
+
+#endif
+
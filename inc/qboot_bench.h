@@ -0,0 +1,34 @@
+/*
+ * qboot_bench.h
+ *
+ * Change Logs:
+ * Date           Author            Notes
+ * 2026-10-14     qboot             first version
+ */
+
+#ifndef __QBOOT_BENCH_H__
+#define __QBOOT_BENCH_H__
+
+#include <rtthread.h>
+#include <qboot.h>
+
+#ifdef QBOOT_USING_BENCH
+
+#ifndef QBOOT_BENCH_DATA_SIZE
+#define QBOOT_BENCH_DATA_SIZE           8192//synthetic datas of each test
+#endif
+
+#ifndef QBOOT_BENCH_BLK_SIZE
+#define QBOOT_BENCH_BLK_SIZE            4096//block size of quicklz, fastlz and lz4, same as the packager
+#endif
+
+#ifndef QBOOT_BENCH_TIME_MS
+#define QBOOT_BENCH_TIME_MS             200//a test is repeated for this time at least
+#endif
+
+void qbt_bench_run(const char *scratch_part_name);//datas of scratch partition are destroyed, NULL for read only
+
+#endif
+
+#endif
+
@@ -0,0 +1,36 @@
+/*
+ * qboot_burst.h
+ *
+ * Change Logs:
+ * Date           Author            Notes
+ * 2026-10-14     qboot             first version
+ */
+
+#ifndef __QBOOT_BURST_H__
+#define __QBOOT_BURST_H__
+
+#include <rtthread.h>
+#include <fal.h>
+#include <qboot.h>
+
+#if ((QBOOT_PROG_UNIT_SIZE > 32) || (QBOOT_PROG_UNIT_SIZE & (QBOOT_PROG_UNIT_SIZE - 1)))
+#error "QBOOT_PROG_UNIT_SIZE must be a power of 2 no larger than 32, the tail information is aligned to it."
+#endif
+#if ((QBOOT_WRITE_BURST_SIZE < QBOOT_PROG_UNIT_SIZE) || (QBOOT_WRITE_BURST_SIZE % QBOOT_PROG_UNIT_SIZE != 0))
+#error "QBOOT_WRITE_BURST_SIZE must be a multiple of QBOOT_PROG_UNIT_SIZE."
+#endif
+
+typedef int (*qbt_burst_out_t)(const struct fal_partition *part, uint32_t addr, const uint8_t *buf, size_t size);
+
+/*
+ * Decoded datas of any length are gathered between the decoders and flash,
+ * the aligned part of a write goes to out directly, only the tail shorter than a program unit is kept,
+ * so every program operation covers whole program units once.
+ */
+void qbt_burst_begin(qbt_burst_out_t out);
+int qbt_burst_write(const struct fal_partition *part, u32 pos, const u8 *buf, u32 len);//in sequence, a gap flushes the kept datas
+bool qbt_burst_flush(void);//at the end or a program unit boundary, the tail is padded with 0xFF to a program unit
+void qbt_burst_discard(void);
+
+#endif
+
@@ -0,0 +1,20 @@
+/*
+ * qboot_crc.h
+ *
+ * Change Logs:
+ * Date           Author            Notes
+ * 2026-10-14     qboot             first version
+ */
+
+#ifndef __QBOOT_CRC_H__
+#define __QBOOT_CRC_H__
+
+#include <rtthread.h>
+#include <qboot.h>
+
+u32 qbt_crc32_sw_cyc_cal(u32 crc, const u8 *buf, u32 len);//software calculation, always available
+u32 qbt_crc32_cyc_cal(u32 crc, const u8 *buf, u32 len);//weak, overridden by the hardware crc of soc
+u32 qbt_crc32_cal(const u8 *buf, u32 len);
+
+#endif
+
@@ -0,0 +1,38 @@
+/*
+ * qboot_flash.h
+ *
+ * Change Logs:
+ * Date           Author            Notes
+ * 2026-10-14     qboot             first version
+ */
+
+#ifndef __QBOOT_FLASH_H__
+#define __QBOOT_FLASH_H__
+
+#include <rtthread.h>
+#include <fal.h>
+#include <qboot.h>
+
+#if (defined(QBOOT_USING_DIFF_WRITE) || defined(QBOOT_USING_LAZY_ERASE))
+#define QBOOT_USING_FLASH_WRITER
+#endif
+
+#ifdef QBOOT_USING_FLASH_WRITER
+
+#ifndef QBOOT_DIFF_SECTOR_MAX_SIZE
+#define QBOOT_DIFF_SECTOR_MAX_SIZE      8192//sector larger than it is not buffered, only be blank checked
+#endif
+
+#ifndef QBOOT_DIFF_PROG_ALIGN
+#define QBOOT_DIFF_PROG_ALIGN           QBOOT_PROG_UNIT_SIZE//resume programming must start at a program unit
+#endif
+
+bool qbt_flash_write_begin(fal_partition_t part);//sectors of part are erased or skipped on demand
+int qbt_flash_write(const struct fal_partition *part, uint32_t addr, const uint8_t *buf, size_t size);//must be written in sequence
+bool qbt_flash_write_sync(void);//commit the open sector, the next write must start at another sector
+bool qbt_flash_write_end(bool commit);
+
+#endif
+
+#endif
+
@@ -0,0 +1,57 @@
+/*
+ * qboot_index.h
+ *
+ * Change Logs:
+ * Date           Author            Notes
+ * 2026-10-14     qboot             first version
+ */
+
+#ifndef __QBOOT_INDEX_H__
+#define __QBOOT_INDEX_H__
+
+#include <rtthread.h>
+#include <fal.h>
+#include <qboot.h>
+
+#ifdef QBOOT_USING_BLOCK_INDEX
+
+/*
+ * Package with block index, flagged by QBOOT_ALGO2_BLOCK_INDEX of algo2:
+ *   fw_info_t | qbt_idx_hdr_t | qbt_idx_entry_t[blk_num] | blocks
+ * Every block is decoded independently into blk_size raw bytes, the last one may be shorter.
+ * pkg_size and pkg_crc cover the index and blocks, raw_size and raw_crc cover the whole code as before.
+ */
+
+#define QBOOT_IDX_MAGIC                 0x58444951//"QIDX"
+#define QBOOT_IDX_BLK_MAX_SIZE          QBOOT_BLOCK_SIZE//raw size of block, same as the release buffer
+
+typedef struct {
+    u32 magic;
+    u32 blk_num;
+    u32 blk_size;
+    u32 idx_crc;                        //crc32 of all entries
+}qbt_idx_hdr_t;
+
+typedef struct {
+    u32 cmprs_ofs;                      //offset of block from the start of package body
+    u32 cmprs_len;
+    u32 raw_len;
+    u32 crc;                            //crc32 of the raw datas of block
+}qbt_idx_entry_t;
+
+typedef struct {
+    fal_partition_t part;
+    u32 body_pos;                       //position of package body in partition
+    u32 pkg_size;
+    u32 raw_size;
+    u32 blk_num;
+    u32 blk_size;
+}qbt_idx_t;
+
+bool qbt_idx_open(qbt_idx_t *idx, fal_partition_t part, u32 body_pos, u32 pkg_size, u32 raw_size);//check the index of package
+bool qbt_idx_entry_read(const qbt_idx_t *idx, u32 blk_no, qbt_idx_entry_t *entry);
+
+#endif
+
+#endif
+
@@ -0,0 +1,69 @@
+/*
+ * qboot_jump.h
+ *
+ * Change Logs:
+ * Date           Author            Notes
+ * 2026-10-14     qboot             first version
+ */
+
+#ifndef __QBOOT_JUMP_H__
+#define __QBOOT_JUMP_H__
+
+#include <rtthread.h>
+#include <qboot.h>
+
+//peripherals enabled by qboot, marked when they are used, only the marked ones are de-initialized at jump
+#define QBOOT_JUMP_PERIPH_CRC           0x0001//hardware crc of QBOOT_USING_HW_CRC
+#define QBOOT_JUMP_PERIPH_AES           0x0002//hardware aes of QBOOT_USING_HW_AES
+#define QBOOT_JUMP_PERIPH_CYCCNT        0x0004//DWT cycle counter of QBOOT_USING_STATS
+#define QBOOT_JUMP_PERIPH_LED           0x0008//pin of QBOOT_USING_STATUS_LED
+#define QBOOT_JUMP_PERIPH_KEY           0x0010//pin of QBOOT_USING_FACTORY_KEY
+#define QBOOT_JUMP_PERIPH_ALWAYS        0x0000//entry of table is de-initialized without being marked, e.g. the console uart of driver
+
+#define QBOOT_JUMP_FLAG_BUS_RESET       0x0001//reset all peripherals of the buses by the port, as the jump without QBOOT_USING_FAST_JUMP
+#define QBOOT_JUMP_FLAG_KEEP_CLOCK      0x0002//clocks are not reset, the application starts with the clocks of qboot
+#define QBOOT_JUMP_FLAG_NO_TX_WAIT      0x0004//jump without waiting the console
+
+#ifdef QBOOT_USING_FAST_JUMP
+
+#ifndef QBOOT_JUMP_TX_DELAY_MS
+#define QBOOT_JUMP_TX_DELAY_MS          2//console flush delay of board without tx_pending, only when the scheduler runs
+#endif
+
+typedef struct {
+    u32 periph;                         //QBOOT_JUMP_PERIPH_xxx it de-initializes
+    void (*deinit)(void);               //e.g. reset pulse and clock disable of the peripheral
+}qbt_jump_periph_t;
+
+typedef struct {
+    const qbt_jump_periph_t *periph_tab;//peripherals enabled by qboot on the soc, e.g. crc and aes
+    u32 periph_num;
+    void (*bus_reset)(void);            //resets all peripherals, for QBOOT_JUMP_FLAG_BUS_RESET
+    void (*clock_reset)(void);          //clock tree back to the reset state
+}qbt_jump_port_t;
+
+/*
+ * Handoff descriptor of board, all fields are optional.
+ * The board table holds the peripherals only the board knows, e.g. the pins of led and key,
+ * the console uart and the spi of flash enabled by the drivers.
+ */
+typedef struct {
+    const qbt_jump_periph_t *periph_tab;
+    u32 periph_num;
+    bool (*tx_pending)(void);           //console has datas in fifo or shift register, NULL to wait QBOOT_JUMP_TX_DELAY_MS
+    u32 flags;                          //QBOOT_JUMP_FLAG_xxx
+}qbt_jump_desc_t;
+
+void qbt_jump_periph_mark(u32 periph);//peripheral is enabled by qboot
+u32 qbt_jump_periph_marked(void);
+const qbt_jump_desc_t *qbt_jump_desc_get(void);//weak, handoff descriptor of board, NULL by default
+void qbt_jump_app_run(const qbt_jump_port_t *port, u32 stk_addr, u32 entry_addr);//returns only if entry_addr returns
+
+#else
+
+#define qbt_jump_periph_mark(periph)
+
+#endif
+
+#endif
+
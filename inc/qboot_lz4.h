@@ -0,0 +1,23 @@
+/*
+ * qboot_lz4.h
+ *
+ * Change Logs:
+ * Date           Author            Notes
+ * 2026-10-14     qboot             first version
+ */
+#ifndef __QBOOT_LZ4_H__
+#define __QBOOT_LZ4_H__
+
+#include <qboot.h>
+
+#ifdef QBOOT_USING_LZ4
+
+#define QBOOT_LZ4_BLOCK_HDR_SIZE        4//big endian size of the lz4 block, same as fastlz
+
+u32 qbt_lz4_get_block_size(const u8 *comp_datas);
+u32 qbt_lz4_decompress(u8 *out_buf, u32 out_buf_size, const u8 *in_buf, u32 block_size);//return 0 if block is broken
+
+#endif
+
+#endif
+
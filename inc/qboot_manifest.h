@@ -0,0 +1,53 @@
+/*
+ * qboot_manifest.h
+ *
+ * Change Logs:
+ * Date           Author            Notes
+ * 2026-10-14     qboot             first version
+ */
+
+#ifndef __QBOOT_MANIFEST_H__
+#define __QBOOT_MANIFEST_H__
+
+#include <rtthread.h>
+#include <fal.h>
+#include <qboot.h>
+
+#ifdef QBOOT_USING_MANIFEST
+
+/*
+ * Manifest package, flagged by QBOOT_ALGO2_MANIFEST of algo2:
+ *   fw_info_t | qbt_mnf_hdr_t | qbt_mnf_entry_t[img_num] | images
+ * Every image is a complete package (fw_info_t and body) with its own destination, algorithm and crc.
+ * The outer package is not encrypted or compressed, pkg_size and pkg_crc cover the table and images.
+ */
+
+#define QBOOT_MNF_MAGIC                 0x464E4D51//"QMNF"
+#define QBOOT_MNF_IMG_MAX_NUM           8
+
+typedef struct {
+    u32 magic;
+    u32 img_num;
+    u32 reserved;
+    u32 tbl_crc;                        //crc32 of all entries
+}qbt_mnf_hdr_t;
+
+typedef struct {
+    u32 img_ofs;                        //offset of image from the start of package body
+    u32 img_size;                       //size of image header and body
+}qbt_mnf_entry_t;
+
+typedef struct {
+    fal_partition_t part;
+    u32 body_pos;                       //position of package body in partition
+    u32 pkg_size;
+    u32 img_num;
+}qbt_mnf_t;
+
+bool qbt_mnf_open(qbt_mnf_t *mnf, fal_partition_t part, u32 body_pos, u32 pkg_size);//check the table of package
+bool qbt_mnf_entry_read(const qbt_mnf_t *mnf, u32 img_no, qbt_mnf_entry_t *entry);
+
+#endif
+
+#endif
+
@@ -0,0 +1,24 @@
+/*
+ * qboot_map.h
+ *
+ * Change Logs:
+ * Date           Author            Notes
+ * 2026-10-14     qboot             first version
+ */
+
+#ifndef __QBOOT_MAP_H__
+#define __QBOOT_MAP_H__
+
+#include <rtthread.h>
+#include <fal.h>
+#include <qboot.h>
+
+#ifdef QBOOT_USING_MAPPED_READ
+
+const u8 *qbt_map_view(const struct fal_partition *part, u32 addr, u32 *p_len);//const view of part from addr to its end, NULL if the flash is not mapped
+const u8 *qbt_map_flash_addr(const struct fal_flash_dev *flash);//weak, address the flash is mapped to, NULL if it is not addressable
+
+#endif
+
+#endif
+
@@ -0,0 +1,49 @@
+/*
+ * qboot_meta.h
+ *
+ * Change Logs:
+ * Date           Author            Notes
+ * 2026-10-14     qboot             first version
+ */
+
+#ifndef __QBOOT_META_H__
+#define __QBOOT_META_H__
+
+#include <rtthread.h>
+#include <qboot.h>
+
+#if ((defined(QBOOT_USING_AB_SLOT) || defined(QBOOT_USING_RESUME) || defined(QBOOT_USING_CHECK_CACHE)) && !defined(QBOOT_USING_META))
+#define QBOOT_USING_META
+#endif
+
+#ifdef QBOOT_USING_META
+
+#ifndef QBOOT_META_PART_NAME
+#define QBOOT_META_PART_NAME            "qbtmeta"//must have 2 sectors at least
+#endif
+
+#define QBOOT_META_REC_SIZE             64
+#define QBOOT_META_DATA_SIZE            (QBOOT_META_REC_SIZE - 16)
+#define QBOOT_META_TYPE_MAX             8
+
+/*
+ * Records of QBOOT_META_REC_SIZE bytes are appended to the partition, little endian:
+ *   u32 magic;     0x4154454D, "META"
+ *   u16 type;      QBOOT_META_TYPE_xxx
+ *   u16 len;       bytes of data used
+ *   u32 seq;       increased by every record written, the largest one of a type is valid
+ *   u32 crc;       crc32 of magic, type, len, seq and all QBOOT_META_DATA_SIZE bytes of data
+ *   u8  data[QBOOT_META_DATA_SIZE];
+ */
+
+#define QBOOT_META_TYPE_SLOT            1
+#define QBOOT_META_TYPE_RESUME          2
+#define QBOOT_META_TYPE_CHECK           3
+
+bool qbt_meta_read(u16 type, void *data, u32 len);//read the latest record of type
+bool qbt_meta_write(u16 type, const void *data, u32 len);//len <= QBOOT_META_DATA_SIZE
+
+#endif
+
+#endif
+
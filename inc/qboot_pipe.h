@@ -0,0 +1,47 @@
+/*
+ * qboot_pipe.h
+ *
+ * Change Logs:
+ * Date           Author            Notes
+ * 2026-10-14     qboot             first version
+ */
+
+#ifndef __QBOOT_PIPE_H__
+#define __QBOOT_PIPE_H__
+
+#include <rtthread.h>
+#include <fal.h>
+#include <qboot.h>
+
+#ifdef QBOOT_USING_PIPELINE
+
+#ifndef QBOOT_PIPE_BUF_NUM
+#define QBOOT_PIPE_BUF_NUM              2//number of block buffers in each pipe, must >= 2
+#endif
+
+#ifndef QBOOT_PIPE_THREAD_STACK_SIZE
+#define QBOOT_PIPE_THREAD_STACK_SIZE    1024
+#endif
+
+#ifndef QBOOT_PIPE_THREAD_PRIO
+#if (QBOOT_THREAD_PRIO > 0)
+#define QBOOT_PIPE_THREAD_PRIO          (QBOOT_THREAD_PRIO - 1)//higher than qboot thread, so the next transfer starts as soon as the last one is done
+#else
+#define QBOOT_PIPE_THREAD_PRIO          QBOOT_THREAD_PRIO
+#endif
+#endif
+
+typedef int (*qbt_pipe_write_t)(const struct fal_partition *part, uint32_t addr, const uint8_t *buf, size_t size);
+typedef struct qbt_pipe *qbt_pipe_t;
+
+qbt_pipe_t qbt_pipe_reader_open(fal_partition_t part, u32 pos, u32 end_pos, u32 blk_size);//prefetch [pos, end_pos) of part
+qbt_pipe_t qbt_pipe_writer_open(fal_partition_t part, u32 blk_size, qbt_pipe_write_t write_func);//write behind by write_func
+int qbt_pipe_read(qbt_pipe_t pipe, u32 pos, u8 *buf, u32 len);//must read in sequence
+int qbt_pipe_write(qbt_pipe_t pipe, u32 pos, const u8 *buf, u32 len);
+bool qbt_pipe_flush(qbt_pipe_t pipe);//wait all queued datas written, return false if any write fail
+bool qbt_pipe_close(qbt_pipe_t pipe);
+
+#endif
+
+#endif
+
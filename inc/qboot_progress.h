@@ -0,0 +1,58 @@
+/*
+ * qboot_progress.h
+ *
+ * Change Logs:
+ * Date           Author            Notes
+ * 2026-10-14     qboot             first version
+ */
+
+#ifndef __QBOOT_PROGRESS_H__
+#define __QBOOT_PROGRESS_H__
+
+#include <rtthread.h>
+#include <qboot.h>
+
+#ifndef QBOOT_PROGRESS_INTERVAL_MS
+#define QBOOT_PROGRESS_INTERVAL_MS      200//minimum interval of update events
+#endif
+#ifndef QBOOT_PROGRESS_SINK_NUM
+#define QBOOT_PROGRESS_SINK_NUM         4
+#endif
+
+typedef enum {
+    QBOOT_PROG_RELEASE = 0,             //package is released to destination
+    QBOOT_PROG_CLONE,                   //firmware is copied between partitions
+    QBOOT_PROG_PHASE_NUM
+}qbt_prog_phase_t;
+
+typedef enum {
+    QBOOT_PROG_EVT_BEGIN = 0,
+    QBOOT_PROG_EVT_UPDATE,              //rate limited by QBOOT_PROGRESS_INTERVAL_MS
+    QBOOT_PROG_EVT_END,                 //phase is finished
+    QBOOT_PROG_EVT_FAIL,                //phase is aborted
+}qbt_prog_evt_t;
+
+typedef struct {
+    int phase;
+    int event;
+    const char *part_name;              //destination partition
+    u32 done;                           //bytes of destination
+    u32 total;
+    u32 elapsed_ms;                     //since the begin of phase
+    u32 kbps;                           //average throughput, KB/s
+}qbt_prog_info_t;
+
+typedef void (*qbt_prog_cb_t)(const qbt_prog_info_t *info, void *user);
+
+/*
+ * Sinks are called in the thread of qboot, they should return quickly.
+ * The console sink is built in unless QBOOT_USING_PROGRESS_QUIET is defined.
+ */
+bool qbt_prog_register(qbt_prog_cb_t cb, void *user);
+void qbt_prog_unregister(qbt_prog_cb_t cb);
+void qbt_prog_begin(int phase, const char *part_name, u32 total);
+void qbt_prog_update(u32 done);//cheap, sinks are called only when the interval is passed
+void qbt_prog_end(bool is_ok);//ignored if no phase is running
+
+#endif
+
@@ -0,0 +1,66 @@
+/*
+ * qboot_slot.h
+ *
+ * Change Logs:
+ * Date           Author            Notes
+ * 2026-10-14     qboot             first version
+ */
+
+#ifndef __QBOOT_SLOT_H__
+#define __QBOOT_SLOT_H__
+
+#include <rtthread.h>
+#include <qboot.h>
+
+#ifdef QBOOT_USING_AB_SLOT
+
+#ifndef QBOOT_APP_B_PART_NAME
+#define QBOOT_APP_B_PART_NAME           "app_b"
+#endif
+
+#ifndef QBOOT_SLOT_TRIAL_TIMES
+#define QBOOT_SLOT_TRIAL_TIMES          3//boot times of a pending slot before it is confirmed
+#endif
+
+#define QBOOT_SLOT_A                    0
+#define QBOOT_SLOT_B                    1
+#define QBOOT_SLOT_NUM                  2
+#define QBOOT_SLOT_NONE                 0xFF
+
+#if defined(QBOOT_USING_BANK_SWAP) && !defined(QBOOT_BANK_SWAP_PORT)
+#error "QBOOT_USING_BANK_SWAP needs qbt_slot_bank_swap of the port, define QBOOT_BANK_SWAP_PORT when the port implements it."
+#endif
+
+/*
+ * The slot table is the latest record of type QBOOT_META_TYPE_SLOT in the qbtmeta partition
+ * (record layout in qboot_meta.h), its data are 4 bytes:
+ *   u8 active;     confirmed slot booted normally, QBOOT_SLOT_A or QBOOT_SLOT_B
+ *   u8 pending;    new installed slot on trial boot, QBOOT_SLOT_NONE if none
+ *   u8 tries;      remain trial boots of the pending slot
+ *   u8 confirmed;  bit mask of the slots confirmed running well, bit 0 is slot A
+ *
+ * The application links qboot_slot.c, qboot_meta.c and qboot_crc.c, with the same
+ * QBOOT_USING_AB_SLOT configuration and the qbtmeta partition in its fal table, and calls:
+ *   qbt_slot_confirm()        when the pending slot it runs from is good, or the trial boots revert it;
+ *   qbt_slot_installed(slot)  to mark the inactive slot pending, after it has written an image there
+ *                             without a package, the fw_info_t of the image at the tail of the slot
+ *                             (raw_size and raw_crc of QBOOT_ALGO2_VERIFY_CRC are checked at boot).
+ */
+
+typedef bool (*qbt_slot_verify_t)(const char *part_name);
+
+int qbt_slot_of_part(const char *part_name);//return -1 if the partition is not a slot
+const char *qbt_slot_part_name(int slot);
+const char *qbt_slot_release_target(const char *part_name);//partition the firmware of part_name is released into
+bool qbt_slot_installed(int slot);//a new firmware is written into slot, it is pending if it is not the active one
+bool qbt_slot_confirm(void);//the pending slot is running well
+int qbt_slot_select(qbt_slot_verify_t verify);//select the slot to boot, -1 if no slot can be mapped
+bool qbt_slot_fallback(qbt_slot_verify_t verify);//the selected slot can not boot, select another one
+u32 qbt_slot_boot_addr(void);
+void qbt_slot_show(void);
+bool qbt_slot_bank_swap(int slot);//of the port, map the slot to QBOOT_APP_ADDR by swapping flash banks, false if it can not
+
+#endif
+
+#endif
+
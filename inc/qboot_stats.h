@@ -0,0 +1,85 @@
+/*
+ * qboot_stats.h
+ *
+ * Change Logs:
+ * Date           Author            Notes
+ * 2026-10-14     qboot             first version
+ */
+
+#ifndef __QBOOT_STATS_H__
+#define __QBOOT_STATS_H__
+
+#include <rtthread.h>
+#include <fal.h>
+#include <qboot.h>
+
+typedef enum {
+    QBOOT_STATS_FW_CHECK = 0,           //package body crc check
+    QBOOT_STATS_APP_CHECK,              //decrypt and decompress to check crc of code
+    QBOOT_STATS_ERASE,                  //erase before release
+    QBOOT_STATS_RELEASE,                //release, include the erase
+    QBOOT_STATS_VERIFY,                 //crc check of released code
+    QBOOT_STATS_PHASE_NUM
+}qbt_stats_phase_t;
+
+#ifdef QBOOT_USING_STATS
+
+#ifndef QBOOT_STATS_SECTION
+#define QBOOT_STATS_SECTION             ".noinit"//must be a NOLOAD section, or define QBOOT_STATS_ADDR
+#endif
+
+#define QBOOT_STATS_MAGIC               0x54415453//"STAT"
+#define QBOOT_STATS_ALGO_NUM            8//compress types, index is (algo & QBOOT_ALGO_CMPRS_MASK) >> 8
+
+/*
+ * The record is kept in no-init ram, it is sealed by crc before the jump,
+ * the application reads it from QBOOT_STATS_ADDR or the section to know the boot time.
+ */
+typedef struct {
+    u32 magic;
+    u32 boot_cnt;                       //boot times since power on
+    u32 boot_ms;                        //running time of qboot till the jump
+    u32 phase_us[QBOOT_STATS_PHASE_NUM];
+    u32 phase_cnt[QBOOT_STATS_PHASE_NUM];
+    u32 decode_bytes[QBOOT_STATS_ALGO_NUM];//raw code bytes decoded
+    u32 decode_us[QBOOT_STATS_ALGO_NUM];
+    u32 rd_cnt;                         //fal calls and bytes
+    u32 rd_bytes;
+    u32 wr_cnt;
+    u32 wr_bytes;
+    u32 er_cnt;
+    u32 er_bytes;
+    u32 crc;
+}qbt_stats_t;
+
+void qbt_stats_init(void);//start of boot, only the first call resets the record
+void qbt_stats_phase_begin(int phase);
+void qbt_stats_phase_end(int phase);
+void qbt_stats_decode_add(int algo, u32 raw_size, int phase);//raw code is decoded in the last run of phase
+void qbt_stats_seal(void);//before the jump
+const qbt_stats_t *qbt_stats_get(void);
+void qbt_stats_show(void);
+u32 qbt_stats_cycle_get(void);//weak, free running cycle counter of chip, e.g. DWT->CYCCNT
+u32 qbt_stats_cycle_freq(void);//weak, frequence of cycle counter, 0 if not supported
+
+int qbt_stats_fal_read(const struct fal_partition *part, uint32_t addr, uint8_t *buf, size_t size);
+int qbt_stats_fal_write(const struct fal_partition *part, uint32_t addr, const uint8_t *buf, size_t size);
+int qbt_stats_fal_erase(const struct fal_partition *part, uint32_t addr, size_t size);
+
+//count the fal calls of the modules including this file
+#define fal_partition_read(part, addr, buf, size)       qbt_stats_fal_read(part, addr, buf, size)
+#define fal_partition_write(part, addr, buf, size)      qbt_stats_fal_write(part, addr, buf, size)
+#define fal_partition_erase(part, addr, size)           qbt_stats_fal_erase(part, addr, size)
+
+#else
+
+#define qbt_stats_init()
+#define qbt_stats_phase_begin(phase)
+#define qbt_stats_phase_end(phase)
+#define qbt_stats_decode_add(algo, raw_size, phase)
+#define qbt_stats_seal()
+
+#endif
+
+#endif
+
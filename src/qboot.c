@@ -18,14 +18,28 @@
 #include <qboot_aes.h>
 #include <qboot_gzip.h>
 #include <qboot_fastlz.h>
+#include <qboot_lz4.h>
 #include <qboot_quicklz.h>
 #include <qboot_hpatchlite.h>
+#include <qboot_index.h>
+#include <qboot_manifest.h>
+#include <qboot_crc.h>
+#include <qboot_pipe.h>
+#include <qboot_flash.h>
+#include <qboot_burst.h>
+#include <qboot_meta.h>
+#include <qboot_map.h>
+#include <qboot_arena.h>
+#include <qboot_slot.h>
+#include <qboot_stats.h>
+#include <qboot_progress.h>
+#include <qboot_bench.h>
+#include <qboot_jump.h>
 #include <string.h>
 #ifdef QBOOT_USING_SHELL
 #include "shell.h"
 #endif
 
-#include "crc32.h"
 
 #ifdef QBOOT_USING_STATUS_LED
 #include <qled.h>
@@ -55,19 +69,11 @@
 #define QBOOT_VER_MSG                   "V1.0.7 2024.06.03"
 #define QBOOT_SHELL_PROMPT              "Qboot>"
 
-#define QBOOT_BUF_SIZE                  4096//must is 4096
-#if (defined(QBOOT_USING_QUICKLZ) || defined(QBOOT_USING_FASTLZ))
-#define QBOOT_CMPRS_READ_SIZE           4096 //it can is 512, 1024, 2048, 4096,
-#define QBOOT_CMPRS_BUF_SIZE            (QBOOT_BUF_SIZE + QBOOT_CMPRS_READ_SIZE + 32)
-#else
-#define QBOOT_CMPRS_READ_SIZE           QBOOT_BUF_SIZE
-#define QBOOT_CMPRS_BUF_SIZE            QBOOT_BUF_SIZE
-#endif
-
 
 #define QBOOT_ALGO_CRYPT_NONE           0
 #define QBOOT_ALGO_CRYPT_XOR            1
 #define QBOOT_ALGO_CRYPT_AES            2
+#define QBOOT_ALGO_CRYPT_AES_CTR        3
 #define QBOOT_ALGO_CRYPT_MASK           0x0F
 
 #define QBOOT_ALGO_CMPRS_NONE           (0 << 8)
@@ -75,11 +81,19 @@
 #define QBOOT_ALGO_CMPRS_QUICKLZ        (2 << 8)
 #define QBOOT_ALGO_CMPRS_FASTLZ         (3 << 8)
 #define QBOOT_ALGO_CMPRS_HPATCHLITE     (4 << 8)
+#define QBOOT_ALGO_CMPRS_LZ4            (5 << 8)
 #define QBOOT_ALGO_CMPRS_MASK           (0x1F << 8)
 
 #define QBOOT_ALGO2_VERIFY_NONE         0
 #define QBOOT_ALGO2_VERIFY_CRC          1
 #define QBOOT_ALGO2_VERIFY_MASK         0x0F
+#define QBOOT_ALGO2_BLOCK_INDEX         0x10//block index follows the header
+#define QBOOT_ALGO2_MANIFEST            0x20//image table follows the header
+
+#define QBOOT_CHECK_HDR                 0//header of package
+#define QBOOT_CHECK_COMPAT              1//product code, algorithms and destination, no body is read
+#define QBOOT_CHECK_BODY                2//crc of package body
+#define QBOOT_CHECK_APP                 3//crc of code, package is decoded
 
 typedef struct {
     u8  type[4];
@@ -97,17 +111,82 @@ typedef struct {
 }fw_info_t;
 
 static fw_info_t fw_info;
-static u8 cmprs_buf[QBOOT_CMPRS_BUF_SIZE];
-#if (defined(QBOOT_USING_AES) || defined(QBOOT_USING_GZIP) || defined(QBOOT_USING_QUICKLZ) || defined(QBOOT_USING_FASTLZ))
-static u8 crypt_buf[QBOOT_BUF_SIZE];
+static u8 *const cmprs_buf = QBOOT_ARENA_AT(QBOOT_ARENA_CMPRS_OFS);
+#if (QBOOT_CRYPT_BUF_SIZE > 0)
+static u8 *const crypt_buf = QBOOT_ARENA_AT(QBOOT_ARENA_CRYPT_OFS);
 #else
-static u8 *crypt_buf = NULL;
+static u8 *const crypt_buf = NULL;
+#endif
+static u32 pkg_base = 0;//position of the package in source partition, the image of manifest is not at 0
+
+#if (defined(QBOOT_USING_FUSED_RELEASE) || defined(QBOOT_USING_STREAM))
+#define QBOOT_USING_FUSED_CRC//crc of package and code are calculated while they pass
+#endif
+
+#ifdef QBOOT_USING_FUSED_CRC
+typedef struct {
+    bool enable;
+    u32 raw_size;
+    u32 pkg_crc;
+    u32 raw_crc;
+}fused_ctx_t;
+
+static fused_ctx_t fused_ctx;
+#endif
+
+#ifdef QBOOT_USING_RESUME
+typedef struct {
+    u32 hdr_crc;                        //package being released, 0 if no release is interrupted
+    u32 pkg_crc;
+    u8  dst_name[16];
+    u32 dst_pos;                        //code before it is in destination
+    u32 src_pos;                        //package is read up to it
+    u32 cmprs_len;                      //incomplete block before src_pos, read again when resuming
+    u32 fused_pkg_crc;                  //running crc of package and code at the checkpoint
+    u32 fused_raw_crc;
+}resume_ckpt_t;
+
+typedef struct {
+    bool enable;
+    u32 next_pos;                       //destination position of the next checkpoint
+    resume_ckpt_t ckpt;
+}resume_ctx_t;
+
+static resume_ctx_t resume_ctx;
+#endif
+
+#ifdef QBOOT_USING_CHECK_CACHE
+typedef struct {
+    u32 hdr_crc;                        //package of the partition passed body and app check
+    u32 pkg_crc;
+    u32 epoch;                          //QBOOT_CHECK_CACHE_EPOCH when it is checked
+}check_cache_ent_t;
+
+typedef struct {
+    check_cache_ent_t factory;          //only the factory package is not changed by the application
+}check_cache_t;
+#endif
+
+#ifdef QBOOT_USING_STREAM
+typedef struct {
+    bool active;
+    fal_partition_t dst_part;           //not NULL after the header is received and destination is erased
+    fw_info_t fw_info;
+    u32 hdr_len;
+    u32 pkg_pos;                        //received length of package body
+    u32 stage_len;                      //received datas not decoded yet
+    u32 cmprs_len;
+    u32 dst_pos;
+    int crypt_type;
+    int cmprs_type;
+}stream_ctx_t;
+
+static stream_ctx_t stream_ctx;
 #endif
 
-#ifdef QBOOT_USING_GZIP
-#define GZIP_REMAIN_BUF_SIZE 32
-static int gzip_remain_len = 0;
-static u8 gzip_remain_buf[GZIP_REMAIN_BUF_SIZE];
+#ifdef QBOOT_USING_PIPELINE
+static qbt_pipe_t src_pipe = NULL;
+static qbt_pipe_t dst_pipe = NULL;
 #endif
 
 static bool qbt_part_is_exist(const char *part_name)
@@ -137,6 +216,23 @@ static bool qbt_fw_info_write(const char *part_name, fw_info_t *fw_info, bool to
     return(true);
 }
 
+static u32 qbt_part_sector_size(fal_partition_t part)
+{
+    const struct fal_flash_dev *flash_dev = fal_flash_device_find(part->flash_name);
+    return((flash_dev != NULL) ? flash_dev->blk_size : 0);
+}
+
+static void qbt_dest_part_invalidate(fal_partition_t part)
+{
+    u32 sector_size = qbt_part_sector_size(part);
+
+    //erase the vector table, then the broken code will not be jumped to
+    if (fal_partition_erase(part, 0, (sector_size > 0) ? sector_size : 1) < 0)
+    {
+        LOG_E("Qboot invalidate partition %s fail.", part->name);
+    }
+}
+
 static bool qbt_fw_info_check(fw_info_t *fw_info)
 {
     if (strcmp((const char *)(fw_info->type), "RBL") != 0)
@@ -144,7 +240,7 @@ static bool qbt_fw_info_check(fw_info_t *fw_info)
         return(false);
     }
 
-    return (crc32_cal((u8 *)fw_info, (sizeof(fw_info_t) - sizeof(u32))) == fw_info->hdr_crc);
+    return (qbt_crc32_cal((u8 *)fw_info, (sizeof(fw_info_t) - sizeof(u32))) == fw_info->hdr_crc);
 }
 
 static bool qbt_fw_crc_check(const char *part_name, u32 addr, u32 size, u32 crc)
@@ -152,6 +248,15 @@ static bool qbt_fw_crc_check(const char *part_name, u32 addr, u32 size, u32 crc)
     u32 pos = 0;
     u32 crc32 = 0xFFFFFFFF;
     fal_partition_t part = (fal_partition_t)fal_partition_find(part_name);
+    #ifdef QBOOT_USING_MAPPED_READ
+    u32 view_len = 0;
+    const u8 *view = qbt_map_view(part, addr, &view_len);
+    if ((view != RT_NULL) && (view_len >= size))
+    {
+        crc32 = qbt_crc32_cyc_cal(crc32, view, size);//directly from flash, no copy
+        pos = size;
+    }
+    #endif
     
     while (pos < size)
     {
@@ -166,7 +271,7 @@ static bool qbt_fw_crc_check(const char *part_name, u32 addr, u32 size, u32 crc)
             LOG_E("Qboot read firmware datas fail. part = %s, addr = %08X, length = %d", part_name, pos, read_len);
             return(false);
         }
-        crc32 = crc32_cyc_cal(crc32, cmprs_buf, read_len);
+        crc32 = qbt_crc32_cyc_cal(crc32, cmprs_buf, read_len);
         pos += read_len;
     }
     crc32 ^= 0xFFFFFFFF;
@@ -212,6 +317,48 @@ static bool qbt_release_sign_write(const char *part_name, fw_info_t *fw_info)
     return(true);
 }
 
+#ifdef QBOOT_USING_FAST_BOOT
+static bool qbt_fw_released_check(const char *part_name, fw_info_t *fw_info)
+{
+    fw_info_t dst_info;
+
+    if ( ! qbt_part_is_exist(part_name))
+    {
+        return(false);
+    }
+
+    if (( ! qbt_fw_info_read(part_name, fw_info, false)) || ( ! qbt_fw_info_check(fw_info)))
+    {
+        return(false);
+    }
+
+    #ifdef QBOOT_USING_PRODUCT_CODE
+    if (strcmp((char *)fw_info->prod_code, QBOOT_PRODUCT_CODE) != 0)
+    {
+        return(false);
+    }
+    #endif
+
+    if ( ! qbt_release_sign_check(part_name, fw_info))
+    {
+        return(false);
+    }
+
+    if ( ! qbt_part_is_exist((char *)fw_info->part_name))
+    {
+        return(false);
+    }
+
+    if (( ! qbt_fw_info_read((char *)fw_info->part_name, &dst_info, true)) || ( ! qbt_fw_info_check(&dst_info)))
+    {
+        return(false);
+    }
+
+    //the tail information of destination partition is written only after a successful release
+    return(memcmp(&dst_info, fw_info, sizeof(fw_info_t)) == 0);
+}
+#endif
+
 static bool qbt_fw_decrypt_init(int crypt_type)
 {
     switch (crypt_type)
@@ -221,7 +368,10 @@ static bool qbt_fw_decrypt_init(int crypt_type)
 
     #ifdef QBOOT_USING_AES
     case QBOOT_ALGO_CRYPT_AES:
-        qbt_aes_decrypt_init();
+        qbt_aes_decrypt_init(QBOOT_AES_MODE_CBC);
+        break;
+    case QBOOT_ALGO_CRYPT_AES_CTR:
+        qbt_aes_decrypt_init(QBOOT_AES_MODE_CTR);
         break;
     #endif
 
@@ -241,7 +391,6 @@ static bool qbt_fw_decompress_init(int cmprs_type)
         
     #ifdef QBOOT_USING_GZIP
     case QBOOT_ALGO_CMPRS_GZIP:
-        gzip_remain_len = 0;
         qbt_gzip_init();
         break;
     #endif
@@ -256,6 +405,10 @@ static bool qbt_fw_decompress_init(int cmprs_type)
     case QBOOT_ALGO_CMPRS_FASTLZ:
         break;
     #endif
+    #ifdef QBOOT_USING_LZ4
+    case QBOOT_ALGO_CMPRS_LZ4:
+        break;
+    #endif
     #ifdef QBOOT_USING_HPATCHLITE
     case QBOOT_ALGO_CMPRS_HPATCHLITE:
         break;
@@ -289,6 +442,11 @@ static bool qbt_fw_decompress_deinit(int cmprs_type)
     case QBOOT_ALGO_CMPRS_FASTLZ:
         break;
     #endif
+
+    #ifdef QBOOT_USING_LZ4
+    case QBOOT_ALGO_CMPRS_LZ4:
+        break;
+    #endif
     
     default:
         return(false);
@@ -297,23 +455,48 @@ static bool qbt_fw_decompress_deinit(int cmprs_type)
     return(true);
 }
 
+static int qbt_src_data_read(fal_partition_t part, u32 pos, u8 *buf, u32 len)
+{
+    #ifdef QBOOT_USING_PIPELINE
+    if (src_pipe != NULL)
+    {
+        return(qbt_pipe_read(src_pipe, pos, buf, len));
+    }
+    #endif
+
+    return(fal_partition_read(part, pos, buf, len));
+}
+
 static bool qbt_fw_pkg_read(const fal_partition_t part, u32 pos, u8 *buf, u32 read_len, u8 *crypt_buf, int crypt_type)
 {
     switch(crypt_type)
     {
     case QBOOT_ALGO_CRYPT_NONE:
-        if (fal_partition_read(part, pos, buf, read_len) < 0)
+        if (qbt_src_data_read(part, pos, buf, read_len) < 0)
         {
             return(false);
         }
+        #ifdef QBOOT_USING_FUSED_CRC
+        if (fused_ctx.enable)
+        {
+            fused_ctx.pkg_crc = qbt_crc32_cyc_cal(fused_ctx.pkg_crc, buf, read_len);
+        }
+        #endif
         break;
     
     #ifdef QBOOT_USING_AES    
     case QBOOT_ALGO_CRYPT_AES:
-        if (fal_partition_read(part, pos, crypt_buf, read_len) < 0)
+    case QBOOT_ALGO_CRYPT_AES_CTR:
+        if (qbt_src_data_read(part, pos, crypt_buf, read_len) < 0)
         {
            return(false);
         }
+        #ifdef QBOOT_USING_FUSED_CRC
+        if (fused_ctx.enable)
+        {
+            fused_ctx.pkg_crc = qbt_crc32_cyc_cal(fused_ctx.pkg_crc, crypt_buf, read_len);
+        }
+        #endif
         qbt_aes_decrypt(buf, crypt_buf, read_len);
         break;
     #endif
@@ -325,19 +508,67 @@ static bool qbt_fw_pkg_read(const fal_partition_t part, u32 pos, u8 *buf, u32 re
     return(true);
 }
 
+static int qbt_dest_flash_write(const struct fal_partition *part, uint32_t addr, const uint8_t *buf, size_t size)
+{
+    #ifdef QBOOT_USING_FLASH_WRITER
+    return(qbt_flash_write(part, addr, buf, size));
+    #else
+    return(fal_partition_write(part, addr, buf, size));
+    #endif
+}
+
+static int qbt_dest_data_write(fal_partition_t part, u32 pos, const u8 *buf, u32 len)
+{
+    if (pos + len > part->len - sizeof(fw_info_t))//keep the firmware information at the tail
+    {
+        return(-1);
+    }
+
+    #ifdef QBOOT_USING_FUSED_CRC
+    if (fused_ctx.enable && (pos < fused_ctx.raw_size))
+    {
+        u32 cal_len = fused_ctx.raw_size - pos;//the padding after raw code is not calculated
+        if (cal_len > len)
+        {
+            cal_len = len;
+        }
+        fused_ctx.raw_crc = qbt_crc32_cyc_cal(fused_ctx.raw_crc, buf, cal_len);
+    }
+    #endif
+
+    return(qbt_burst_write(part, pos, buf, len));
+}
+
+static int qbt_dest_burst_out(const struct fal_partition *part, uint32_t addr, const uint8_t *buf, size_t size)//gathered datas of qbt_dest_data_write
+{
+    #ifdef QBOOT_USING_PIPELINE
+    if (dst_pipe != NULL)
+    {
+        return(qbt_pipe_write(dst_pipe, addr, buf, size));
+    }
+    #endif
+
+    return(qbt_dest_flash_write(part, addr, buf, size));
+}
+
 static int qbt_dest_part_write(fal_partition_t part, u32 pos, u8 *decmprs_buf, u8 *cmprs_buf, u32 *p_cmprs_len, int cmprs_type)
 {
     int write_len = 0;
     int cmprs_len = 0;
+    #if defined(QBOOT_USING_GZIP) || defined(QBOOT_USING_QUICKLZ) || defined(QBOOT_USING_FASTLZ) || defined(QBOOT_USING_LZ4) || defined(QBOOT_USING_BLOCK_INDEX)
     int decomp_len = 0;
+    #endif
+    #if defined(QBOOT_USING_QUICKLZ) || defined(QBOOT_USING_FASTLZ) || defined(QBOOT_USING_LZ4) || defined(QBOOT_USING_BLOCK_INDEX)
     int block_size = 0;
+    int cmprs_ofs = 0;//cursor of the blocks of the block codecs
+    #endif
     
     cmprs_len = *p_cmprs_len;
     
     switch(cmprs_type)
     {
     case QBOOT_ALGO_CMPRS_NONE:
-        if (fal_partition_write(part, pos, cmprs_buf, cmprs_len) < 0)
+        if (qbt_dest_data_write(part, pos, cmprs_buf, cmprs_len) < 0)
         {
             return(-1);
         }
@@ -350,39 +581,22 @@ static int qbt_dest_part_write(fal_partition_t part, u32 pos, u8 *decmprs_buf, u
         qbt_gzip_set_in(cmprs_buf, cmprs_len);
         while(1)
         {
-            bool is_end;
-
-            memcpy(decmprs_buf, gzip_remain_buf, gzip_remain_len);
-            decomp_len = qbt_gzip_decompress(decmprs_buf + gzip_remain_len, QBOOT_BUF_SIZE - gzip_remain_len);
+            decomp_len = qbt_gzip_decompress(decmprs_buf, QBOOT_BUF_SIZE);
             if (decomp_len < 0)
             {
                 write_len = -1;
                 cmprs_len = 0;
                 break;
             }
-            is_end = (decomp_len < (QBOOT_BUF_SIZE - gzip_remain_len));
-            decomp_len += gzip_remain_len;
-            gzip_remain_len = decomp_len % GZIP_REMAIN_BUF_SIZE;
-            decomp_len -= gzip_remain_len;
-            memcpy(gzip_remain_buf, decmprs_buf + decomp_len, gzip_remain_len);
-            if (decomp_len > 0)
+            if ((decomp_len > 0) && (qbt_dest_data_write(part, pos, decmprs_buf, decomp_len) < 0))//any length, aligned by the burst writer
             {
-                if (fal_partition_write(part, pos, decmprs_buf, decomp_len) < 0)
-                {
-                    write_len = -1;
-                    cmprs_len = 0;
-                    break;
-                }
+                write_len = -1;
+                cmprs_len = 0;
+                break;
             }
             pos += decomp_len;
             write_len += decomp_len;
-            if (is_end && (cmprs_len < QBOOT_CMPRS_READ_SIZE) && (gzip_remain_len > 0))//last package and remain > 0
-            {
-                memset(gzip_remain_buf + gzip_remain_len, 0xFF, GZIP_REMAIN_BUF_SIZE - gzip_remain_len);
-                fal_partition_write(part, pos, gzip_remain_buf, GZIP_REMAIN_BUF_SIZE);
-                write_len += GZIP_REMAIN_BUF_SIZE;
-            }
-            if (is_end)
+            if (decomp_len < QBOOT_BUF_SIZE)//input is used up
             {
                 cmprs_len = 0;
                 break;
@@ -399,23 +613,30 @@ static int qbt_dest_part_write(fal_partition_t part, u32 pos, u8 *decmprs_buf, u
             {
                 break;
             }
-            block_size = qbt_quicklz_get_block_size(cmprs_buf);
-            if (block_size <= 0)
+            block_size = qbt_quicklz_get_block_size(cmprs_buf + cmprs_ofs);
+            if (block_size == 0)//zero padding of aes-cbc after the last block
+            {
+                break;
+            }
+            if ((block_size < 0) || (block_size > QBOOT_CMPRS_BLOCK_MAX - QBOOT_QUICKLZ_BLOCK_HDR_SIZE))//corrupt header, the block can not be staged in cmprs_buf
             {
+                LOG_E("Qboot decompress fail. block size %d is out of buffer.", block_size);
+                write_len = -1;
+                cmprs_len = 0;
                 break;
             }
             if (cmprs_len < block_size + QBOOT_QUICKLZ_BLOCK_HDR_SIZE)
             {
                 break;
             }
-            decomp_len = qbt_quicklz_decompress(decmprs_buf, cmprs_buf + QBOOT_QUICKLZ_BLOCK_HDR_SIZE);
+            decomp_len = qbt_quicklz_decompress(decmprs_buf, cmprs_buf + cmprs_ofs + QBOOT_QUICKLZ_BLOCK_HDR_SIZE);
             if (decomp_len <= 0)
             {
                 write_len = -1;
                 cmprs_len = 0;
                 break;
             }
-            if (fal_partition_write(part, pos, decmprs_buf, decomp_len) < 0)
+            if (qbt_dest_data_write(part, pos, decmprs_buf, decomp_len) < 0)
             {
                 write_len = -1;
                 cmprs_len = 0;
@@ -424,7 +645,11 @@ static int qbt_dest_part_write(fal_partition_t part, u32 pos, u8 *decmprs_buf, u
             pos += decomp_len;
             write_len += decomp_len;
             cmprs_len -= (block_size + QBOOT_QUICKLZ_BLOCK_HDR_SIZE);
-            memcpy(cmprs_buf, cmprs_buf + (block_size + QBOOT_QUICKLZ_BLOCK_HDR_SIZE), cmprs_len);
+            cmprs_ofs += (block_size + QBOOT_QUICKLZ_BLOCK_HDR_SIZE);
+        }
+        if (cmprs_len > 0)
+        {
+            memmove(cmprs_buf, cmprs_buf + cmprs_ofs, cmprs_len);//only the incomplete block is moved to the head
         }
         break;
     #endif
@@ -437,23 +662,30 @@ static int qbt_dest_part_write(fal_partition_t part, u32 pos, u8 *decmprs_buf, u
             {
                 break;
             }
-            block_size = qbt_fastlz_get_block_size(cmprs_buf);
-            if (block_size <= 0)
+            block_size = qbt_fastlz_get_block_size(cmprs_buf + cmprs_ofs);
+            if (block_size == 0)//zero padding of aes-cbc after the last block
+            {
+                break;
+            }
+            if ((block_size < 0) || (block_size > QBOOT_CMPRS_BLOCK_MAX - QBOOT_FASTLZ_BLOCK_HDR_SIZE))//corrupt header, the block can not be staged in cmprs_buf
             {
+                LOG_E("Qboot decompress fail. block size %d is out of buffer.", block_size);
+                write_len = -1;
+                cmprs_len = 0;
                 break;
             }
             if (cmprs_len < block_size + QBOOT_FASTLZ_BLOCK_HDR_SIZE)
             {
                 break;
             }
-            decomp_len = qbt_fastlz_decompress(decmprs_buf, QBOOT_BUF_SIZE, cmprs_buf + QBOOT_FASTLZ_BLOCK_HDR_SIZE, block_size);
+            decomp_len = qbt_fastlz_decompress(decmprs_buf, QBOOT_BUF_SIZE, cmprs_buf + cmprs_ofs + QBOOT_FASTLZ_BLOCK_HDR_SIZE, block_size);
             if (decomp_len <= 0)
             {
                 write_len = -1;
                 cmprs_len = 0;
                 break;
             }
-            if (fal_partition_write(part, pos, decmprs_buf, decomp_len) < 0)
+            if (qbt_dest_data_write(part, pos, decmprs_buf, decomp_len) < 0)
             {
                 write_len = -1;
                 cmprs_len = 0;
@@ -462,159 +694,60 @@ static int qbt_dest_part_write(fal_partition_t part, u32 pos, u8 *decmprs_buf, u
             pos += decomp_len;
             write_len += decomp_len;
             cmprs_len -= (block_size + QBOOT_FASTLZ_BLOCK_HDR_SIZE);
-            memcpy(cmprs_buf, cmprs_buf + (block_size + QBOOT_FASTLZ_BLOCK_HDR_SIZE), cmprs_len);
-        }
-        break;
-    #endif
-        
-    default:
-        write_len = -1;
-        cmprs_len = 0;
-        break;
-    }  
-
-    *p_cmprs_len = cmprs_len;
-    
-    return(write_len);
-}
-
-#ifdef QBOOT_USING_APP_CHECK
-static int qbt_app_crc_cal(u32 *p_crc32, u32 max_cal_len, u8 *decmprs_buf, u8 *cmprs_buf, u32 *p_cmprs_len, int cmprs_type)
-{
-    int write_len = 0;
-    int cmprs_len = 0;
-    int decomp_len = 0;
-    int block_size = 0;
-    
-    cmprs_len = *p_cmprs_len;
-    
-    switch(cmprs_type)
-    {
-    case QBOOT_ALGO_CMPRS_NONE:
-        if (cmprs_len > max_cal_len)
-        {
-            cmprs_len = max_cal_len;
+            cmprs_ofs += (block_size + QBOOT_FASTLZ_BLOCK_HDR_SIZE);
         }
-        *p_crc32 = crc32_cyc_cal(*p_crc32, cmprs_buf, cmprs_len);
-        write_len = cmprs_len;
-        cmprs_len = 0;
-        break;
-        
-    #ifdef QBOOT_USING_GZIP
-    case QBOOT_ALGO_CMPRS_GZIP:
-        qbt_gzip_set_in(cmprs_buf, cmprs_len);
-        while(1)
+        if (cmprs_len > 0)
         {
-            bool is_end;
-
-            memcpy(decmprs_buf, gzip_remain_buf, gzip_remain_len);
-            decomp_len = qbt_gzip_decompress(decmprs_buf + gzip_remain_len, QBOOT_BUF_SIZE - gzip_remain_len);
-            if (decomp_len < 0)
-            {
-                write_len = -1;
-                cmprs_len = 0;
-                break;
-            }
-            is_end = (decomp_len < (QBOOT_BUF_SIZE - gzip_remain_len));
-            decomp_len += gzip_remain_len;
-            gzip_remain_len = decomp_len % GZIP_REMAIN_BUF_SIZE;
-            decomp_len -= gzip_remain_len;
-            memcpy(gzip_remain_buf, decmprs_buf + decomp_len, gzip_remain_len);
-            if (decomp_len > 0)
-            {
-                if (decomp_len > max_cal_len)
-                {
-                    decomp_len = max_cal_len;
-                }
-                *p_crc32 = crc32_cyc_cal(*p_crc32, decmprs_buf, decomp_len);
-            }
-            write_len += decomp_len;
-            if (is_end && (cmprs_len < QBOOT_CMPRS_READ_SIZE) && (gzip_remain_len > 0))//last package and remain > 0
-            {
-                if (gzip_remain_len > max_cal_len)
-                {
-                    gzip_remain_len = max_cal_len;
-                }
-                *p_crc32 = crc32_cyc_cal(*p_crc32, gzip_remain_buf, gzip_remain_len);
-                write_len += gzip_remain_len;
-            }
-            if (is_end)
-            {
-                cmprs_len = 0;
-                break;
-            }
+            memmove(cmprs_buf, cmprs_buf + cmprs_ofs, cmprs_len);//only the incomplete block is moved to the head
         }
         break;
     #endif
-    
-    #ifdef QBOOT_USING_QUICKLZ    
-    case QBOOT_ALGO_CMPRS_QUICKLZ:
+
+    #ifdef QBOOT_USING_LZ4
+    case QBOOT_ALGO_CMPRS_LZ4:
         while(1)
         {
-            if (cmprs_len < QBOOT_QUICKLZ_BLOCK_HDR_SIZE)
-            {
-                break;
-            }
-            block_size = qbt_quicklz_get_block_size(cmprs_buf);
-            if (block_size <= 0)
+            if (cmprs_len < QBOOT_LZ4_BLOCK_HDR_SIZE)
             {
                 break;
             }
-            if (cmprs_len < block_size + QBOOT_QUICKLZ_BLOCK_HDR_SIZE)
+            block_size = qbt_lz4_get_block_size(cmprs_buf + cmprs_ofs);
+            if (block_size == 0)//zero padding of aes-cbc after the last block
             {
                 break;
             }
-            decomp_len = qbt_quicklz_decompress(decmprs_buf, cmprs_buf + QBOOT_QUICKLZ_BLOCK_HDR_SIZE);
-            if (decomp_len <= 0)
+            if ((block_size < 0) || (block_size > QBOOT_CMPRS_BLOCK_MAX - QBOOT_LZ4_BLOCK_HDR_SIZE))//corrupt header, the block can not be staged in cmprs_buf
             {
+                LOG_E("Qboot decompress fail. block size %d is out of buffer.", block_size);
                 write_len = -1;
                 cmprs_len = 0;
                 break;
             }
-            if (decomp_len > max_cal_len)
-            {
-                decomp_len = max_cal_len;
-            }
-            *p_crc32 = crc32_cyc_cal(*p_crc32, decmprs_buf, decomp_len);
-            write_len += decomp_len;
-            cmprs_len -= (block_size + QBOOT_QUICKLZ_BLOCK_HDR_SIZE);
-            memcpy(cmprs_buf, cmprs_buf + (block_size + QBOOT_QUICKLZ_BLOCK_HDR_SIZE), cmprs_len);
-        }
-        break;
-    #endif
-
-    #ifdef QBOOT_USING_FASTLZ
-    case QBOOT_ALGO_CMPRS_FASTLZ:
-        while(1)
-        {
-            if (cmprs_len < QBOOT_FASTLZ_BLOCK_HDR_SIZE)
-            {
-                break;
-            }
-            block_size = qbt_fastlz_get_block_size(cmprs_buf);
-            if (block_size <= 0)
-            {
-                break;
-            }
-            if (cmprs_len < block_size + QBOOT_FASTLZ_BLOCK_HDR_SIZE)
+            if (cmprs_len < block_size + QBOOT_LZ4_BLOCK_HDR_SIZE)
             {
                 break;
             }
-            decomp_len = qbt_fastlz_decompress(decmprs_buf, QBOOT_BUF_SIZE, cmprs_buf + QBOOT_FASTLZ_BLOCK_HDR_SIZE, block_size);
+            decomp_len = qbt_lz4_decompress(decmprs_buf, QBOOT_BUF_SIZE, cmprs_buf + cmprs_ofs + QBOOT_LZ4_BLOCK_HDR_SIZE, block_size);
             if (decomp_len <= 0)
             {
                 write_len = -1;
                 cmprs_len = 0;
                 break;
             }
-            if (decomp_len > max_cal_len)
+            if (qbt_dest_data_write(part, pos, decmprs_buf, decomp_len) < 0)
             {
-                decomp_len = max_cal_len;
+                write_len = -1;
+                cmprs_len = 0;
+                break;
             }
-            *p_crc32 = crc32_cyc_cal(*p_crc32, decmprs_buf, decomp_len);
+            pos += decomp_len;
             write_len += decomp_len;
-            cmprs_len -= (block_size + QBOOT_FASTLZ_BLOCK_HDR_SIZE);
-            memcpy(cmprs_buf, cmprs_buf + (block_size + QBOOT_FASTLZ_BLOCK_HDR_SIZE), cmprs_len);
+            cmprs_len -= (block_size + QBOOT_LZ4_BLOCK_HDR_SIZE);
+            cmprs_ofs += (block_size + QBOOT_LZ4_BLOCK_HDR_SIZE);
+        }
+        if (cmprs_len > 0)
+        {
+            memmove(cmprs_buf, cmprs_buf + cmprs_ofs, cmprs_len);//only the incomplete block is moved to the head
         }
         break;
     #endif
@@ -630,38 +763,399 @@ static int qbt_app_crc_cal(u32 *p_crc32, u32 max_cal_len, u8 *decmprs_buf, u8 *c
     return(write_len);
 }
 
-static bool qbt_app_crc_check(const char *fw_part_name, fw_info_t *fw_info)
+#ifdef QBOOT_USING_BLOCK_INDEX
+static bool qbt_idx_pkg_open(qbt_idx_t *idx, fal_partition_t part, fw_info_t *fw_info)
 {
-    u32 crc32 = 0xFFFFFFFF;
-    u32 cmprs_len = 0;
-    u32 app_cal_pos = 0;
-    u32 src_read_pos = sizeof(fw_info_t);
-    fal_partition_t src_part = (fal_partition_t)fal_partition_find(fw_part_name);
-    int crypt_type = (fw_info->algo & QBOOT_ALGO_CRYPT_MASK);
-    int cmprs_type = (fw_info->algo & QBOOT_ALGO_CMPRS_MASK);
-
-
-    if ( ! qbt_fw_decrypt_init(crypt_type))
+    if ((fw_info->algo & QBOOT_ALGO_CRYPT_MASK) != QBOOT_ALGO_CRYPT_NONE)
     {
-        LOG_E("Qboot app crc check fail. nonsupport encrypt type.");
+        LOG_E("Qboot block index nonsupport encrypt type.");
         return(false);
     }
 
-    if ( ! qbt_fw_decompress_init(cmprs_type))
+    switch (fw_info->algo & QBOOT_ALGO_CMPRS_MASK)
     {
-        LOG_E("Qboot app crc check fail. nonsupport compress type.");
-        return(false);
-    }
+    case QBOOT_ALGO_CMPRS_NONE:
+    #ifdef QBOOT_USING_FASTLZ
+    case QBOOT_ALGO_CMPRS_FASTLZ:
+    #endif
+    #ifdef QBOOT_USING_LZ4
+    case QBOOT_ALGO_CMPRS_LZ4:
+    #endif
+        break;
+    default:
+        LOG_E("Qboot block index nonsupport compress type, blocks must be decoded independently.");
+        return(false);
+    }
+
+    return(qbt_idx_open(idx, part, pkg_base + sizeof(fw_info_t), fw_info->pkg_size, fw_info->raw_size));
+}
+
+static int qbt_idx_blk_decode(u8 *decmprs_buf, const u8 *cmprs_buf, u32 cmprs_len, int cmprs_type)
+{
+    u32 decomp_len = 0;
+
+    switch (cmprs_type)
+    {
+    case QBOOT_ALGO_CMPRS_NONE:
+        if (cmprs_len <= QBOOT_BUF_SIZE)
+        {
+            memcpy(decmprs_buf, cmprs_buf, cmprs_len);
+            decomp_len = cmprs_len;
+        }
+        break;
+
+    #ifdef QBOOT_USING_FASTLZ
+    case QBOOT_ALGO_CMPRS_FASTLZ:
+        if ((cmprs_len > QBOOT_FASTLZ_BLOCK_HDR_SIZE) && (qbt_fastlz_get_block_size(cmprs_buf) + QBOOT_FASTLZ_BLOCK_HDR_SIZE == cmprs_len))
+        {
+            decomp_len = qbt_fastlz_decompress(decmprs_buf, QBOOT_BUF_SIZE, cmprs_buf + QBOOT_FASTLZ_BLOCK_HDR_SIZE, cmprs_len - QBOOT_FASTLZ_BLOCK_HDR_SIZE);
+        }
+        break;
+    #endif
+
+    #ifdef QBOOT_USING_LZ4
+    case QBOOT_ALGO_CMPRS_LZ4:
+        if ((cmprs_len > QBOOT_LZ4_BLOCK_HDR_SIZE) && (qbt_lz4_get_block_size(cmprs_buf) + QBOOT_LZ4_BLOCK_HDR_SIZE == cmprs_len))
+        {
+            decomp_len = qbt_lz4_decompress(decmprs_buf, QBOOT_BUF_SIZE, cmprs_buf + QBOOT_LZ4_BLOCK_HDR_SIZE, cmprs_len - QBOOT_LZ4_BLOCK_HDR_SIZE);
+        }
+        break;
+    #endif
+
+    default:
+        break;
+    }
+
+    return((decomp_len > 0) ? (int)decomp_len : -1);
+}
+
+static bool qbt_idx_blk_load(const qbt_idx_t *idx, u32 blk_no, const qbt_idx_entry_t *entry, int cmprs_type)//block is decoded into crypt_buf and checked
+{
+    u32 pos = idx->body_pos + entry->cmprs_ofs;
+    int decomp_len;
+
+    if (entry->cmprs_len > QBOOT_CMPRS_BUF_SIZE)
+    {
+        LOG_E("Qboot block %d is too large, length = %d", blk_no, entry->cmprs_len);
+        return(false);
+    }
+    if (fal_partition_read(idx->part, pos, cmprs_buf, entry->cmprs_len) < 0)
+    {
+        LOG_E("Qboot read firmware datas fail. part = %s, addr = %08X, length = %d", idx->part->name, pos, entry->cmprs_len);
+        return(false);
+    }
+    decomp_len = qbt_idx_blk_decode(crypt_buf, cmprs_buf, entry->cmprs_len, cmprs_type);
+    if ((decomp_len < 0) || ((u32)decomp_len != entry->raw_len))
+    {
+        LOG_E("Qboot block %d decompress error.", blk_no);
+        return(false);
+    }
+    if (qbt_crc32_cal(crypt_buf, entry->raw_len) != entry->crc)
+    {
+        LOG_E("Qboot block %d crc error, addr = %08X", blk_no, pos);
+        return(false);
+    }
+
+    return(true);
+}
+
+#ifdef QBOOT_USING_APP_CHECK
+static bool qbt_idx_app_crc_check(const char *fw_part_name, fw_info_t *fw_info)
+{
+    qbt_idx_t idx;
+    qbt_idx_entry_t entry;
+    u32 crc32 = 0xFFFFFFFF;
+    fal_partition_t src_part = (fal_partition_t)fal_partition_find(fw_part_name);
+    int cmprs_type = (fw_info->algo & QBOOT_ALGO_CMPRS_MASK);
+
+    if ( ! qbt_idx_pkg_open(&idx, src_part, fw_info))
+    {
+        LOG_E("Qboot app crc check fail. block index error.");
+        return(false);
+    }
+
+    for (u32 blk_no = 0; blk_no < idx.blk_num; blk_no++)
+    {
+        if (( ! qbt_idx_entry_read(&idx, blk_no, &entry)) || ( ! qbt_idx_blk_load(&idx, blk_no, &entry, cmprs_type)))
+        {
+            LOG_E("Qboot app crc check fail. block %d of %d error.", blk_no, idx.blk_num);
+            return(false);
+        }
+        crc32 = qbt_crc32_cyc_cal(crc32, crypt_buf, entry.raw_len);
+    }
+
+    crc32 ^= 0xFFFFFFFF;
+    if (crc32 != fw_info->raw_crc)
+    {
+        LOG_E("Qboot app crc check fail. cal.crc: %08X != raw.crc: %08X", crc32, fw_info->raw_crc);
+        return(false);
+    }
+
+    return(true);
+}
+#endif
+#endif
+
+#ifdef QBOOT_USING_APP_CHECK
+static int qbt_app_crc_cal(u32 *p_crc32, u32 max_cal_len, u8 *decmprs_buf, u8 *cmprs_buf, u32 *p_cmprs_len, int cmprs_type)
+{
+    int write_len = 0;
+    int cmprs_len = 0;
+    #if defined(QBOOT_USING_GZIP) || defined(QBOOT_USING_QUICKLZ) || defined(QBOOT_USING_FASTLZ) || defined(QBOOT_USING_LZ4) || defined(QBOOT_USING_BLOCK_INDEX)
+    int decomp_len = 0;
+    #endif
+    #if defined(QBOOT_USING_QUICKLZ) || defined(QBOOT_USING_FASTLZ) || defined(QBOOT_USING_LZ4) || defined(QBOOT_USING_BLOCK_INDEX)
+    int block_size = 0;
+    int cmprs_ofs = 0;//cursor of the blocks of the block codecs
+    #endif
+    
+    cmprs_len = *p_cmprs_len;
+    
+    switch(cmprs_type)
+    {
+    case QBOOT_ALGO_CMPRS_NONE:
+        if (cmprs_len > max_cal_len)
+        {
+            cmprs_len = max_cal_len;
+        }
+        *p_crc32 = qbt_crc32_cyc_cal(*p_crc32, cmprs_buf, cmprs_len);
+        write_len = cmprs_len;
+        cmprs_len = 0;
+        break;
+        
+    #ifdef QBOOT_USING_GZIP
+    case QBOOT_ALGO_CMPRS_GZIP:
+        qbt_gzip_set_in(cmprs_buf, cmprs_len);
+        while(1)
+        {
+            bool is_end;
+
+            decomp_len = qbt_gzip_decompress(decmprs_buf, QBOOT_BUF_SIZE);
+            if (decomp_len < 0)
+            {
+                write_len = -1;
+                cmprs_len = 0;
+                break;
+            }
+            is_end = (decomp_len < QBOOT_BUF_SIZE);
+            if (decomp_len > max_cal_len - write_len)
+            {
+                decomp_len = max_cal_len - write_len;
+            }
+            *p_crc32 = qbt_crc32_cyc_cal(*p_crc32, decmprs_buf, decomp_len);
+            write_len += decomp_len;
+            if (is_end)
+            {
+                cmprs_len = 0;
+                break;
+            }
+        }
+        break;
+    #endif
+    
+    #ifdef QBOOT_USING_QUICKLZ    
+    case QBOOT_ALGO_CMPRS_QUICKLZ:
+        while(1)
+        {
+            if (cmprs_len < QBOOT_QUICKLZ_BLOCK_HDR_SIZE)
+            {
+                break;
+            }
+            block_size = qbt_quicklz_get_block_size(cmprs_buf + cmprs_ofs);
+            if (block_size == 0)//zero padding of aes-cbc after the last block
+            {
+                break;
+            }
+            if ((block_size < 0) || (block_size > QBOOT_CMPRS_BLOCK_MAX - QBOOT_QUICKLZ_BLOCK_HDR_SIZE))//corrupt header, the block can not be staged in cmprs_buf
+            {
+                LOG_E("Qboot decompress fail. block size %d is out of buffer.", block_size);
+                write_len = -1;
+                cmprs_len = 0;
+                break;
+            }
+            if (cmprs_len < block_size + QBOOT_QUICKLZ_BLOCK_HDR_SIZE)
+            {
+                break;
+            }
+            decomp_len = qbt_quicklz_decompress(decmprs_buf, cmprs_buf + cmprs_ofs + QBOOT_QUICKLZ_BLOCK_HDR_SIZE);
+            if (decomp_len <= 0)
+            {
+                write_len = -1;
+                cmprs_len = 0;
+                break;
+            }
+            if (decomp_len > max_cal_len)
+            {
+                decomp_len = max_cal_len;
+            }
+            *p_crc32 = qbt_crc32_cyc_cal(*p_crc32, decmprs_buf, decomp_len);
+            write_len += decomp_len;
+            cmprs_len -= (block_size + QBOOT_QUICKLZ_BLOCK_HDR_SIZE);
+            cmprs_ofs += (block_size + QBOOT_QUICKLZ_BLOCK_HDR_SIZE);
+        }
+        if (cmprs_len > 0)
+        {
+            memmove(cmprs_buf, cmprs_buf + cmprs_ofs, cmprs_len);//only the incomplete block is moved to the head
+        }
+        break;
+    #endif
+
+    #ifdef QBOOT_USING_FASTLZ
+    case QBOOT_ALGO_CMPRS_FASTLZ:
+        while(1)
+        {
+            if (cmprs_len < QBOOT_FASTLZ_BLOCK_HDR_SIZE)
+            {
+                break;
+            }
+            block_size = qbt_fastlz_get_block_size(cmprs_buf + cmprs_ofs);
+            if (block_size == 0)//zero padding of aes-cbc after the last block
+            {
+                break;
+            }
+            if ((block_size < 0) || (block_size > QBOOT_CMPRS_BLOCK_MAX - QBOOT_FASTLZ_BLOCK_HDR_SIZE))//corrupt header, the block can not be staged in cmprs_buf
+            {
+                LOG_E("Qboot decompress fail. block size %d is out of buffer.", block_size);
+                write_len = -1;
+                cmprs_len = 0;
+                break;
+            }
+            if (cmprs_len < block_size + QBOOT_FASTLZ_BLOCK_HDR_SIZE)
+            {
+                break;
+            }
+            decomp_len = qbt_fastlz_decompress(decmprs_buf, QBOOT_BUF_SIZE, cmprs_buf + cmprs_ofs + QBOOT_FASTLZ_BLOCK_HDR_SIZE, block_size);
+            if (decomp_len <= 0)
+            {
+                write_len = -1;
+                cmprs_len = 0;
+                break;
+            }
+            if (decomp_len > max_cal_len)
+            {
+                decomp_len = max_cal_len;
+            }
+            *p_crc32 = qbt_crc32_cyc_cal(*p_crc32, decmprs_buf, decomp_len);
+            write_len += decomp_len;
+            cmprs_len -= (block_size + QBOOT_FASTLZ_BLOCK_HDR_SIZE);
+            cmprs_ofs += (block_size + QBOOT_FASTLZ_BLOCK_HDR_SIZE);
+        }
+        if (cmprs_len > 0)
+        {
+            memmove(cmprs_buf, cmprs_buf + cmprs_ofs, cmprs_len);//only the incomplete block is moved to the head
+        }
+        break;
+    #endif
+
+    #ifdef QBOOT_USING_LZ4
+    case QBOOT_ALGO_CMPRS_LZ4:
+        while(1)
+        {
+            if (cmprs_len < QBOOT_LZ4_BLOCK_HDR_SIZE)
+            {
+                break;
+            }
+            block_size = qbt_lz4_get_block_size(cmprs_buf + cmprs_ofs);
+            if (block_size == 0)//zero padding of aes-cbc after the last block
+            {
+                break;
+            }
+            if ((block_size < 0) || (block_size > QBOOT_CMPRS_BLOCK_MAX - QBOOT_LZ4_BLOCK_HDR_SIZE))//corrupt header, the block can not be staged in cmprs_buf
+            {
+                LOG_E("Qboot decompress fail. block size %d is out of buffer.", block_size);
+                write_len = -1;
+                cmprs_len = 0;
+                break;
+            }
+            if (cmprs_len < block_size + QBOOT_LZ4_BLOCK_HDR_SIZE)
+            {
+                break;
+            }
+            decomp_len = qbt_lz4_decompress(decmprs_buf, QBOOT_BUF_SIZE, cmprs_buf + cmprs_ofs + QBOOT_LZ4_BLOCK_HDR_SIZE, block_size);
+            if (decomp_len <= 0)
+            {
+                write_len = -1;
+                cmprs_len = 0;
+                break;
+            }
+            if (decomp_len > max_cal_len)
+            {
+                decomp_len = max_cal_len;
+            }
+            *p_crc32 = qbt_crc32_cyc_cal(*p_crc32, decmprs_buf, decomp_len);
+            write_len += decomp_len;
+            cmprs_len -= (block_size + QBOOT_LZ4_BLOCK_HDR_SIZE);
+            cmprs_ofs += (block_size + QBOOT_LZ4_BLOCK_HDR_SIZE);
+        }
+        if (cmprs_len > 0)
+        {
+            memmove(cmprs_buf, cmprs_buf + cmprs_ofs, cmprs_len);//only the incomplete block is moved to the head
+        }
+        break;
+    #endif
+        
+    default:
+        write_len = -1;
+        cmprs_len = 0;
+        break;
+    }  
+
+    *p_cmprs_len = cmprs_len;
+    
+    return(write_len);
+}
+
+static bool qbt_app_crc_check(const char *fw_part_name, fw_info_t *fw_info)
+{
+    u32 crc32 = 0xFFFFFFFF;
+    u32 cmprs_len = 0;
+    u32 app_cal_pos = 0;
+    u32 src_read_pos = pkg_base + sizeof(fw_info_t);
+    fal_partition_t src_part = (fal_partition_t)fal_partition_find(fw_part_name);
+    int crypt_type = (fw_info->algo & QBOOT_ALGO_CRYPT_MASK);
+    int cmprs_type = (fw_info->algo & QBOOT_ALGO_CMPRS_MASK);
+
+    #ifdef QBOOT_USING_BLOCK_INDEX
+    if (fw_info->algo2 & QBOOT_ALGO2_BLOCK_INDEX)
+    {
+        return(qbt_idx_app_crc_check(fw_part_name, fw_info));
+    }
+    #endif
+
+    #ifdef QBOOT_USING_MAPPED_READ
+    if ((crypt_type == QBOOT_ALGO_CRYPT_NONE) && (cmprs_type == QBOOT_ALGO_CMPRS_NONE) && (qbt_map_view(src_part, 0, RT_NULL) != RT_NULL))
+    {
+        return(qbt_fw_crc_check(fw_part_name, src_read_pos, fw_info->raw_size, fw_info->raw_crc));//the body is the code
+    }
+    #endif
+
+    if ( ! qbt_fw_decrypt_init(crypt_type))
+    {
+        LOG_E("Qboot app crc check fail. nonsupport encrypt type.");
+        return(false);
+    }
+
+    if ( ! qbt_fw_decompress_init(cmprs_type))
+    {
+        LOG_E("Qboot app crc check fail. nonsupport compress type.");
+        return(false);
+    }
 
     while(app_cal_pos < fw_info->raw_size)
     {
         int cal_len = 0;
         int read_len = QBOOT_CMPRS_READ_SIZE;
-        int remain_len = (fw_info->pkg_size + sizeof(fw_info_t) - src_read_pos);
+        int remain_len = (pkg_base + fw_info->pkg_size + sizeof(fw_info_t) - src_read_pos);
         if (read_len > remain_len)
         {
             read_len = remain_len;
         }
+        if (cmprs_len + read_len > QBOOT_CMPRS_BUF_SIZE)//blocks are not decoded, the package is corrupt
+        {
+            qbt_fw_decompress_deinit(cmprs_type);
+            LOG_E("Qboot app crc check fail. decompress error, part = %s, addr = %08X", fw_part_name, src_read_pos);
+            return(false);
+        }
         if ( ! qbt_fw_pkg_read(src_part, src_read_pos, cmprs_buf + cmprs_len, read_len, crypt_buf, crypt_type))
         {
             qbt_fw_decompress_deinit(cmprs_type);
@@ -694,16 +1188,395 @@ static bool qbt_app_crc_check(const char *fw_part_name, fw_info_t *fw_info)
 }
 #endif
 
+#ifdef QBOOT_USING_FUSED_RELEASE
+static bool qbt_fused_is_used(const char *src_part_name, fw_info_t *fw_info)
+{
+    //in-place differential patch can not be verified while releasing, all images of manifest are checked before any of them is released
+    if (((fw_info->algo & QBOOT_ALGO_CMPRS_MASK) == QBOOT_ALGO_CMPRS_HPATCHLITE) || (fw_info->algo2 & QBOOT_ALGO2_MANIFEST))
+    {
+        return(false);
+    }
+    //a broken package is found after the application is overwritten, the factory package must be there to restore it
+    return((strcmp(src_part_name, QBOOT_FACTORY_PART_NAME) != 0) && qbt_part_is_exist(QBOOT_FACTORY_PART_NAME));
+}
+
+static void qbt_fused_init(const char *src_part_name, fw_info_t *fw_info)
+{
+    fused_ctx.enable = qbt_fused_is_used(src_part_name, fw_info);
+    fused_ctx.raw_size = fw_info->raw_size;
+    fused_ctx.pkg_crc = 0xFFFFFFFF;
+    fused_ctx.raw_crc = 0xFFFFFFFF;
+}
+
+static bool qbt_fused_release_check(fal_partition_t src_part, u32 src_read_pos, fw_info_t *fw_info)
+{
+    u32 pkg_end = pkg_base + fw_info->pkg_size + sizeof(fw_info_t);
+
+    fused_ctx.enable = false;
+
+    while (src_read_pos < pkg_end)//the tail of package is not needed by decompressor
+    {
+        int read_len = QBOOT_BUF_SIZE;
+        if (read_len > pkg_end - src_read_pos)
+        {
+            read_len = pkg_end - src_read_pos;
+        }
+        if (qbt_src_data_read(src_part, src_read_pos, cmprs_buf, read_len) < 0)
+        {
+            LOG_E("Qboot read firmware datas fail. part = %s, addr = %08X, length = %d", src_part->name, src_read_pos, read_len);
+            return(false);
+        }
+        fused_ctx.pkg_crc = qbt_crc32_cyc_cal(fused_ctx.pkg_crc, cmprs_buf, read_len);
+        src_read_pos += read_len;
+    }
+
+    fused_ctx.pkg_crc ^= 0xFFFFFFFF;
+    if (fused_ctx.pkg_crc != fw_info->pkg_crc)
+    {
+        LOG_E("Qboot verify CRC32 error, cal.crc: %08X != body.crc: %08X", fused_ctx.pkg_crc, fw_info->pkg_crc);
+        return(false);
+    }
+
+    fused_ctx.raw_crc ^= 0xFFFFFFFF;
+    if (((fw_info->algo2 & QBOOT_ALGO2_VERIFY_MASK) == QBOOT_ALGO2_VERIFY_CRC) && (fused_ctx.raw_crc != fw_info->raw_crc))
+    {
+        LOG_E("Qboot app crc check fail. cal.crc: %08X != raw.crc: %08X", fused_ctx.raw_crc, fw_info->raw_crc);
+        return(false);
+    }
+
+    return(true);
+}
+#endif
+
+#ifdef QBOOT_USING_PIPELINE
+static void qbt_pipeline_open(fal_partition_t src_part, u32 src_pos, fal_partition_t dst_part, fw_info_t *fw_info)
+{
+    src_pipe = qbt_pipe_reader_open(src_part, src_pos, pkg_base + fw_info->pkg_size + sizeof(fw_info_t), QBOOT_CMPRS_READ_SIZE);
+    dst_pipe = qbt_pipe_writer_open(dst_part, QBOOT_BUF_SIZE, qbt_dest_flash_write);
+    if ((src_pipe == NULL) || (dst_pipe == NULL))
+    {
+        LOG_W("Qboot pipeline is not available, release firmware in sequence.");
+    }
+}
+
+static bool qbt_pipeline_close(void)
+{
+    bool ret = true;
+
+    if (src_pipe != NULL)
+    {
+        ret = (qbt_pipe_close(src_pipe) && ret);
+        src_pipe = NULL;
+    }
+    if (dst_pipe != NULL)
+    {
+        ret = (qbt_pipe_close(dst_pipe) && ret);
+        dst_pipe = NULL;
+    }
+    
+    return(ret);
+}
+#endif
+
+#ifndef QBOOT_USING_FLASH_WRITER
+static int qbt_dest_code_erase(fal_partition_t part, u32 pos, u32 size)
+{
+    int rst;
+
+    qbt_stats_phase_begin(QBOOT_STATS_ERASE);
+    rst = fal_partition_erase(part, pos, size - pos);
+    qbt_stats_phase_end(QBOOT_STATS_ERASE);
+
+    return(rst);
+}
+#endif
+
+#ifdef QBOOT_USING_RESUME
+static bool qbt_resume_is_supported(fw_info_t *fw_info)
+{
+    //only the incomplete block is kept by decoder, gzip and quicklz have a history window, aes cbc chains the blocks
+    //aes ctr decrypts from any position, indexed package is resumed by skipping the blocks released already
+    int crypt_type = (fw_info->algo & QBOOT_ALGO_CRYPT_MASK);
+    int cmprs_type = (fw_info->algo & QBOOT_ALGO_CMPRS_MASK);
+
+    if (((crypt_type != QBOOT_ALGO_CRYPT_NONE) && (crypt_type != QBOOT_ALGO_CRYPT_AES_CTR)) || (fw_info->algo2 & QBOOT_ALGO2_BLOCK_INDEX))
+    {
+        return(false);
+    }
+    return((cmprs_type == QBOOT_ALGO_CMPRS_NONE) || (cmprs_type == QBOOT_ALGO_CMPRS_FASTLZ) || (cmprs_type == QBOOT_ALGO_CMPRS_LZ4));
+}
+
+static bool qbt_resume_ckpt_read(resume_ckpt_t *ckpt)
+{
+    return(qbt_meta_read(QBOOT_META_TYPE_RESUME, ckpt, sizeof(resume_ckpt_t)) && (ckpt->hdr_crc != 0));
+}
+
+static bool qbt_resume_is_pending(fw_info_t *fw_info)//release of the package was interrupted
+{
+    resume_ckpt_t ckpt;
+    return(qbt_resume_ckpt_read(&ckpt) && (ckpt.hdr_crc == fw_info->hdr_crc) && (ckpt.pkg_crc == fw_info->pkg_crc));
+}
+
+static void qbt_resume_clear(void)
+{
+    resume_ckpt_t ckpt;
+
+    resume_ctx.enable = false;
+    if ( ! qbt_resume_ckpt_read(&ckpt))//nothing is written if no checkpoint is kept
+    {
+        return;
+    }
+    memset(&ckpt, 0, sizeof(ckpt));
+    if ( ! qbt_meta_write(QBOOT_META_TYPE_RESUME, &ckpt, sizeof(ckpt)))
+    {
+        LOG_W("Qboot clear release checkpoint fail.");
+    }
+}
+
+static bool qbt_resume_begin(fal_partition_t src_part, fal_partition_t dst_part, fw_info_t *fw_info)//return true if continued from the checkpoint
+{
+    resume_ckpt_t *ckpt = &resume_ctx.ckpt;
+    u32 name_len;
+    bool is_valid;
+
+    is_valid = (qbt_resume_ckpt_read(ckpt) && qbt_resume_is_supported(fw_info)
+                && (ckpt->hdr_crc == fw_info->hdr_crc) && (ckpt->pkg_crc == fw_info->pkg_crc)
+                && (strncmp((const char *)ckpt->dst_name, dst_part->name, sizeof(ckpt->dst_name)) == 0)
+                && (ckpt->dst_pos < fw_info->raw_size) && (ckpt->src_pos <= pkg_base + fw_info->pkg_size + sizeof(fw_info_t))
+                && (ckpt->cmprs_len <= QBOOT_CMPRS_BUF_SIZE - QBOOT_CMPRS_READ_SIZE)
+                && (ckpt->src_pos >= pkg_base + sizeof(fw_info_t)) && (ckpt->cmprs_len <= ckpt->src_pos - pkg_base - sizeof(fw_info_t)));
+    if (is_valid && (ckpt->cmprs_len > 0))
+    {
+        is_valid = (fal_partition_read(src_part, ckpt->src_pos - ckpt->cmprs_len, cmprs_buf, ckpt->cmprs_len) >= 0);
+    }
+    #ifdef QBOOT_USING_AES
+    if (is_valid && ((fw_info->algo & QBOOT_ALGO_CRYPT_MASK) == QBOOT_ALGO_CRYPT_AES_CTR))
+    {
+        qbt_aes_ctr_seek(ckpt->src_pos - ckpt->cmprs_len - pkg_base - sizeof(fw_info_t));
+        qbt_aes_decrypt(cmprs_buf, cmprs_buf, ckpt->cmprs_len);//the incomplete block read again is decrypted, then the package goes on from src_pos
+    }
+    #endif
+    if ( ! is_valid)
+    {
+        qbt_resume_clear();//the checkpoint of other package or destination is stale
+        memset(ckpt, 0, sizeof(resume_ckpt_t));
+        ckpt->hdr_crc = fw_info->hdr_crc;
+        ckpt->pkg_crc = fw_info->pkg_crc;
+        name_len = strlen(dst_part->name);
+        if (name_len > sizeof(ckpt->dst_name) - 1)//a longer name never matches the record, the release is not resumed
+        {
+            name_len = sizeof(ckpt->dst_name) - 1;
+        }
+        memcpy(ckpt->dst_name, dst_part->name, name_len);
+        ckpt->dst_name[name_len] = '\0';
+        ckpt->src_pos = pkg_base + sizeof(fw_info_t);
+    }
+
+    resume_ctx.enable = (qbt_resume_is_supported(fw_info) && (qbt_part_sector_size(dst_part) > 0));
+    resume_ctx.next_pos = ckpt->dst_pos + QBOOT_RESUME_INTERVAL;
+
+    return(is_valid);
+}
+
+static bool qbt_resume_checkpoint(fal_partition_t dst_part, u32 dst_pos, u32 src_pos, u32 cmprs_len)
+{
+    resume_ckpt_t *ckpt = &resume_ctx.ckpt;
+
+    //checkpoint is taken at sector boundary, the sectors before it are not touched when resuming
+    if (( ! resume_ctx.enable) || (dst_pos < resume_ctx.next_pos) || ((dst_part->offset + dst_pos) % qbt_part_sector_size(dst_part) != 0))
+    {
+        return(true);
+    }
+
+    //code before dst_pos must be in flash before the checkpoint is saved
+    if ( ! qbt_burst_flush())//dst_pos is at a program unit, nothing is padded
+    {
+        return(false);
+    }
+    #ifdef QBOOT_USING_PIPELINE
+    if ((dst_pipe != NULL) && ( ! qbt_pipe_flush(dst_pipe)))
+    {
+        return(false);
+    }
+    #endif
+    #ifdef QBOOT_USING_FLASH_WRITER
+    if ( ! qbt_flash_write_sync())
+    {
+        return(false);
+    }
+    #endif
+
+    ckpt->dst_pos = dst_pos;
+    ckpt->src_pos = src_pos;
+    ckpt->cmprs_len = cmprs_len;
+    #ifdef QBOOT_USING_FUSED_RELEASE
+    ckpt->fused_pkg_crc = fused_ctx.pkg_crc;
+    ckpt->fused_raw_crc = fused_ctx.raw_crc;
+    #endif
+    if ( ! qbt_meta_write(QBOOT_META_TYPE_RESUME, ckpt, sizeof(resume_ckpt_t)))
+    {
+        LOG_W("Qboot save release checkpoint fail, release can not be resumed.");
+        resume_ctx.enable = false;
+        return(true);
+    }
+    resume_ctx.next_pos = dst_pos + QBOOT_RESUME_INTERVAL;
+
+    return(true);
+}
+#endif
+
+#ifdef QBOOT_USING_CHECK_CACHE
+/*
+ * The key of header and package crc tells nothing of the body when it is rewritten, e.g. a download
+ * of the same package interrupted in the body, so only the factory partition is cached.
+ */
+static bool qbt_check_cache_is_allowed(const char *part_name)
+{
+    return(strcmp(part_name, QBOOT_FACTORY_PART_NAME) == 0);
+}
+
+static bool qbt_check_cache_hit(const char *part_name, fw_info_t *fw_info)//the package passed the check before and its header is not changed
+{
+    check_cache_t cache;
+    check_cache_ent_t *ent = &cache.factory;
+
+    if (( ! qbt_check_cache_is_allowed(part_name)) || ( ! qbt_meta_read(QBOOT_META_TYPE_CHECK, &cache, sizeof(cache))))
+    {
+        return(false);
+    }
+    return((ent->epoch == QBOOT_CHECK_CACHE_EPOCH) && (ent->hdr_crc == fw_info->hdr_crc) && (ent->pkg_crc == fw_info->pkg_crc));
+}
+
+static void qbt_check_cache_set(const char *part_name, fw_info_t *fw_info)//fw_info is NULL to drop the entry
+{
+    check_cache_t cache;
+    check_cache_ent_t ent = {0};
+
+    if ( ! qbt_check_cache_is_allowed(part_name))
+    {
+        return;
+    }
+    if ( ! qbt_meta_read(QBOOT_META_TYPE_CHECK, &cache, sizeof(cache)))
+    {
+        if (fw_info == NULL)//nothing is cached
+        {
+            return;
+        }
+        memset(&cache, 0, sizeof(cache));
+    }
+    if (fw_info != NULL)
+    {
+        ent.hdr_crc = fw_info->hdr_crc;
+        ent.pkg_crc = fw_info->pkg_crc;
+        ent.epoch = QBOOT_CHECK_CACHE_EPOCH;
+    }
+    if (memcmp(&cache.factory, &ent, sizeof(ent)) == 0)//a record is written only when the entry changes
+    {
+        return;
+    }
+    cache.factory = ent;
+    if ( ! qbt_meta_write(QBOOT_META_TYPE_CHECK, &cache, sizeof(cache)))
+    {
+        LOG_W("Qboot save check cache of %s fail.", part_name);
+    }
+}
+#endif
+
+#ifdef QBOOT_USING_BLOCK_INDEX
+static bool qbt_idx_skip_is_allowed(fal_partition_t dst_part, const qbt_idx_t *idx)
+{
+    #ifdef QBOOT_USING_FLASH_WRITER
+    //code is not erased before release, a block whose sectors are not shared with others can be skipped
+    const struct fal_flash_dev *flash_dev = fal_flash_device_find(dst_part->flash_name);
+    return((flash_dev != NULL) && (flash_dev->blk_size > 0)
+           && (idx->blk_size % flash_dev->blk_size == 0) && (dst_part->offset % flash_dev->blk_size == 0));
+    #else
+    return(false);//code is erased before release
+    #endif
+}
+
+static bool qbt_idx_blk_is_same(fal_partition_t dst_part, u32 pos, const qbt_idx_entry_t *entry)//destination holds the block already, read into crypt_buf
+{
+    if (fal_partition_read(dst_part, pos, crypt_buf, entry->raw_len) < 0)
+    {
+        return(false);
+    }
+    return(qbt_crc32_cal(crypt_buf, entry->raw_len) == entry->crc);
+}
+
+static bool qbt_idx_release(const qbt_idx_t *idx, fal_partition_t dst_part, fw_info_t *fw_info)
+{
+    qbt_idx_entry_t entry;
+    u32 crc32 = 0xFFFFFFFF;
+    u32 skip_cnt = 0;
+    bool skip_en = qbt_idx_skip_is_allowed(dst_part, idx);
+    int cmprs_type = (fw_info->algo & QBOOT_ALGO_CMPRS_MASK);
+
+    qbt_prog_begin(QBOOT_PROG_RELEASE, dst_part->name, fw_info->raw_size);
+    for (u32 blk_no = 0; blk_no < idx->blk_num; blk_no++)
+    {
+        u32 pos = blk_no * idx->blk_size;
+        if ( ! qbt_idx_entry_read(idx, blk_no, &entry))
+        {
+            return(false);
+        }
+        if (skip_en && qbt_idx_blk_is_same(dst_part, pos, &entry))
+        {
+            skip_cnt++;
+        }
+        else
+        {
+            if ( ! qbt_idx_blk_load(idx, blk_no, &entry, cmprs_type))//checked before it is written
+            {
+                LOG_E("Qboot release firmware fail. block %d of %d error.", blk_no, idx->blk_num);
+                return(false);
+            }
+            if (qbt_dest_data_write(dst_part, pos, crypt_buf, entry.raw_len) < 0)
+            {
+                LOG_E("Qboot release firmware fail. write destination error, part = %s, addr = %08X", dst_part->name, pos);
+                return(false);
+            }
+        }
+        crc32 = qbt_crc32_cyc_cal(crc32, crypt_buf, entry.raw_len);
+        qbt_prog_update(pos + entry.raw_len);
+    }
+    qbt_prog_end(true);
+    if (skip_cnt > 0)
+    {
+        LOG_I("Qboot %d of %d blocks are same as %s, skipped.", skip_cnt, idx->blk_num, dst_part->name);
+    }
+
+    crc32 ^= 0xFFFFFFFF;
+    if (((fw_info->algo2 & QBOOT_ALGO2_VERIFY_MASK) == QBOOT_ALGO2_VERIFY_CRC) && (crc32 != fw_info->raw_crc))
+    {
+        LOG_E("Qboot app crc check fail. cal.crc: %08X != raw.crc: %08X", crc32, fw_info->raw_crc);
+        return(false);
+    }
+
+    return(true);
+}
+#endif
+
 static bool qbt_fw_release(const char *dst_part_name, const char *src_part_name, fw_info_t *fw_info)
 {
     u32 cmprs_len = 0;
     u32 dst_write_pos = 0;
-    u32 src_read_pos = sizeof(fw_info_t);
+    u32 src_read_pos = pkg_base + sizeof(fw_info_t);
     fal_partition_t src_part = (fal_partition_t)fal_partition_find(src_part_name);
     fal_partition_t dst_part = (fal_partition_t)fal_partition_find(dst_part_name);
     int crypt_type = (fw_info->algo & QBOOT_ALGO_CRYPT_MASK);
     int cmprs_type = (fw_info->algo & QBOOT_ALGO_CMPRS_MASK);
+    #ifdef QBOOT_USING_BLOCK_INDEX
+    qbt_idx_t idx;
+
+    if ((fw_info->algo2 & QBOOT_ALGO2_BLOCK_INDEX) && ( ! qbt_idx_pkg_open(&idx, src_part, fw_info)))//destination is kept if index is broken
+    {
+        LOG_E("Qboot release firmware fail. block index error.");
+        return(false);
+    }
+    #endif
 
+    qbt_arena_reset();
     if ( ! qbt_fw_decrypt_init(crypt_type))
     {
         LOG_E("Qboot release firmware fail. nonsupport encrypt type.");
@@ -718,40 +1591,98 @@ static bool qbt_fw_release(const char *dst_part_name, const char *src_part_name,
     #ifdef QBOOT_USING_HPATCHLITE
     if(cmprs_type == QBOOT_ALGO_CMPRS_HPATCHLITE)
     {
-        if(qbt_hpatchlite_release_from_part(src_part, dst_part, fw_info->pkg_size, fw_info->raw_size, sizeof(fw_info_t)) == true)
+        qbt_prog_begin(QBOOT_PROG_RELEASE, dst_part_name, fw_info->raw_size);
+        if(qbt_hpatchlite_release_from_part(src_part, dst_part, fw_info->pkg_size, fw_info->raw_size, pkg_base + sizeof(fw_info_t)) == true)
         {
+            qbt_prog_end(true);
             goto done;
         }
         else
         {
+            qbt_prog_end(false);
             return(false);
         }
     }
     #endif
+    #ifdef QBOOT_USING_RESUME
+    if (qbt_resume_begin(src_part, dst_part, fw_info))
+    {
+        dst_write_pos = resume_ctx.ckpt.dst_pos;
+        src_read_pos = resume_ctx.ckpt.src_pos;
+        cmprs_len = resume_ctx.ckpt.cmprs_len;
+        LOG_I("Qboot resume release to %s from checkpoint, %d of %d bytes are released.", dst_part_name, dst_write_pos, fw_info->raw_size);
+    }
+    #endif
+    #ifdef QBOOT_USING_FLASH_WRITER
+    if ((fal_partition_erase(dst_part, dst_part->len - sizeof(fw_info_t), sizeof(fw_info_t)) < 0)
+        || ( ! qbt_flash_write_begin(dst_part)))//the sectors of code are erased on demand while releasing
+    #else
     rt_kprintf("Start erase partition %s ...\n", dst_part_name);
-    if ((fal_partition_erase(dst_part, 0, fw_info->raw_size) < 0) 
+    if ((qbt_dest_code_erase(dst_part, dst_write_pos, fw_info->raw_size) < 0) 
         || (fal_partition_erase(dst_part, dst_part->len - sizeof(fw_info_t), sizeof(fw_info_t)) < 0))
+    #endif
     {
         qbt_fw_decompress_deinit(cmprs_type);
         LOG_E("Qboot release firmware fail. erase %s error.", dst_part_name);
         return(false);
     }
+    qbt_burst_begin(qbt_dest_burst_out);
+
+    #ifdef QBOOT_USING_FUSED_RELEASE
+    qbt_fused_init(src_part_name, fw_info);
+    #ifdef QBOOT_USING_RESUME
+    if (dst_write_pos > 0)
+    {
+        fused_ctx.pkg_crc = resume_ctx.ckpt.fused_pkg_crc;
+        fused_ctx.raw_crc = resume_ctx.ckpt.fused_raw_crc;
+    }
+    #endif
+    #endif
+
+    #ifdef QBOOT_USING_BLOCK_INDEX
+    if (fw_info->algo2 & QBOOT_ALGO2_BLOCK_INDEX)
+    {
+        #ifdef QBOOT_USING_FUSED_RELEASE
+        fused_ctx.enable = false;//every block and the code are verified by qbt_idx_release
+        #endif
+        if (( ! qbt_idx_release(&idx, dst_part, fw_info)) || ( ! qbt_burst_flush()))
+        {
+            goto fail;
+        }
+        goto written;
+    }
+    #endif
+
+    #ifdef QBOOT_USING_PIPELINE
+    qbt_pipeline_open(src_part, src_read_pos, dst_part, fw_info);
+    #endif
 
-    rt_kprintf("Start release firmware to %s ...     ", dst_part_name);
+    qbt_prog_begin(QBOOT_PROG_RELEASE, dst_part_name, fw_info->raw_size);
     while(dst_write_pos < fw_info->raw_size)
     {
         int write_len = 0;
         int read_len = QBOOT_CMPRS_READ_SIZE;
-        int remain_len = (fw_info->pkg_size + sizeof(fw_info_t) - src_read_pos);
+        int remain_len = (pkg_base + fw_info->pkg_size + sizeof(fw_info_t) - src_read_pos);
         if (read_len > remain_len)
         {
             read_len = remain_len;
         }
+        #ifdef QBOOT_USING_RESUME
+        if ( ! qbt_resume_checkpoint(dst_part, dst_write_pos, src_read_pos, cmprs_len))
+        {
+            LOG_E("Qboot release firmware fail. write destination error, part = %s, addr = %08X", dst_part_name, dst_write_pos);
+            goto fail;
+        }
+        #endif
+        if (cmprs_len + read_len > QBOOT_CMPRS_BUF_SIZE)//blocks are not decoded, the package is corrupt
+        {
+            LOG_E("Qboot release firmware fail. decompress error, part = %s, addr = %08X", src_part_name, src_read_pos);
+            goto fail;
+        }
         if ( ! qbt_fw_pkg_read(src_part, src_read_pos, cmprs_buf + cmprs_len, read_len, crypt_buf, crypt_type))
         {
-            qbt_fw_decompress_deinit(cmprs_type);
             LOG_E("Qboot release firmware fail. read package error, part = %s, addr = %08X, length = %d", src_part_name, src_read_pos, read_len);
-            return(false);
+            goto fail;
         }
         src_read_pos += read_len;
         cmprs_len += read_len;
@@ -759,18 +1690,61 @@ static bool qbt_fw_release(const char *dst_part_name, const char *src_part_name,
         write_len = qbt_dest_part_write(dst_part, dst_write_pos, crypt_buf, cmprs_buf, &cmprs_len, cmprs_type);
         if (write_len < 0)
         {
-            qbt_fw_decompress_deinit(cmprs_type);
             LOG_E("Qboot release firmware fail. write destination error, part = %s, addr = %08X", dst_part_name, dst_write_pos);
-            return(false);
+            goto fail;
+        }
+        if ((read_len == 0) && (write_len == 0))
+        {
+            LOG_E("Qboot release firmware fail. package datas is incomplete, part = %s, addr = %08X", src_part_name, src_read_pos);
+            goto fail;
         }
         dst_write_pos += write_len;
 
-        rt_kprintf("\b\b\b%02d%%", (dst_write_pos * 100 / fw_info->raw_size));
+        qbt_prog_update(dst_write_pos);
     }
-    rt_kprintf("\n");
+    qbt_prog_end(true);
+    if ( ! qbt_burst_flush())//the tail of code is padded to a program unit
+    {
+        LOG_E("Qboot release firmware fail. write destination error, part = %s, addr = %08X", dst_part_name, dst_write_pos);
+        goto fail;
+    }
+
+    #ifdef QBOOT_USING_FUSED_RELEASE
+    if (fused_ctx.enable)
+    {
+        if ( ! qbt_fused_release_check(src_part, src_read_pos, fw_info))
+        {
+            goto fail;
+        }
+    }
+    #endif
+
+    #ifdef QBOOT_USING_PIPELINE
+    if ( ! qbt_pipeline_close())
+    {
+        LOG_E("Qboot release firmware fail. pipeline transfer error, part = %s", dst_part_name);
+        goto fail;
+    }
+    #endif
+
+    #ifdef QBOOT_USING_BLOCK_INDEX
+written:
+    #endif
+    #ifdef QBOOT_USING_FLASH_WRITER
+    if ( ! qbt_flash_write_end(true))
+    {
+        LOG_E("Qboot release firmware fail. write destination error, part = %s", dst_part_name);
+        goto fail;
+    }
+    #endif
 
+    #ifdef QBOOT_USING_HPATCHLITE
 done:
+    #endif
     qbt_fw_decompress_deinit(cmprs_type);
+    #ifdef QBOOT_USING_RESUME
+    qbt_resume_clear();//code is complete, or it is invalidated below
+    #endif
     if ( ! qbt_fw_info_write(dst_part_name, fw_info, true))
     {
         LOG_E("Qboot release firmware fail. write firmware to %s fail.", dst_part_name);
@@ -778,26 +1752,52 @@ done:
     }
     
     return(true);
+
+fail:
+    qbt_prog_end(false);
+    qbt_burst_discard();
+    #ifdef QBOOT_USING_FUSED_RELEASE
+    fused_ctx.enable = false;
+    #endif
+    #ifdef QBOOT_USING_PIPELINE
+    qbt_pipeline_close();
+    #endif
+    #ifdef QBOOT_USING_FLASH_WRITER
+    qbt_flash_write_end(false);
+    #endif
+    #ifdef QBOOT_USING_RESUME
+    qbt_resume_clear();//package or destination is broken, release from the start next time
+    #endif
+    qbt_fw_decompress_deinit(cmprs_type);
+    qbt_dest_part_invalidate(dst_part);
+    return(false);
 }
 
 static bool qbt_dest_part_verify(const char *part_name)
 {
-    if ( ! qbt_fw_info_read(part_name, &fw_info, true))
+    fw_info_t dst_info;//the package information is still used by the caller
+    bool rst;
+
+    qbt_arena_reset();
+    if ( ! qbt_fw_info_read(part_name, &dst_info, true))
     {
         LOG_E("Qboot verify fail, read firmware from %s partition", part_name);
         return(false);
     }
     
-    if ( ! qbt_fw_info_check(&fw_info))
+    if ( ! qbt_fw_info_check(&dst_info))
     {
         LOG_E("Qboot verify fail. firmware infomation check fail.");
         return(false);
     }
 
-    switch (fw_info.algo2 & QBOOT_ALGO2_VERIFY_MASK)
+    switch (dst_info.algo2 & QBOOT_ALGO2_VERIFY_MASK)
     {
     case QBOOT_ALGO2_VERIFY_CRC :
-        if ( ! qbt_fw_crc_check(part_name, 0, fw_info.raw_size, fw_info.raw_crc))
+        qbt_stats_phase_begin(QBOOT_STATS_VERIFY);
+        rst = qbt_fw_crc_check(part_name, 0, dst_info.raw_size, dst_info.raw_crc);
+        qbt_stats_phase_end(QBOOT_STATS_VERIFY);
+        if ( ! rst)
         {
             return(false);
         }
@@ -810,48 +1810,352 @@ static bool qbt_dest_part_verify(const char *part_name)
     return(true);
 }
 
-static bool qbt_fw_check(const char *fw_part_name, fw_info_t *fw_info, bool output_log)
+static bool qbt_fw_hdr_check(const char *fw_part_name, fw_info_t *fw_info, bool output_log)
+{
+    if ( ! qbt_part_is_exist(fw_part_name))
+    {
+        if (output_log) LOG_E("Qboot firmware check fail. partition \"%s\" is not exist.", fw_part_name);
+        return(false);
+    }
+
+    if ( ! qbt_fw_info_read(fw_part_name, fw_info, false))
+    {
+        if (output_log) LOG_E("Qboot firmware check fail. partition \"%s\" read fail.", fw_part_name);
+        return(false);
+    }
+
+    if ( ! qbt_fw_info_check(fw_info))
+    {
+        if (output_log) LOG_E("Qboot firmware check fail. partition \"%s\" infomation check fail.", fw_part_name);
+        return(false);
+    }
+
+    return(true);
+}
+
+static bool qbt_fw_algo_is_supported(fw_info_t *fw_info)
+{
+    switch (fw_info->algo & QBOOT_ALGO_CRYPT_MASK)
+    {
+    case QBOOT_ALGO_CRYPT_NONE:
+    #ifdef QBOOT_USING_AES
+    case QBOOT_ALGO_CRYPT_AES:
+    case QBOOT_ALGO_CRYPT_AES_CTR:
+    #endif
+        break;
+    default:
+        return(false);
+    }
+
+    switch (fw_info->algo & QBOOT_ALGO_CMPRS_MASK)
+    {
+    case QBOOT_ALGO_CMPRS_NONE:
+    #ifdef QBOOT_USING_GZIP
+    case QBOOT_ALGO_CMPRS_GZIP:
+    #endif
+    #ifdef QBOOT_USING_QUICKLZ
+    case QBOOT_ALGO_CMPRS_QUICKLZ:
+    #endif
+    #ifdef QBOOT_USING_FASTLZ
+    case QBOOT_ALGO_CMPRS_FASTLZ:
+    #endif
+    #ifdef QBOOT_USING_LZ4
+    case QBOOT_ALGO_CMPRS_LZ4:
+    #endif
+    #ifdef QBOOT_USING_HPATCHLITE
+    case QBOOT_ALGO_CMPRS_HPATCHLITE:
+    #endif
+        break;
+    default:
+        return(false);
+    }
+
+    #ifndef QBOOT_USING_BLOCK_INDEX
+    if (fw_info->algo2 & QBOOT_ALGO2_BLOCK_INDEX)
+    {
+        return(false);
+    }
+    #endif
+    #ifndef QBOOT_USING_MANIFEST
+    if (fw_info->algo2 & QBOOT_ALGO2_MANIFEST)
+    {
+        return(false);
+    }
+    #endif
+
+    return(true);
+}
+
+static bool qbt_fw_target_check(const char *fw_part_name, fw_info_t *fw_info, bool output_log)//algorithms and destination of image
+{
+    const char *dst_part_name = (char *)fw_info->part_name;
+    const struct fal_partition *dst_part;
+
+    if ( ! qbt_fw_algo_is_supported(fw_info))
+    {
+        if (output_log) LOG_E("Qboot firmware check fail. partition \"%s\" nonsupport algorithm %04X.", fw_part_name, fw_info->algo);
+        return(false);
+    }
+
+    #ifdef QBOOT_USING_AB_SLOT
+    dst_part_name = qbt_slot_release_target(dst_part_name);
+    #endif
+    dst_part = fal_partition_find(dst_part_name);
+    if (dst_part == NULL)
+    {
+        if (output_log) LOG_E("Qboot firmware check fail. partition \"%s\" destination %s is not exist.", fw_part_name, dst_part_name);
+        return(false);
+    }
+    if (fw_info->raw_size + sizeof(fw_info_t) > dst_part->len)//firmware information is kept at the tail
+    {
+        if (output_log) LOG_E("Qboot firmware check fail. partition \"%s\" code size %d is larger than %s.", fw_part_name, fw_info->raw_size, dst_part_name);
+        return(false);
+    }
+
+    return(true);
+}
+
+#ifdef QBOOT_USING_MANIFEST
+static bool qbt_mnf_pkg_open(qbt_mnf_t *mnf, const char *fw_part_name, fw_info_t *fw_info)
+{
+    if ((fw_info->algo != (QBOOT_ALGO_CRYPT_NONE | QBOOT_ALGO_CMPRS_NONE)) || (fw_info->algo2 & QBOOT_ALGO2_BLOCK_INDEX))
+    {
+        LOG_E("Qboot manifest nonsupport algorithm %04X, only the images are encrypted or compressed.", fw_info->algo);
+        return(false);
+    }
+    return(qbt_mnf_open(mnf, (fal_partition_t)fal_partition_find(fw_part_name), sizeof(fw_info_t), fw_info->pkg_size));
+}
+
+static bool qbt_mnf_img_load(const qbt_mnf_t *mnf, u32 img_no, fw_info_t *img_info, u32 *p_img_base)//header of image is read and checked
+{
+    qbt_mnf_entry_t entry;
+
+    if ( ! qbt_mnf_entry_read(mnf, img_no, &entry))
+    {
+        return(false);
+    }
+    *p_img_base = mnf->body_pos + entry.img_ofs;
+    if ((entry.img_size < sizeof(fw_info_t)) || (fal_partition_read(mnf->part, *p_img_base, (u8 *)img_info, sizeof(fw_info_t)) < 0)
+        || ( ! qbt_fw_info_check(img_info)))
+    {
+        LOG_E("Qboot manifest image %d infomation check fail.", img_no);
+        return(false);
+    }
+    if ((img_info->algo2 & QBOOT_ALGO2_MANIFEST) || (sizeof(fw_info_t) + img_info->pkg_size != entry.img_size))
+    {
+        LOG_E("Qboot manifest image %d error. size = %d, package size = %d", img_no, entry.img_size, img_info->pkg_size);
+        return(false);
+    }
+    return(true);
+}
+
+static bool qbt_mnf_img_is_app(fw_info_t *img_info)
+{
+    #ifdef QBOOT_USING_AB_SLOT
+    return(qbt_slot_of_part((char *)img_info->part_name) >= 0);
+    #else
+    return(strcmp((char *)img_info->part_name, QBOOT_APP_PART_NAME) == 0);
+    #endif
+}
+
+static bool qbt_mnf_target_check(const char *fw_part_name, fw_info_t *fw_info, bool output_log)//headers of all images, no image body is read
+{
+    qbt_mnf_t mnf;
+    fw_info_t img_info;
+    u32 img_base;
+
+    if ( ! qbt_mnf_pkg_open(&mnf, fw_part_name, fw_info))
+    {
+        if (output_log) LOG_E("Qboot firmware check fail. partition \"%s\" manifest error.", fw_part_name);
+        return(false);
+    }
+    for (u32 i = 0; i < mnf.img_num; i++)
+    {
+        if (( ! qbt_mnf_img_load(&mnf, i, &img_info, &img_base)) || ( ! qbt_fw_target_check(fw_part_name, &img_info, output_log)))
+        {
+            return(false);
+        }
+    }
+
+    return(true);
+}
+#endif
+
+static bool qbt_fw_compat_check(const char *fw_part_name, fw_info_t *fw_info, bool output_log)//only the headers are used
+{
+    #ifdef QBOOT_USING_PRODUCT_CODE
+    if (strcmp((char *)fw_info->prod_code, QBOOT_PRODUCT_CODE) != 0)
+    {
+        if (output_log) LOG_E("Qboot firmware check fail. partition \"%s\" product code error.", fw_part_name);
+        return(false);
+    }
+    #endif
+
+    #ifdef QBOOT_USING_MANIFEST
+    if (fw_info->algo2 & QBOOT_ALGO2_MANIFEST)
+    {
+        return(qbt_mnf_target_check(fw_part_name, fw_info, output_log));
+    }
+    #endif
+
+    return(qbt_fw_target_check(fw_part_name, fw_info, output_log));
+}
+
+static bool qbt_fw_body_check(const char *fw_part_name, fw_info_t *fw_info, bool output_log)
+{
+    bool rst;
+
+    qbt_arena_reset();
+    qbt_stats_phase_begin(QBOOT_STATS_FW_CHECK);
+    rst = qbt_fw_crc_check(fw_part_name, pkg_base + sizeof(fw_info_t), fw_info->pkg_size, fw_info->pkg_crc);
+    qbt_stats_phase_end(QBOOT_STATS_FW_CHECK);
+    if ( ! rst)
+    {
+        if (output_log) LOG_E("Qboot firmware check fail. partition \"%s\" body check fail.", fw_part_name);
+        return(false);
+    }
+
+    return(true);
+}
+
+static bool qbt_fw_code_check(const char *fw_part_name, fw_info_t *fw_info, bool output_log)//code of image
+{
+    #ifdef QBOOT_USING_APP_CHECK
+    bool rst;
+
+    if ((fw_info->algo2 & QBOOT_ALGO2_VERIFY_MASK) == QBOOT_ALGO2_VERIFY_CRC)
+    {
+        qbt_arena_reset();
+        qbt_stats_phase_begin(QBOOT_STATS_APP_CHECK);
+        rst = qbt_app_crc_check(fw_part_name, fw_info);
+        qbt_stats_phase_end(QBOOT_STATS_APP_CHECK);
+        if ( ! rst)
+        {
+            if (output_log) LOG_E("Qboot firmware check fail. partition \"%s\" app check fail.", fw_part_name);
+            return(false);
+        }
+        qbt_stats_decode_add((fw_info->algo & QBOOT_ALGO_CMPRS_MASK) >> 8, fw_info->raw_size, QBOOT_STATS_APP_CHECK);
+    }
+    #endif
+
+    return(true);
+}
+
+static bool qbt_fw_app_check(const char *fw_part_name, fw_info_t *fw_info, bool output_log)
+{
+    #ifdef QBOOT_USING_MANIFEST
+    qbt_mnf_t mnf;
+    fw_info_t img_info;
+    bool rst;
+
+    if (fw_info->algo2 & QBOOT_ALGO2_MANIFEST)
+    {
+        if ( ! qbt_mnf_pkg_open(&mnf, fw_part_name, fw_info))
+        {
+            return(false);
+        }
+        for (u32 i = 0; i < mnf.img_num; i++)
+        {
+            if ( ! qbt_mnf_img_load(&mnf, i, &img_info, &pkg_base))
+            {
+                pkg_base = 0;
+                return(false);
+            }
+            rst = qbt_fw_code_check(fw_part_name, &img_info, output_log);
+            pkg_base = 0;
+            if ( ! rst)
+            {
+                return(false);
+            }
+        }
+        return(true);
+    }
+    #endif
+
+    return(qbt_fw_code_check(fw_part_name, fw_info, output_log));
+}
+
+static bool qbt_fw_check(const char *fw_part_name, fw_info_t *fw_info, int level, bool output_log)//the cheap checks go first, up to level
+{
+    if ( ! qbt_fw_hdr_check(fw_part_name, fw_info, output_log))
+    {
+        return(false);
+    }
+    if ((level >= QBOOT_CHECK_COMPAT) && ( ! qbt_fw_compat_check(fw_part_name, fw_info, output_log)))
+    {
+        return(false);
+    }
+    if ((level >= QBOOT_CHECK_BODY) && ( ! qbt_fw_body_check(fw_part_name, fw_info, output_log)))
+    {
+        return(false);
+    }
+    if ((level >= QBOOT_CHECK_APP) && ( ! qbt_fw_app_check(fw_part_name, fw_info, output_log)))
+    {
+        return(false);
+    }
+
+    if (output_log) LOG_D("Qboot partition \"%s\" firmware check success.", fw_part_name);
+    
+    return(true);
+}
+
+static bool qbt_fw_release_check(const char *fw_part_name, fw_info_t *fw_info)
 {
-    if ( ! qbt_part_is_exist(fw_part_name))
+    if ( ! qbt_fw_check(fw_part_name, fw_info, QBOOT_CHECK_COMPAT, true))//rejected before any pass of body
     {
-        if (output_log) LOG_E("Qboot firmware check fail. partition \"%s\" is not exist.", fw_part_name);
         return(false);
     }
-
-    if ( ! qbt_fw_info_read(fw_part_name, fw_info, false))
+    #ifdef QBOOT_USING_FUSED_RELEASE
+    if (qbt_fused_is_used(fw_part_name, fw_info))//body and app will be verified while releasing
     {
-        if (output_log) LOG_E("Qboot firmware check fail. partition \"%s\" read fail.", fw_part_name);
-        return(false);
+        return(true);
     }
-
-    if ( ! qbt_fw_info_check(fw_info))
+    #endif
+    #ifdef QBOOT_USING_RESUME
+    if (qbt_resume_is_pending(fw_info))//checked before the interrupted release, released code is verified after release
     {
-        if (output_log) LOG_E("Qboot firmware check fail. partition \"%s\" infomation check fail.", fw_part_name);
-        return(false);
+        LOG_I("Qboot partition \"%s\" firmware release is interrupted, continue it.", fw_part_name);
+        return(true);
     }
-
-    if ( ! qbt_fw_crc_check(fw_part_name, sizeof(fw_info_t), fw_info->pkg_size, fw_info->pkg_crc))
+    #endif
+    #ifdef QBOOT_USING_CHECK_CACHE
+    if (qbt_check_cache_hit(fw_part_name, fw_info))//released code is still verified after release
     {
-        if (output_log) LOG_E("Qboot firmware check fail. partition \"%s\" body check fail.", fw_part_name);
-        return(false);
+        LOG_D("Qboot partition \"%s\" firmware is checked before, skip body and app check.", fw_part_name);
+        return(true);
     }
-    
-    #ifdef QBOOT_USING_APP_CHECK
-    if ((fw_info->algo2 & QBOOT_ALGO2_VERIFY_MASK) == QBOOT_ALGO2_VERIFY_CRC)
+    #endif
+
+    if ( ! (qbt_fw_body_check(fw_part_name, fw_info, true) && qbt_fw_app_check(fw_part_name, fw_info, true)))
     {
-        if ( ! qbt_app_crc_check(fw_part_name, fw_info))
-        {
-            if (output_log) LOG_E("Qboot firmware check fail. partition \"%s\" app check fail.", fw_part_name);
-            return(false);
-        }
+        return(false);
     }
+    #ifdef QBOOT_USING_CHECK_CACHE
+    qbt_check_cache_set(fw_part_name, fw_info);
     #endif
 
-    if (output_log) LOG_D("Qboot partition \"%s\" firmware check success.", fw_part_name);
-    
     return(true);
 }
 
+#ifdef QBOOT_USING_FUSED_RELEASE
+static void qbt_fused_fail_check(const char *src_part_name, fw_info_t *fw_info)//the package was not checked before the failed release
+{
+    fal_partition_t src_part = (fal_partition_t)fal_partition_find(src_part_name);
+
+    if (( ! qbt_fused_is_used(src_part_name, fw_info)) || (pkg_base != 0))
+    {
+        return;
+    }
+    if (qbt_fw_body_check(src_part_name, fw_info, true) && qbt_fw_app_check(src_part_name, fw_info, true))//the destination failed, release again
+    {
+        return;
+    }
+    //the header is erased, the package is not released again by the fallback of this boot or the next boots
+    LOG_E("Qboot partition \"%s\" firmware is broken, it is invalidated.", src_part_name);
+    qbt_dest_part_invalidate(src_part);
+}
+#endif
+
 static bool qbt_fw_update(const char *dst_part_name, const char *src_part_name, fw_info_t *fw_info)
 {
     bool rst;
@@ -866,7 +2170,9 @@ static bool qbt_fw_update(const char *dst_part_name, const char *src_part_name,
     qled_set_blink(QBOOT_STATUS_LED_PIN, 50, 50);
     #endif
     
+    qbt_stats_phase_begin(QBOOT_STATS_RELEASE);
     rst = qbt_fw_release(dst_part_name, src_part_name, fw_info);
+    qbt_stats_phase_end(QBOOT_STATS_RELEASE);
 
     #ifdef QBOOT_USING_STATUS_LED
     qled_set_blink(QBOOT_STATUS_LED_PIN, 50, 450);
@@ -875,12 +2181,30 @@ static bool qbt_fw_update(const char *dst_part_name, const char *src_part_name,
     if ( ! rst)
     {
         LOG_E("Qboot firmware update fail. firmware release fail.");
+        #ifdef QBOOT_USING_CHECK_CACHE
+        qbt_check_cache_set(src_part_name, NULL);//the package is checked again next time
+        #endif
+        #ifdef QBOOT_USING_FUSED_RELEASE
+        qbt_fused_fail_check(src_part_name, fw_info);
+        #endif
         return(false);
     }
+    qbt_stats_decode_add((fw_info->algo & QBOOT_ALGO_CMPRS_MASK) >> 8, fw_info->raw_size, QBOOT_STATS_RELEASE);
+
+    #ifdef QBOOT_USING_FUSED_RELEASE
+    if (qbt_fused_is_used(src_part_name, fw_info))//released code has been verified while releasing
+    {
+        LOG_I("Qboot firmware update success.");
+        return(true);
+    }
+    #endif
 
     if ( ! qbt_dest_part_verify(dst_part_name))
     {
         LOG_E("Qboot firmware update fail. destination partition verify fail.");
+        #ifdef QBOOT_USING_CHECK_CACHE
+        qbt_check_cache_set(src_part_name, NULL);
+        #endif
         return(false);
     }
 
@@ -892,7 +2216,7 @@ static bool qbt_fw_update(const char *dst_part_name, const char *src_part_name,
 __WEAK void qbt_jump_to_app(void)
 {
     typedef void (*app_func_t)(void);
-    u32 app_addr = QBOOT_APP_ADDR;
+    u32 app_addr = qbt_app_addr_get();
     u32 stk_addr = *((__IO uint32_t *)app_addr);
     app_func_t app_func = (app_func_t)(*((__IO uint32_t *)(app_addr + 4)));
 
@@ -903,7 +2227,10 @@ __WEAK void qbt_jump_to_app(void)
     }
 
     rt_kprintf("Jump to application running ... \n");
-    rt_thread_mdelay(200);
+    if (rt_thread_self() != RT_NULL)//not in early jump before the scheduler starts
+    {
+        rt_thread_mdelay(200);
+    }
     
     __disable_irq();
     HAL_DeInit();
@@ -930,10 +2257,39 @@ __WEAK void qbt_jump_to_app(void)
 extern void qbt_jump_to_app(void);
 #endif
 
+u32 qbt_app_addr_get(void)
+{
+    #ifdef QBOOT_USING_AB_SLOT
+    return(qbt_slot_boot_addr());
+    #else
+    return(QBOOT_APP_ADDR);
+    #endif
+}
+
+static void qbt_app_jump(void)
+{
+    #ifdef QBOOT_USING_AB_SLOT
+    if (qbt_slot_select(qbt_dest_part_verify) < 0)//no slot is mapped to be jumped to
+    {
+        return;
+    }
+    qbt_stats_seal();
+    qbt_jump_to_app();
+    if ( ! qbt_slot_fallback(qbt_dest_part_verify))//the other slot is not available
+    {
+        return;
+    }
+    #endif
+    
+    qbt_stats_seal();
+    qbt_jump_to_app();
+}
+
 #ifdef QBOOT_USING_STATUS_LED
 static void qbt_status_led_init(void)
 {
     qled_add(QBOOT_STATUS_LED_PIN, QBOOT_STATUS_LED_LEVEL);
+    qbt_jump_periph_mark(QBOOT_JUMP_PERIPH_LED);
     qled_set_blink(QBOOT_STATUS_LED_PIN, 50, 450);
 }
 #endif
@@ -948,6 +2304,7 @@ static bool qbt_factory_key_check(void)
     #else
     rt_pin_mode(QBOOT_FACTORY_KEY_PIN, PIN_MODE_INPUT_PULLUP);
     #endif
+    qbt_jump_periph_mark(QBOOT_JUMP_PERIPH_KEY);
 
     rt_thread_mdelay(500);
 
@@ -1094,123 +2451,491 @@ static bool qbt_shell_key_check(void)
             continue;
         }
     }
-    
-    return(false);
+    
+    return(false);
+}
+
+static bool qbt_startup_shell(bool wait_press_key)
+{
+    if ( ! qbt_shell_init(RT_CONSOLE_DEVICE_NAME))
+    {
+        LOG_E("Qboot initialize shell fail.");
+        return(false);
+    }
+    
+    if (wait_press_key)
+    {
+        bool rst;
+        rt_kprintf("Press [Enter] key into shell in %d s : ", QBOOT_SHELL_KEY_CHK_TMO);
+        rst = qbt_shell_key_check();
+        rt_kprintf("\n");
+        if ( ! rst)
+        {
+            return(false);
+        }
+    }
+
+    qbt_open_sys_shell();
+    
+    return(true);
+}
+#endif
+
+static void qbt_show_msg(void)
+{
+    //rt_kprintf("\033[2J\033[0;0H"); //clear screen
+    rt_kprintf("\n");
+    rt_kprintf("Qboot startup ... \n");
+    rt_kprintf("Qboot version   : %s \n", QBOOT_VER_MSG);
+    
+    #ifdef QBOOT_USING_PRODUCT_INFO
+    rt_kprintf("Product name    : %s \n", QBOOT_PRODUCT_NAME);
+    rt_kprintf("Product version : %s \n", QBOOT_PRODUCT_VER);
+    rt_kprintf("Product mcu     : %s \n", QBOOT_PRODUCT_MCU);
+    #endif
+}
+
+static bool qbt_app_resume_from(const char *src_part_name)
+{
+    const char *dst_part_name = QBOOT_APP_PART_NAME;
+    
+    if ( ! qbt_fw_check(src_part_name, &fw_info, QBOOT_CHECK_COMPAT, true))
+    {
+        LOG_E("Qboot resume fail from %s.", src_part_name);
+        return(false);
+    }
+    
+    #ifdef QBOOT_USING_AB_SLOT
+    if (qbt_slot_of_part((char *)fw_info.part_name) < 0)
+    {
+        LOG_E("Qboot resume fail from %s.", src_part_name);
+        LOG_E("The firmware of %s partition is not application. fw_info.part_name(%s) != %s or %s", src_part_name, fw_info.part_name, QBOOT_APP_PART_NAME, QBOOT_APP_B_PART_NAME);
+        return(false);
+    }
+    
+    dst_part_name = qbt_slot_release_target((char *)fw_info.part_name);
+    #else
+    if (strcmp((char *)fw_info.part_name, QBOOT_APP_PART_NAME) != 0)
+    {
+        LOG_E("Qboot resume fail from %s.", src_part_name);
+        LOG_E("The firmware of %s partition is not application. fw_info.part_name(%s) != %s", src_part_name, fw_info.part_name, QBOOT_APP_PART_NAME);
+        return(false);
+    }
+    #endif
+
+    if ( ! qbt_fw_release_check(src_part_name, &fw_info))//target is checked before the passes of body
+    {
+        return(false);
+    }
+    
+    if ( ! qbt_fw_update(dst_part_name, src_part_name, &fw_info))
+    {   
+        return(false);
+    }
+    
+    #ifdef QBOOT_USING_AB_SLOT
+    qbt_slot_installed(qbt_slot_of_part(dst_part_name));
+    #endif
+    
+    LOG_I("Qboot resume success from %s.", src_part_name);
+    return(true);
+}
+
+#ifdef QBOOT_USING_MANIFEST
+static bool qbt_mnf_release(const char *part_name, fw_info_t *fw_info)
+{
+    qbt_mnf_t mnf;
+    fw_info_t img_info;
+    u32 img_base;
+    bool rst;
+
+    if ( ! qbt_mnf_pkg_open(&mnf, part_name, fw_info))
+    {
+        return(false);
+    }
+    for (int pass = 0; pass < 2; pass++)//the application goes last, it is replaced only after the other images are released
+    {
+        for (u32 i = 0; i < mnf.img_num; i++)
+        {
+            const char *dst_part_name;
+            if ( ! qbt_mnf_img_load(&mnf, i, &img_info, &img_base))
+            {
+                return(false);
+            }
+            if (qbt_mnf_img_is_app(&img_info) != (pass == 1))
+            {
+                continue;
+            }
+            dst_part_name = (char *)img_info.part_name;
+            #ifdef QBOOT_USING_AB_SLOT
+            dst_part_name = qbt_slot_release_target(dst_part_name);
+            #endif
+
+            pkg_base = img_base;
+            rst = qbt_fw_update(dst_part_name, part_name, &img_info);
+            pkg_base = 0;
+            if ( ! rst)
+            {
+                LOG_E("Qboot manifest release fail. image %d to %s.", i, dst_part_name);
+                return(false);
+            }
+
+            #ifdef QBOOT_USING_AB_SLOT
+            if (qbt_slot_of_part(dst_part_name) >= 0)
+            {
+                qbt_slot_installed(qbt_slot_of_part(dst_part_name));
+            }
+            #endif
+            LOG_I("Release manifest image %d success to %s.", i, dst_part_name);
+        }
+    }
+
+    return(true);
+}
+#endif
+
+static bool qbt_release_from_part(const char *part_name, bool check_sign)
+{
+    const char *dst_part_name;
+    
+    #ifdef QBOOT_USING_FAST_BOOT
+    if (check_sign && qbt_fw_released_check(part_name, &fw_info))//released already, skip body and app check
+    {
+        LOG_D("Qboot partition \"%s\" firmware is released, fast boot.", part_name);
+        return(true);
+    }
+    #endif
+
+    if ( ! qbt_fw_release_check(part_name, &fw_info))//product code and destination are checked first
+    {
+        return(false);
+    }
+    
+    if (check_sign)
+    {
+        if (qbt_release_sign_check(part_name, &fw_info))//not need release
+        {
+            return(true);
+        }
+    }
+
+    #ifdef QBOOT_USING_MANIFEST
+    if (fw_info.algo2 & QBOOT_ALGO2_MANIFEST)
+    {
+        if ( ! qbt_mnf_release(part_name, &fw_info))//no release sign, all images are released again next time
+        {
+            return(false);
+        }
+        if ( ! qbt_release_sign_check(part_name, &fw_info))
+        {
+            qbt_release_sign_write(part_name, &fw_info);
+        }
+        LOG_I("Release manifest success from %s.", part_name);
+        return(true);
+    }
+    #endif
+    
+    dst_part_name = (char *)fw_info.part_name;
+    #ifdef QBOOT_USING_AB_SLOT
+    dst_part_name = qbt_slot_release_target(dst_part_name);
+    #endif
+    
+    if ( ! qbt_fw_update(dst_part_name, part_name, &fw_info))
+    {
+        return(false);
+    }
+
+    #ifdef QBOOT_USING_AB_SLOT
+    if (qbt_slot_of_part(dst_part_name) >= 0)
+    {
+        qbt_slot_installed(qbt_slot_of_part(dst_part_name));
+    }
+    #endif
+
+    if ( ! qbt_release_sign_check(part_name, &fw_info))
+    {
+        qbt_release_sign_write(part_name, &fw_info);
+    }
+    
+    LOG_I("Release firmware success from %s to %s.", part_name, dst_part_name);
+    return(true);
+}
+
+#ifdef QBOOT_USING_STREAM
+static bool qbt_stream_open(void)//header is received
+{
+    fw_info_t *info = &stream_ctx.fw_info;
+    const char *dst_part_name = (char *)info->part_name;
+    fal_partition_t dst_part;
+
+    if (( ! qbt_fw_info_check(info)) || (info->algo2 & QBOOT_ALGO2_MANIFEST) || ( ! qbt_fw_compat_check("stream", info, true)))
+    {
+        LOG_E("Qboot stream release fail. firmware infomation check fail.");
+        return(false);
+    }
+
+    stream_ctx.crypt_type = (info->algo & QBOOT_ALGO_CRYPT_MASK);
+    stream_ctx.cmprs_type = (info->algo & QBOOT_ALGO_CMPRS_MASK);
+    if ((stream_ctx.cmprs_type == QBOOT_ALGO_CMPRS_HPATCHLITE) || (info->algo2 & QBOOT_ALGO2_BLOCK_INDEX))
+    {
+        LOG_E("Qboot stream release fail. differential and block index package need the whole package.");
+        return(false);
+    }
+
+    #ifdef QBOOT_USING_AB_SLOT
+    dst_part_name = qbt_slot_release_target(dst_part_name);
+    #endif
+    dst_part = (fal_partition_t)fal_partition_find(dst_part_name);//exist and large enough, checked with the header
+
+    qbt_arena_reset();
+    if ( ! qbt_fw_decrypt_init(stream_ctx.crypt_type))
+    {
+        LOG_E("Qboot stream release fail. nonsupport encrypt type.");
+        return(false);
+    }
+    if ( ! qbt_fw_decompress_init(stream_ctx.cmprs_type))
+    {
+        LOG_E("Qboot stream release fail. nonsupport compress type.");
+        return(false);
+    }
+
+    #ifdef QBOOT_USING_FLASH_WRITER
+    if ((fal_partition_erase(dst_part, dst_part->len - sizeof(fw_info_t), sizeof(fw_info_t)) < 0)
+        || ( ! qbt_flash_write_begin(dst_part)))
+    #else
+    rt_kprintf("Start erase partition %s ...\n", dst_part_name);
+    if ((qbt_dest_code_erase(dst_part, 0, info->raw_size) < 0) 
+        || (fal_partition_erase(dst_part, dst_part->len - sizeof(fw_info_t), sizeof(fw_info_t)) < 0))
+    #endif
+    {
+        qbt_fw_decompress_deinit(stream_ctx.cmprs_type);
+        LOG_E("Qboot stream release fail. erase %s error.", dst_part_name);
+        return(false);
+    }
+
+    qbt_burst_begin(qbt_dest_burst_out);
+    fused_ctx.enable = true;//package and code are verified while they pass
+    fused_ctx.raw_size = info->raw_size;
+    fused_ctx.pkg_crc = 0xFFFFFFFF;
+    fused_ctx.raw_crc = 0xFFFFFFFF;
+    stream_ctx.dst_part = dst_part;
+    LOG_I("Qboot stream release firmware to %s, package size = %d.", dst_part_name, info->pkg_size);
+    qbt_prog_begin(QBOOT_PROG_RELEASE, dst_part_name, info->raw_size);
+    return(true);
 }
 
-static bool qbt_startup_shell(bool wait_press_key)
+static bool qbt_stream_decode(void)//staged datas are decoded into destination
 {
-    if ( ! qbt_shell_init(RT_CONSOLE_DEVICE_NAME))
+    int write_len;
+
+    #ifdef QBOOT_USING_AES
+    if (stream_ctx.crypt_type != QBOOT_ALGO_CRYPT_NONE)
     {
-        LOG_E("Qboot initialize shell fail.");
+        qbt_aes_decrypt(cmprs_buf + stream_ctx.cmprs_len, crypt_buf, stream_ctx.stage_len);
+    }
+    #endif
+    stream_ctx.cmprs_len += stream_ctx.stage_len;
+
+    write_len = qbt_dest_part_write(stream_ctx.dst_part, stream_ctx.dst_pos, crypt_buf, cmprs_buf, &stream_ctx.cmprs_len, stream_ctx.cmprs_type);
+    if (write_len < 0)
+    {
+        LOG_E("Qboot stream release fail. write destination error, part = %s, addr = %08X", stream_ctx.dst_part->name, stream_ctx.dst_pos);
         return(false);
     }
-    
-    if (wait_press_key)
+    if ((stream_ctx.stage_len == 0) && (write_len == 0))
     {
-        bool rst;
-        rt_kprintf("Press [Enter] key into shell in %d s : ", QBOOT_SHELL_KEY_CHK_TMO);
-        rst = qbt_shell_key_check();
-        rt_kprintf("\n");
-        if ( ! rst)
-        {
-            return(false);
-        }
+        LOG_E("Qboot stream release fail. package datas is incomplete, addr = %08X", stream_ctx.dst_pos);
+        return(false);
     }
-
-    qbt_open_sys_shell();
-    
+    stream_ctx.stage_len = 0;
+    stream_ctx.dst_pos += write_len;
+    qbt_prog_update(stream_ctx.dst_pos);
     return(true);
 }
-#endif
 
-static void qbt_show_msg(void)
+static bool qbt_stream_close(bool is_ok)//firmware information is written to the tail of destination if is_ok
 {
-    //rt_kprintf("\033[2J\033[0;0H"); //clear screen
-    rt_kprintf("\n");
-    rt_kprintf("Qboot startup ... \n");
-    rt_kprintf("Qboot version   : %s \n", QBOOT_VER_MSG);
-    
-    #ifdef QBOOT_USING_PRODUCT_INFO
-    rt_kprintf("Product name    : %s \n", QBOOT_PRODUCT_NAME);
-    rt_kprintf("Product version : %s \n", QBOOT_PRODUCT_VER);
-    rt_kprintf("Product mcu     : %s \n", QBOOT_PRODUCT_MCU);
-    #endif
+    if (stream_ctx.dst_part != NULL)
+    {
+        fused_ctx.enable = false;
+        if ( ! (is_ok && qbt_burst_flush()))
+        {
+            qbt_burst_discard();
+            is_ok = false;
+        }
+        #ifdef QBOOT_USING_FLASH_WRITER
+        if ( ! qbt_flash_write_end(is_ok))
+        {
+            is_ok = false;
+        }
+        #endif
+        qbt_fw_decompress_deinit(stream_ctx.cmprs_type);
+        if (is_ok && ( ! qbt_fw_info_write(stream_ctx.dst_part->name, &stream_ctx.fw_info, true)))
+        {
+            LOG_E("Qboot stream release fail. write firmware to %s fail.", stream_ctx.dst_part->name);
+            is_ok = false;
+        }
+        if ( ! is_ok)
+        {
+            qbt_dest_part_invalidate(stream_ctx.dst_part);
+        }
+        qbt_prog_end(is_ok);
+    }
+    stream_ctx.active = false;
+    return(is_ok);
 }
 
-static bool qbt_app_resume_from(const char *src_part_name)
+bool qbt_stream_begin(void)
 {
-    if ( ! qbt_fw_check(src_part_name, &fw_info, true))
+    if (stream_ctx.active)
     {
-        return(false);
+        LOG_W("Qboot stream release is restarted, the last one is aborted.");
+        qbt_stream_close(false);
     }
+    memset(&stream_ctx, 0, sizeof(stream_ctx));
+    stream_ctx.active = true;
+    return(true);
+}
 
-    #ifdef QBOOT_USING_PRODUCT_CODE
-    if ( strcmp((char *)fw_info.prod_code, QBOOT_PRODUCT_CODE) != 0)
+bool qbt_stream_feed(const u8 *buf, u32 len)
+{
+    if ( ! stream_ctx.active)
     {
-        LOG_E("Qboot resume fail from %s.", src_part_name);
-        LOG_E("The product code error. ");
         return(false);
     }
-    #endif
-    
-    if (strcmp((char *)fw_info.part_name, QBOOT_APP_PART_NAME) != 0)
+
+    while (len > 0)
     {
-        LOG_E("Qboot resume fail from %s.", src_part_name);
-        LOG_E("The firmware of %s partition is not application. fw_info.part_name(%s) != %s", src_part_name, fw_info.part_name, QBOOT_APP_PART_NAME);
-        return(false);
-    }
-    
-    if ( ! qbt_fw_update(QBOOT_APP_PART_NAME, src_part_name, &fw_info))
-    {   
-        return(false);
+        u32 n;
+        if (stream_ctx.hdr_len < sizeof(fw_info_t))
+        {
+            n = sizeof(fw_info_t) - stream_ctx.hdr_len;
+            if (n > len)
+            {
+                n = len;
+            }
+            memcpy((u8 *)&stream_ctx.fw_info + stream_ctx.hdr_len, buf, n);
+            stream_ctx.hdr_len += n;
+            if ((stream_ctx.hdr_len == sizeof(fw_info_t)) && ( ! qbt_stream_open()))
+            {
+                goto fail;
+            }
+        }
+        else
+        {
+            if (stream_ctx.pkg_pos >= stream_ctx.fw_info.pkg_size)
+            {
+                LOG_E("Qboot stream release fail. datas are more than package size %d.", stream_ctx.fw_info.pkg_size);
+                goto fail;
+            }
+            n = QBOOT_CMPRS_READ_SIZE - stream_ctx.stage_len;//decoded by the same chunks as the package in partition
+            if (n > len)
+            {
+                n = len;
+            }
+            if (n > stream_ctx.fw_info.pkg_size - stream_ctx.pkg_pos)
+            {
+                n = stream_ctx.fw_info.pkg_size - stream_ctx.pkg_pos;
+            }
+            fused_ctx.pkg_crc = qbt_crc32_cyc_cal(fused_ctx.pkg_crc, buf, n);
+            stream_ctx.pkg_pos += n;
+            if (stream_ctx.dst_pos < stream_ctx.fw_info.raw_size)//the tail of package is not needed by decompressor
+            {
+                u8 *stage_buf = (stream_ctx.crypt_type == QBOOT_ALGO_CRYPT_NONE) ? (cmprs_buf + stream_ctx.cmprs_len) : crypt_buf;
+                if (stream_ctx.cmprs_len + QBOOT_CMPRS_READ_SIZE > QBOOT_CMPRS_BUF_SIZE)//blocks are not decoded, a chunk is not staged beyond cmprs_buf
+                {
+                    LOG_E("Qboot stream release fail. decompress error, addr = %08X", stream_ctx.dst_pos);
+                    goto fail;
+                }
+                memcpy(stage_buf + stream_ctx.stage_len, buf, n);
+                stream_ctx.stage_len += n;
+                if ((stream_ctx.stage_len == QBOOT_CMPRS_READ_SIZE) && ( ! qbt_stream_decode()))
+                {
+                    goto fail;
+                }
+            }
+        }
+        buf += n;
+        len -= n;
     }
-    
-    LOG_I("Qboot resume success from %s.", src_part_name);
     return(true);
+
+fail:
+    qbt_stream_close(false);
+    return(false);
 }
 
-static bool qbt_release_from_part(const char *part_name, bool check_sign)
+bool qbt_stream_end(void)
 {
-    if ( ! qbt_fw_check(part_name, &fw_info, true))
+    fw_info_t *info = &stream_ctx.fw_info;
+
+    if ( ! stream_ctx.active)
     {
         return(false);
     }
-
-    #ifdef QBOOT_USING_PRODUCT_CODE
-    if ( strcmp((char *)fw_info.prod_code, QBOOT_PRODUCT_CODE) != 0)
+    if ((stream_ctx.dst_part == NULL) || (stream_ctx.pkg_pos < info->pkg_size))
     {
-        LOG_E("The product code error.");
-        return(false);
+        LOG_E("Qboot stream release fail. package is incomplete, %d of %d bytes are received.", stream_ctx.pkg_pos, info->pkg_size);
+        goto fail;
     }
-    #endif
-    
-    if (check_sign)
+
+    while (stream_ctx.dst_pos < info->raw_size)
     {
-        if (qbt_release_sign_check(part_name, &fw_info))//not need release
+        if ( ! qbt_stream_decode())
         {
-            return(true);
+            goto fail;
         }
     }
-    
-    if ( ! qbt_fw_update((char *)fw_info.part_name, part_name, &fw_info))
+
+    fused_ctx.pkg_crc ^= 0xFFFFFFFF;
+    if (fused_ctx.pkg_crc != info->pkg_crc)
+    {
+        LOG_E("Qboot verify CRC32 error, cal.crc: %08X != body.crc: %08X", fused_ctx.pkg_crc, info->pkg_crc);
+        goto fail;
+    }
+    fused_ctx.raw_crc ^= 0xFFFFFFFF;
+    if (((info->algo2 & QBOOT_ALGO2_VERIFY_MASK) == QBOOT_ALGO2_VERIFY_CRC) && (fused_ctx.raw_crc != info->raw_crc))
+    {
+        LOG_E("Qboot app crc check fail. cal.crc: %08X != raw.crc: %08X", fused_ctx.raw_crc, info->raw_crc);
+        goto fail;
+    }
+
+    if ( ! qbt_stream_close(true))
     {
         return(false);
     }
 
-    if ( ! qbt_release_sign_check(part_name, &fw_info))
+    #ifdef QBOOT_USING_AB_SLOT
+    if (qbt_slot_of_part(stream_ctx.dst_part->name) >= 0)
     {
-        qbt_release_sign_write(part_name, &fw_info);
+        qbt_slot_installed(qbt_slot_of_part(stream_ctx.dst_part->name));
     }
-    
-    LOG_I("Release firmware success from %s to %s.", part_name, fw_info.part_name);
+    #endif
+
+    LOG_I("Stream release firmware success to %s.", stream_ctx.dst_part->name);
     return(true);
+
+fail:
+    qbt_stream_close(false);
+    return(false);
+}
+
+void qbt_stream_abort(void)
+{
+    if (stream_ctx.active)
+    {
+        LOG_W("Qboot stream release is aborted.");
+        qbt_stream_close(false);
+    }
 }
+#endif
 
 static void qbt_thread_entry(void *params)
 {
     #define QBOOT_REBOOT_DELAY_MS       5000
 
+    qbt_stats_init();
+
     #ifdef QBOOT_USING_SHELL
     rt_thread_mdelay(2);
     qbt_close_sys_shell();
@@ -1243,7 +2968,7 @@ static void qbt_thread_entry(void *params)
     {
         if (qbt_app_resume_from(QBOOT_FACTORY_PART_NAME))
         {
-            qbt_jump_to_app();
+            qbt_app_jump();
         }
     }
     #endif
@@ -1256,18 +2981,18 @@ static void qbt_thread_entry(void *params)
     #endif
 
     qbt_release_from_part(QBOOT_DOWNLOAD_PART_NAME, true);
-    qbt_jump_to_app();
+    qbt_app_jump();
 
     LOG_I("Try resume application from %s", QBOOT_DOWNLOAD_PART_NAME);
     if (qbt_app_resume_from(QBOOT_DOWNLOAD_PART_NAME))
     {
-        qbt_jump_to_app();
+        qbt_app_jump();
     }
 
     LOG_I("Try resume application from %s", QBOOT_FACTORY_PART_NAME);
     if (qbt_app_resume_from(QBOOT_FACTORY_PART_NAME))
     {
-        qbt_jump_to_app();
+        qbt_app_jump();
     }
 
     #ifdef QBOOT_USING_SHELL
@@ -1297,21 +3022,172 @@ static int qbt_startup(void)
 }
 INIT_APP_EXPORT(qbt_startup);
 
+#ifdef QBOOT_USING_EARLY_JUMP
+rt_weak bool qbt_early_jump_check(void)
+{
+    #ifdef QBOOT_USING_SHELL
+    return(false);//the shell key is waited by the full boot, the board overrides this to jump early
+    #else
+    return(true);
+    #endif
+}
+
+static bool qbt_early_update_is_pending(void)
+{
+    if ( ! qbt_fw_check(QBOOT_DOWNLOAD_PART_NAME, &fw_info, QBOOT_CHECK_COMPAT, false))//no firmware package, or it will not be released
+    {
+        return(false);
+    }
+
+    return( ! qbt_release_sign_check(QBOOT_DOWNLOAD_PART_NAME, &fw_info));
+}
+
+static int qbt_early_jump(void)//only the package header and release sign are read, the full boot handles the others
+{
+    qbt_stats_init();
+
+    if ( ! qbt_early_jump_check())
+    {
+        return RT_EOK;
+    }
+
+    #ifdef QBOOT_USING_FACTORY_KEY
+    #if (QBOOT_FACTORY_KEY_LEVEL)
+    rt_pin_mode(QBOOT_FACTORY_KEY_PIN, PIN_MODE_INPUT_PULLDOWN);
+    #else
+    rt_pin_mode(QBOOT_FACTORY_KEY_PIN, PIN_MODE_INPUT_PULLUP);
+    #endif
+    qbt_jump_periph_mark(QBOOT_JUMP_PERIPH_KEY);
+    if (rt_pin_read(QBOOT_FACTORY_KEY_PIN) == QBOOT_FACTORY_KEY_LEVEL)
+    {
+        return RT_EOK;
+    }
+    #endif
+
+    if (fal_init() <= 0)
+    {
+        return RT_EOK;
+    }
+    if (qbt_early_update_is_pending())
+    {
+        return RT_EOK;
+    }
+
+    qbt_app_jump();
+
+    LOG_W("Qboot early jump fail, go on with the full boot.");
+    return RT_EOK;
+}
+QBOOT_EARLY_JUMP_EXPORT(qbt_early_jump);
+#endif
+
 #ifdef QBOOT_USING_SHELL
-static bool qbt_fw_clone(const char *dst_part_name, const char *src_part_name, u32 fw_pkg_size)
+static int qbt_clone_data_write(fal_partition_t part, u32 pos, const u8 *buf, u32 len)
 {
-    u32 pos = 0;
+    #ifdef QBOOT_USING_PIPELINE
+    if (dst_pipe != NULL)
+    {
+        return(qbt_pipe_write(dst_pipe, pos, buf, len));
+    }
+    #endif
+
+    return(fal_partition_write(part, pos, buf, len));
+}
+
+static bool qbt_clone_blank_check(fal_partition_t part, u32 pos, u32 len)//skipped burst is blank in flash, as the package
+{
+    u32 blank[8];
+
+    while (len > 0)
+    {
+        u32 n = (len < sizeof(blank)) ? len : sizeof(blank);
+        if (fal_partition_read(part, pos, (u8 *)blank, n) < 0)
+        {
+            return(false);
+        }
+        for (u32 i = 0; i < n; i++)
+        {
+            if (((u8 *)blank)[i] != 0xFF)
+            {
+                LOG_E("Qboot clone firmware fail. %s partition is not blank, addr = %08X", part->name, pos + i);
+                return(false);
+            }
+        }
+        pos += n;
+        len -= n;
+    }
+
+    return(true);
+}
+
+static bool qbt_clone_blk_write(fal_partition_t part, u32 pos, const u8 *buf, u32 len)//bursts of all 0xFF are erased already, they are read back instead of programmed
+{
+    u32 ofs = 0;
+    u32 run_ofs = 0;
+
+    while (ofs < len)
+    {
+        u32 n = QBOOT_WRITE_BURST_SIZE - ((pos + ofs) % QBOOT_WRITE_BURST_SIZE);//to the next burst boundary of destination
+        u32 i = 0;
+        if (n > len - ofs)
+        {
+            n = len - ofs;
+        }
+        while ((i < n) && (buf[ofs + i] == 0xFF))
+        {
+            i++;
+        }
+        if (i == n)//blank, the datas before it are written together
+        {
+            if ((ofs > run_ofs) && (qbt_clone_data_write(part, pos + run_ofs, buf + run_ofs, ofs - run_ofs) < 0))
+            {
+                return(false);
+            }
+            if ( ! qbt_clone_blank_check(part, pos + ofs, n))
+            {
+                return(false);
+            }
+            run_ofs = ofs + n;
+        }
+        ofs += n;
+    }
+    if ((len > run_ofs) && (qbt_clone_data_write(part, pos + run_ofs, buf + run_ofs, len - run_ofs) < 0))
+    {
+        return(false);
+    }
+
+    return(true);
+}
+
+static bool qbt_fw_clone(const char *dst_part_name, const char *src_part_name, fw_info_t *fw_info)//body is verified while copying, the header is written after it
+{
+    u32 fw_pkg_size = sizeof(fw_info_t) + fw_info->pkg_size;
+    u32 pos = sizeof(fw_info_t);
+    u32 crc32 = 0xFFFFFFFF;
+    bool rst = false;
     fal_partition_t src_part = (fal_partition_t)fal_partition_find(src_part_name);
     fal_partition_t dst_part = (fal_partition_t)fal_partition_find(dst_part_name);
 
+    if (fw_pkg_size > dst_part->len)
+    {
+        LOG_E("Qboot clone firmware fail. %s partition is too small.", dst_part_name);
+        return(false);
+    }
+
+    qbt_arena_reset();
     rt_kprintf("Erasing %s partition ... \n", dst_part_name);
     if (fal_partition_erase(dst_part, 0, fw_pkg_size) < 0)
     {
         LOG_E("Qboot clone firmware fail. erase %s error.", dst_part_name);
         return(false);
     }
+
+    #ifdef QBOOT_USING_PIPELINE
+    src_pipe = qbt_pipe_reader_open(src_part, pos, fw_pkg_size, QBOOT_BUF_SIZE);
+    dst_pipe = qbt_pipe_writer_open(dst_part, QBOOT_BUF_SIZE, fal_partition_write);
+    #endif
     
-    rt_kprintf("Cloning firmware from %s to %s ...    ", src_part_name, dst_part_name);
+    qbt_prog_begin(QBOOT_PROG_CLONE, dst_part_name, fw_pkg_size);
     while (pos < fw_pkg_size)
     {
         int read_len = QBOOT_BUF_SIZE;
@@ -1320,28 +3196,55 @@ static bool qbt_fw_clone(const char *dst_part_name, const char *src_part_name, u
         {
             read_len = remain_len;
         }
-        if (fal_partition_read(src_part, pos, cmprs_buf, read_len) < 0)
+        if (qbt_src_data_read(src_part, pos, cmprs_buf, read_len) < 0)
         {
             LOG_E("Qboot clone firmware fail. read error, part = %s, addr = %08X, length = %d", src_part_name, pos, read_len);
-            return(false);
+            goto exit;
         }
-        if (fal_partition_write(dst_part, pos, cmprs_buf, read_len) < 0)
+        crc32 = qbt_crc32_cyc_cal(crc32, cmprs_buf, read_len);
+        if ( ! qbt_clone_blk_write(dst_part, pos, cmprs_buf, read_len))
         {
             LOG_E("Qboot clone firmware fail. write error, part = %s, addr = %08X, length = %d", dst_part_name, pos, read_len);
-            return(false);
+            goto exit;
         }
         pos += read_len;
-        rt_kprintf("\b\b\b%02d%%", (pos * 100 / fw_pkg_size));
+        qbt_prog_update(pos);
     }
-    rt_kprintf("\n");
+
+    #ifdef QBOOT_USING_PIPELINE
+    if ( ! qbt_pipeline_close())
+    {
+        LOG_E("Qboot clone firmware fail. write error, part = %s", dst_part_name);
+        goto exit;
+    }
+    #endif
+    crc32 ^= 0xFFFFFFFF;
+    if (crc32 != fw_info->pkg_crc)//programming errors are returned by the writes, blank bursts are read back
+    {
+        LOG_E("Qboot clone firmware fail. CRC32 error, cal.crc: %08X != body.crc: %08X", crc32, fw_info->pkg_crc);
+        goto exit;
+    }
+    if (fal_partition_write(dst_part, 0, (u8 *)fw_info, sizeof(fw_info_t)) < 0)//the copy is valid only when the header is written
+    {
+        LOG_E("Qboot clone firmware fail. write header error, part = %s", dst_part_name);
+        goto exit;
+    }
+    rst = true;
+
+exit:
+    #ifdef QBOOT_USING_PIPELINE
+    qbt_pipeline_close();
+    #endif
+    qbt_prog_end(rst);
     
-    return(true);
+    return(rst);
 }
+
 static void qbt_fw_info_show(const char *part_name)
 {
     char str[20];
     
-    if ( ! qbt_fw_check(part_name, &fw_info, false))
+    if ( ! qbt_fw_check(part_name, &fw_info, QBOOT_CHECK_HDR, false))//header only, the body is checked by release
     {
         return;
     }
@@ -1358,6 +3261,9 @@ static void qbt_fw_info_show(const char *part_name)
     case QBOOT_ALGO_CRYPT_AES:
         strcpy(str, "AES");
         break;
+    case QBOOT_ALGO_CRYPT_AES_CTR:
+        strcpy(str, "AES-CTR");
+        break;
     default:
         strcpy(str, "UNKNOW");
         break;
@@ -1379,6 +3285,9 @@ static void qbt_fw_info_show(const char *part_name)
     case QBOOT_ALGO_CMPRS_HPATCHLITE:
         strcpy(str + strlen(str), " && HPATCHLITE");
         break;
+    case QBOOT_ALGO_CMPRS_LZ4:
+        strcpy(str + strlen(str), " && LZ4");
+        break;
     default:
         strcpy(str + strlen(str), " && UNKNOW");
         break;
@@ -1394,6 +3303,8 @@ static void qbt_fw_info_show(const char *part_name)
     rt_kprintf("| Raw code verify       | %20X |\n", fw_info.raw_crc);
     rt_kprintf("| Header crc            | %20X |\n", fw_info.hdr_crc);
     rt_kprintf("| Build timestamp       | %20d |\n", fw_info.time_stamp);
+    rt_kprintf("| Block index           | %20s |\n", (fw_info.algo2 & QBOOT_ALGO2_BLOCK_INDEX) ? "yes" : "no");
+    rt_kprintf("| Manifest              | %20s |\n", (fw_info.algo2 & QBOOT_ALGO2_MANIFEST) ? "yes" : "no");
     rt_kprintf("\n");
 }
 static bool qbt_fw_delete(const char *part_name, u32 part_size)
@@ -1422,6 +3333,15 @@ static void qbt_shell_cmd(rt_uint8_t argc, char **argv)
         "qboot verify part              - verify released code of partition\n",
         "qboot del part                 - delete firmware of partiton\n",
         "qboot jump                     - jump to application\n",
+        #ifdef QBOOT_USING_AB_SLOT
+        "qboot slot [confirm]           - show slot table or confirm pending slot\n",
+        #endif
+        #ifdef QBOOT_USING_STATS
+        "qboot stats                    - show boot time and flash access statistics\n",
+        #endif
+        #ifdef QBOOT_USING_BENCH
+        "qboot bench [scratch_part]     - test throughput of flash and codecs, scratch_part is erased\n",
+        #endif
         "\n"
         };
         
@@ -1472,12 +3392,12 @@ static void qbt_shell_cmd(rt_uint8_t argc, char **argv)
             rt_kprintf("Desttition %s partition is not exist.\n", dst);
             return;
         }
-        if ( ! qbt_fw_check(src, &fw_info, true))
+        if ( ! qbt_fw_check(src, &fw_info, QBOOT_CHECK_HDR, true))//package is copied, not decoded, the body is verified while copying
         {
             rt_kprintf("Soure %s partition firmware error.\n", src);
             return;
         }
-        if (qbt_fw_clone(dst, src, sizeof(fw_info_t) + fw_info.pkg_size))
+        if (qbt_fw_clone(dst, src, &fw_info))
         {
             rt_kprintf("Clone firmware success from %s to %s.\n", src, dst);
         }
@@ -1540,7 +3460,7 @@ static void qbt_shell_cmd(rt_uint8_t argc, char **argv)
         }
 
         part_name = argv[2];
-        if ( ! qbt_fw_check(part_name, &fw_info, false))
+        if ( ! qbt_fw_check(part_name, &fw_info, QBOOT_CHECK_HDR, false))
         {
             rt_kprintf("%s partition without firmware.\n", part_name);
             return;
@@ -1553,9 +3473,37 @@ static void qbt_shell_cmd(rt_uint8_t argc, char **argv)
     
     if (strcmp(argv[1], "jump") == 0)
     {
-        qbt_jump_to_app();
+        qbt_app_jump();
+        return;
+    }
+    
+    #ifdef QBOOT_USING_AB_SLOT
+    if (strcmp(argv[1], "slot") == 0)
+    {
+        if ((argc >= 3) && (strcmp(argv[2], "confirm") == 0))
+        {
+            qbt_slot_confirm();
+        }
+        qbt_slot_show();
+        return;
+    }
+    #endif
+    
+    #ifdef QBOOT_USING_STATS
+    if (strcmp(argv[1], "stats") == 0)
+    {
+        qbt_stats_show();
+        return;
+    }
+    #endif
+    
+    #ifdef QBOOT_USING_BENCH
+    if (strcmp(argv[1], "bench") == 0)
+    {
+        qbt_bench_run((argc >= 3) ? argv[2] : NULL);
         return;
     }
+    #endif
     
     rt_kprintf("No supported command.\n");
 }
@@ -4,6 +4,7 @@
  * Change Logs:
  * Date           Author            Notes
  * 2020-07-06     qiyongzhong       first version
+ * 2026-10-14     qboot             add ctr mode and hardware decryption hook
  */
 
 #include <qboot_aes.h>
@@ -13,24 +14,147 @@
 #include <tinycrypt.h>
 #include <string.h>
 
-static u8 qbt_aes_iv[16];
+static int qbt_aes_mode = QBOOT_AES_MODE_CBC;
+static u8 qbt_aes_key[32];
+static u8 qbt_aes_iv0[QBOOT_AES_BLOCK_SIZE];
+static u8 qbt_aes_iv[QBOOT_AES_BLOCK_SIZE];     //cbc: last cipher block, ctr: counter of the next block
+static u8 qbt_aes_stream[QBOOT_AES_BLOCK_SIZE]; //ctr: key stream of the block at qbt_aes_pos
+static u32 qbt_aes_pos = 0;                     //ctr: position in package body
 static tiny_aes_context qbt_aes_ctx;
 
-void qbt_aes_decrypt_init(void)
+static void qbt_aes_str_load(u8 *buf, u32 size, const char *str)
 {
-    int len = strlen(QBOOT_AES_IV);
-    if (len > sizeof(qbt_aes_iv))
+    u32 len = strlen(str);
+    if (len > size)
     {
-        len = sizeof(qbt_aes_iv);
+        len = size;
+    }
+    memset(buf, 0, size);
+    memcpy(buf, str, len);
+}
+
+static u32 qbt_aes_ctr_low(void)
+{
+    return(((u32)qbt_aes_iv[12] << 24) | ((u32)qbt_aes_iv[13] << 16) | ((u32)qbt_aes_iv[14] << 8) | qbt_aes_iv[15]);
+}
+
+static void qbt_aes_ctr_add(u32 blocks)//128 bits big endian counter, as nist sp800-38a
+{
+    for (int i = QBOOT_AES_BLOCK_SIZE - 1; (i >= 0) && (blocks > 0); i--)
+    {
+        u32 sum = qbt_aes_iv[i] + (blocks & 0xFF);
+        qbt_aes_iv[i] = (u8)sum;
+        blocks = (blocks >> 8) + (sum >> 8);
+    }
+}
+
+static void qbt_aes_ctr_next(void)
+{
+    tiny_aes_crypt_ecb(&qbt_aes_ctx, AES_ENCRYPT, qbt_aes_iv, qbt_aes_stream);
+    qbt_aes_ctr_add(1);
+}
+
+static void qbt_aes_ctr_decrypt(u8 *dst_buf, const u8 *src_buf, u32 len)
+{
+    while (len > 0)
+    {
+        u32 ofs = qbt_aes_pos % QBOOT_AES_BLOCK_SIZE;
+        u32 n;
+
+        if ((ofs == 0) && (len >= QBOOT_AES_BLOCK_SIZE))
+        {
+            u32 wrap = 0 - qbt_aes_ctr_low();//blocks before the low 32 bits of counter overflow
+            n = len / QBOOT_AES_BLOCK_SIZE;
+            if ((wrap != 0) && (n > wrap))
+            {
+                n = wrap;
+            }
+            n *= QBOOT_AES_BLOCK_SIZE;
+            if (qbt_aes_hw_decrypt(QBOOT_AES_MODE_CTR, qbt_aes_key, qbt_aes_iv, dst_buf, src_buf, n))
+            {
+                qbt_aes_ctr_add(n / QBOOT_AES_BLOCK_SIZE);
+                qbt_aes_pos += n;
+                dst_buf += n;
+                src_buf += n;
+                len -= n;
+                continue;
+            }
+        }
+
+        if (ofs == 0)
+        {
+            qbt_aes_ctr_next();
+        }
+        n = QBOOT_AES_BLOCK_SIZE - ofs;
+        if (n > len)
+        {
+            n = len;
+        }
+        for (u32 i = 0; i < n; i++)
+        {
+            dst_buf[i] = src_buf[i] ^ qbt_aes_stream[ofs + i];
+        }
+        qbt_aes_pos += n;
+        dst_buf += n;
+        src_buf += n;
+        len -= n;
+    }
+}
+
+rt_weak bool qbt_aes_hw_decrypt(int mode, const u8 *key, const u8 *iv, u8 *dst_buf, const u8 *src_buf, u32 len)
+{
+    return(false);//no crypto peripheral, decrypted by tinycrypt
+}
+
+void qbt_aes_decrypt_init(int mode)
+{
+    qbt_aes_mode = mode;
+    qbt_aes_str_load(qbt_aes_key, sizeof(qbt_aes_key), QBOOT_AES_KEY);
+    qbt_aes_str_load(qbt_aes_iv0, sizeof(qbt_aes_iv0), QBOOT_AES_IV);
+    memcpy(qbt_aes_iv, qbt_aes_iv0, sizeof(qbt_aes_iv));
+    qbt_aes_pos = 0;
+    if (mode == QBOOT_AES_MODE_CTR)
+    {
+        tiny_aes_setkey_enc(&qbt_aes_ctx, qbt_aes_key, 256);//key stream is the encrypted counter
+    }
+    else
+    {
+        tiny_aes_setkey_dec(&qbt_aes_ctx, qbt_aes_key, 256);
+    }
+}
+
+void qbt_aes_ctr_seek(u32 pos)
+{
+    memcpy(qbt_aes_iv, qbt_aes_iv0, sizeof(qbt_aes_iv));
+    qbt_aes_ctr_add(pos / QBOOT_AES_BLOCK_SIZE);
+    qbt_aes_pos = pos;
+    if (pos % QBOOT_AES_BLOCK_SIZE != 0)
+    {
+        qbt_aes_ctr_next();
     }
-    memset(qbt_aes_iv, 0, sizeof(qbt_aes_iv));
-    memcpy(qbt_aes_iv, QBOOT_AES_IV, len);
-    tiny_aes_setkey_dec(&qbt_aes_ctx, (u8 *)QBOOT_AES_KEY, 256);
 }
 
 void qbt_aes_decrypt(u8 *dst_buf, const u8 *src_buf, u32 len)
 {
-    tiny_aes_crypt_cbc(&qbt_aes_ctx, AES_DECRYPT, len, qbt_aes_iv, (u8 *)src_buf, dst_buf);    
+    u8 next_iv[QBOOT_AES_BLOCK_SIZE];
+
+    if (qbt_aes_mode == QBOOT_AES_MODE_CTR)
+    {
+        qbt_aes_ctr_decrypt(dst_buf, src_buf, len);
+        return;
+    }
+
+    if (len < QBOOT_AES_BLOCK_SIZE)
+    {
+        return;
+    }
+    memcpy(next_iv, src_buf + len - QBOOT_AES_BLOCK_SIZE, QBOOT_AES_BLOCK_SIZE);//src_buf may be overwritten
+    if (qbt_aes_hw_decrypt(QBOOT_AES_MODE_CBC, qbt_aes_key, qbt_aes_iv, dst_buf, src_buf, len))
+    {
+        memcpy(qbt_aes_iv, next_iv, sizeof(qbt_aes_iv));
+        return;
+    }
+    tiny_aes_crypt_cbc(&qbt_aes_ctx, AES_DECRYPT, len, qbt_aes_iv, (u8 *)src_buf, dst_buf);
 }
 
 #endif
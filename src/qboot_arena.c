@@ -0,0 +1,87 @@
+/*
+ * qboot_arena.c
+ *
+ * Change Logs:
+ * Date           Author            Notes
+ * 2026-10-14     qboot             first version
+ */
+
+#include <qboot_arena.h>
+
+//#define QBOOT_ARENA_DEBUG
+#define QBOOT_ARENA_USING_LOG
+#define DBG_TAG "Qboot"
+
+#ifdef QBOOT_ARENA_DEBUG
+#define DBG_LVL DBG_LOG
+#else
+#define DBG_LVL DBG_INFO
+#endif
+
+#ifdef QBOOT_ARENA_USING_LOG
+#ifndef DBG_ENABLE
+#define DBG_ENABLE
+#endif
+#ifndef DBG_COLOR
+#define DBG_COLOR
+#endif
+#endif
+
+#include <rtdbg.h>
+
+/*
+ * All the working buffers of qboot are one static arena, sized for the selected algorithms.
+ * The compress and crypt buffers are at its head, the pool behind them is carved in sequence
+ * by the buffers of a phase, e.g. the inflate state of zlib while checking or releasing, the
+ * pipe blocks while releasing, or the buffers of hpatchlite, which are never live together.
+ * The pool is reused as soon as all its blocks are freed. It is carved by one thread at a time.
+ */
+
+u32 qbt_arena[QBOOT_ARENA_SIZE / 4];
+
+static u32 arena_used = 0;
+static u32 arena_blocks = 0;
+
+void qbt_arena_reset(void)
+{
+    if (arena_blocks > 0)
+    {
+        LOG_D("Qboot arena reset, %d blocks of %d bytes are dropped.", arena_blocks, arena_used);
+    }
+    arena_used = 0;
+    arena_blocks = 0;
+}
+
+void *qbt_arena_alloc(u32 size)
+{
+    u8 *ptr;
+
+    size = (size + 7) & ~7;
+    if (size > QBOOT_ARENA_SIZE - QBOOT_ARENA_POOL_OFS - arena_used)
+    {
+        LOG_D("Qboot arena is used up, %d bytes are taken from heap.", size);
+        return(rt_malloc(size));
+    }
+    ptr = QBOOT_ARENA_AT(QBOOT_ARENA_POOL_OFS + arena_used);
+    arena_used += size;
+    arena_blocks++;
+    return(ptr);
+}
+
+void qbt_arena_free(void *ptr)
+{
+    if (ptr == RT_NULL)
+    {
+        return;
+    }
+    if (((u8 *)ptr < QBOOT_ARENA_AT(QBOOT_ARENA_POOL_OFS)) || ((u8 *)ptr >= QBOOT_ARENA_AT(QBOOT_ARENA_SIZE)))
+    {
+        rt_free(ptr);
+        return;
+    }
+    if ((arena_blocks > 0) && (--arena_blocks == 0))
+    {
+        arena_used = 0;
+    }
+}
+
@@ -13,6 +13,7 @@
 #include <rtthread.h>
 #include <rtdevice.h>
 #include <qboot.h>
+#include <qboot_jump.h>
 
 #ifdef CHIP_NAME_AT32F403AVGT7
 #include <at32f403a_407.h>
@@ -40,6 +41,66 @@
 
 #include <rtdbg.h>
 
+#if defined(QBOOT_USING_HW_CRC) && defined(CHIP_NAME_AT32F403AVGT7)
+#include <qboot_crc.h>
+
+u32 qbt_crc32_cyc_cal(u32 crc, const u8 *buf, u32 len)
+{
+    u32 head = (4 - ((rt_ubase_t)buf & 0x03)) & 0x03;
+    u32 words;
+
+    if (head > len)
+    {
+        head = len;
+    }
+    crc = qbt_crc32_sw_cyc_cal(crc, buf, head);//unaligned head
+    buf += head;
+    len -= head;
+
+    words = len / 4;
+    if (words > 0)
+    {
+        const u32 *p = (const u32 *)buf;
+        crm_periph_clock_enable(CRM_CRC_PERIPH_CLOCK, TRUE);
+        qbt_jump_periph_mark(QBOOT_JUMP_PERIPH_CRC);
+        crc_init_data_set(__RBIT(crc));//reflected crc32: bit reversed init, word input reversed, output reversed
+        crc_reverse_input_data_set(CRC_REVERSE_INPUT_BY_WORD);
+        crc_reverse_output_data_set(CRC_REVERSE_OUTPUT_DATA);
+        crc_data_reset();
+        for (u32 i = 0; i < words; i++)
+        {
+            crc_one_word_calculate(p[i]);
+        }
+        crc = crc_data_get();
+        buf += words * 4;
+        len -= words * 4;
+    }
+
+    return(qbt_crc32_sw_cyc_cal(crc, buf, len));//remain tail
+}
+#endif
+
+#if defined(QBOOT_USING_STATS) && defined(DWT_CTRL_CYCCNTENA_Msk)
+#include <qboot_stats.h>
+
+u32 qbt_stats_cycle_get(void)
+{
+    if ((DWT->CTRL & DWT_CTRL_CYCCNTENA_Msk) == 0)
+    {
+        CoreDebug->DEMCR |= CoreDebug_DEMCR_TRCENA_Msk;
+        DWT->CYCCNT = 0;
+        DWT->CTRL |= DWT_CTRL_CYCCNTENA_Msk;
+        qbt_jump_periph_mark(QBOOT_JUMP_PERIPH_CYCCNT);
+    }
+    return(DWT->CYCCNT);
+}
+
+u32 qbt_stats_cycle_freq(void)
+{
+    return(SystemCoreClock);
+}
+#endif
+
 #ifdef QBOOT_APP_RUN_IN_QSPI_FLASH
 
 static void qbt_qspi_flash_init(void)
@@ -79,10 +140,39 @@ static void qbt_reset_periph(void)
 #endif
 }
 
+#ifdef QBOOT_USING_FAST_JUMP
+#if defined(QBOOT_USING_HW_CRC) && defined(CHIP_NAME_AT32F403AVGT7)
+static void qbt_crc_deinit(void)
+{
+    crm_periph_clock_enable(CRM_CRC_PERIPH_CLOCK, FALSE);
+}
+#endif
+
+static void qbt_reset_clock(void)
+{
+    #if (defined(AT32F403Axx) || defined(AT32F407xx))
+    crm_reset();
+    #else
+    RCC_Reset();
+    #endif
+}
+
+static const qbt_jump_periph_t qbt_jump_periph_tab[] = {
+    #if defined(QBOOT_USING_HW_CRC) && defined(CHIP_NAME_AT32F403AVGT7)
+    {QBOOT_JUMP_PERIPH_CRC, qbt_crc_deinit},
+    #endif
+    {QBOOT_JUMP_PERIPH_ALWAYS, RT_NULL},//end of table, it is never empty
+};
+
+static const qbt_jump_port_t qbt_jump_port = {
+    qbt_jump_periph_tab, sizeof(qbt_jump_periph_tab) / sizeof(qbt_jump_periph_tab[0]), qbt_reset_periph, qbt_reset_clock
+};
+#endif
+
 rt_weak void qbt_jump_to_app(void)
 {
     typedef void (*app_func_t)(void);
-    u32 app_addr = QBOOT_APP_ADDR;
+    u32 app_addr = qbt_app_addr_get();
     u32 stk_addr = *((volatile uint32_t *)app_addr);
     app_func_t app_func = (app_func_t)(*((volatile uint32_t *)(app_addr + 4)));
 
@@ -93,7 +183,13 @@ rt_weak void qbt_jump_to_app(void)
     }
 
     rt_kprintf("Jump to application running ... \n");
-    rt_thread_mdelay(200);
+    #ifdef QBOOT_USING_FAST_JUMP
+    qbt_jump_app_run(&qbt_jump_port, stk_addr, (u32)app_func);
+    #else
+    if (rt_thread_self() != RT_NULL)//not in early jump before the scheduler starts
+    {
+        rt_thread_mdelay(200);
+    }
     
     __disable_irq();
     qbt_reset_periph();
@@ -118,6 +214,7 @@ rt_weak void qbt_jump_to_app(void)
     __set_MSP(stk_addr);
     
     app_func();//Jump to application running
+    #endif
     
     LOG_E("Qboot jump to application fail.");
 }
@@ -0,0 +1,629 @@
+/*
+ * qboot_bench.c
+ *
+ * Change Logs:
+ * Date           Author            Notes
+ * 2026-10-14     qboot             first version
+ */
+
+#include <qboot_bench.h>
+#include <qboot_crc.h>
+#include <qboot_aes.h>
+#include <qboot_gzip.h>
+#include <qboot_quicklz.h>
+#include <qboot_fastlz.h>
+#include <qboot_lz4.h>
+#include <fal.h>
+#include <string.h>
+
+#ifdef QBOOT_USING_BENCH
+
+#ifdef QBOOT_USING_GZIP
+#include <zlib.h>
+#endif
+
+#ifdef QBOOT_USING_QUICKLZ
+#include <quicklz.h>
+#endif
+
+#define QBOOT_BENCH_CMPRS_SIZE          (QBOOT_BENCH_DATA_SIZE + QBOOT_BENCH_DATA_SIZE / 8 + 1024)//worst case of all compressors
+#define QBOOT_BENCH_GZIP_WINDOW_BITS    12//small window for the compressor, the decoder allocates window as the stream header
+#define QBOOT_BENCH_FASTLZ_HASH_SIZE    1024
+#define QBOOT_BENCH_FASTLZ_MAX_COPY     32
+#define QBOOT_BENCH_FASTLZ_MAX_LEN      264
+#define QBOOT_BENCH_FASTLZ_MAX_DISTANCE 8192
+#define QBOOT_BENCH_LZ4_HASH_BITS       10
+#define QBOOT_BENCH_LZ4_MIN_MATCH       4
+#define QBOOT_BENCH_LZ4_MF_LIMIT        12//last match starts 12 bytes before the end of block
+#define QBOOT_BENCH_LZ4_LAST_LITERALS   5//last 5 bytes of block are literals
+
+typedef bool (*qbt_bench_func_t)(void);
+
+typedef struct {
+    const struct fal_partition *part;
+    u8 *raw_buf;                        //synthetic datas
+    u8 *cmprs_buf;
+    u8 *out_buf;
+    u32 data_len;
+    u32 cmprs_len;
+    u32 heap_base;
+    u32 heap_peak;
+}qbt_bench_ctx_t;
+
+static qbt_bench_ctx_t bench;
+
+static u32 qbt_bench_tick_to_ms(rt_tick_t tick)
+{
+    return((u32)((u64)tick * 1000 / RT_TICK_PER_SECOND));
+}
+
+static u32 qbt_bench_kbps(u32 bytes, u32 ms)
+{
+    if (ms == 0)
+    {
+        ms = 1;
+    }
+    return((u32)((u64)bytes * 1000 / 1024 / ms));
+}
+
+static void qbt_bench_heap_mark(void)//call it while the tested function holds its memory
+{
+    #ifdef RT_USING_HEAP
+    rt_size_t total = 0, used = 0, max_used = 0;
+    rt_memory_info(&total, &used, &max_used);
+    if ((used > bench.heap_base) && (used - bench.heap_base > bench.heap_peak))
+    {
+        bench.heap_peak = used - bench.heap_base;
+    }
+    #endif
+}
+
+static u32 qbt_bench_heap_used(void)
+{
+    #ifdef RT_USING_HEAP
+    rt_size_t total = 0, used = 0, max_used = 0;
+    rt_memory_info(&total, &used, &max_used);
+    return(used);
+    #else
+    return(0);
+    #endif
+}
+
+static void qbt_bench_data_gen(u8 *buf, u32 len)//segments of random bytes and copies of recent datas, like code and tables
+{
+    u32 seed = 0x20201014;
+    u32 pos = 0;
+
+    while (pos < len)
+    {
+        u32 seg_len, back;
+        seed = seed * 1103515245 + 12345;
+        seg_len = 4 + ((seed >> 8) & 0x1F);
+        back = 1 + ((seed >> 16) & 0x7FF);
+        if (((seed >> 28) & 0x01) && (pos >= back))
+        {
+            for (u32 i = 0; (i < seg_len) && (pos < len); i++, pos++)
+            {
+                buf[pos] = buf[pos - back];
+            }
+        }
+        else
+        {
+            for (u32 i = 0; (i < seg_len) && (pos < len); i++, pos++)
+            {
+                seed = seed * 1103515245 + 12345;
+                buf[pos] = seed >> 24;
+            }
+        }
+    }
+}
+
+static u32 qbt_bench_repeat(qbt_bench_func_t func, u32 bytes)//return KB/s, 0 if fail
+{
+    u32 cnt = 0;
+    u32 ms = 0;
+    rt_tick_t start = rt_tick_get();
+
+    do
+    {
+        if ( ! func())
+        {
+            return(0);
+        }
+        cnt++;
+        ms = qbt_bench_tick_to_ms(rt_tick_get() - start);
+    } while (ms < QBOOT_BENCH_TIME_MS);
+
+    return((u32)((u64)bytes * cnt * 1000 / 1024 / ms));
+}
+
+static void qbt_bench_show(const char *item, const char *name, u32 kbps)
+{
+    if (kbps == 0)
+    {
+        rt_kprintf("| %-12s %-16s | %14s |\n", item, name, "fail");
+        return;
+    }
+    rt_kprintf("| %-12s %-16s | %9d KB/s |\n", item, name, kbps);
+}
+
+static bool qbt_bench_read(void)
+{
+    return(fal_partition_read(bench.part, 0, bench.out_buf, bench.data_len) >= 0);
+}
+
+static void qbt_bench_flash_read(void)
+{
+    size_t part_num = 0;
+    const struct fal_partition *part_tbl = fal_get_partition_table(&part_num);
+
+    for (size_t i = 0; i < part_num; i++)
+    {
+        bench.part = &part_tbl[i];
+        bench.data_len = (bench.part->len < QBOOT_BENCH_DATA_SIZE) ? bench.part->len : QBOOT_BENCH_DATA_SIZE;
+        qbt_bench_show("Flash read", bench.part->name, qbt_bench_repeat(qbt_bench_read, bench.data_len));
+    }
+}
+
+static void qbt_bench_flash_write(const char *part_name)
+{
+    const struct fal_flash_dev *flash_dev;
+    u32 len, ms, erase_ms;
+    rt_tick_t start;
+
+    bench.part = fal_partition_find(part_name);
+    if (bench.part == NULL)
+    {
+        rt_kprintf("%s partition is not exist.\n", part_name);
+        return;
+    }
+    flash_dev = fal_flash_device_find(bench.part->flash_name);
+    if ((flash_dev == NULL) || (flash_dev->blk_size == 0))
+    {
+        rt_kprintf("%s partition sector size is unknown.\n", part_name);
+        return;
+    }
+    len = QBOOT_BENCH_DATA_SIZE + flash_dev->blk_size - 1;
+    len -= len % flash_dev->blk_size;
+    if (len > bench.part->len)
+    {
+        len = bench.part->len;
+    }
+
+    start = rt_tick_get();
+    if (fal_partition_erase(bench.part, 0, len) < 0)
+    {
+        qbt_bench_show("Flash erase", part_name, 0);
+        return;
+    }
+    erase_ms = qbt_bench_tick_to_ms(rt_tick_get() - start);
+
+    start = rt_tick_get();
+    for (u32 pos = 0; pos < len; pos += QBOOT_BENCH_DATA_SIZE)
+    {
+        u32 write_len = (len - pos < QBOOT_BENCH_DATA_SIZE) ? (len - pos) : QBOOT_BENCH_DATA_SIZE;
+        if (fal_partition_write(bench.part, pos, bench.raw_buf, write_len) < 0)
+        {
+            qbt_bench_show("Flash write", part_name, 0);
+            return;
+        }
+    }
+    ms = qbt_bench_tick_to_ms(rt_tick_get() - start);
+
+    bench.data_len = (len < QBOOT_BENCH_DATA_SIZE) ? len : QBOOT_BENCH_DATA_SIZE;
+    if (( ! qbt_bench_read()) || (memcmp(bench.out_buf, bench.raw_buf, bench.data_len) != 0))
+    {
+        qbt_bench_show("Flash write", part_name, 0);
+        return;
+    }
+    qbt_bench_show("Flash write", part_name, qbt_bench_kbps(len, ms));
+
+    start = rt_tick_get();
+    if (fal_partition_erase(bench.part, 0, len) < 0)//leave the scratch area blank
+    {
+        qbt_bench_show("Flash erase", part_name, 0);
+        return;
+    }
+    erase_ms += qbt_bench_tick_to_ms(rt_tick_get() - start);
+    qbt_bench_show("Flash erase", part_name, qbt_bench_kbps(len * 2, erase_ms));
+}
+
+static bool qbt_bench_crc(void)
+{
+    qbt_crc32_cyc_cal(0xFFFFFFFF, bench.raw_buf, QBOOT_BENCH_DATA_SIZE);
+    return(true);
+}
+
+#ifdef QBOOT_USING_HW_CRC
+static bool qbt_bench_crc_sw(void)
+{
+    qbt_crc32_sw_cyc_cal(0xFFFFFFFF, bench.raw_buf, QBOOT_BENCH_DATA_SIZE);
+    return(true);
+}
+#endif
+
+#ifdef QBOOT_USING_AES
+static bool qbt_bench_aes(void)
+{
+    qbt_aes_decrypt(bench.out_buf, bench.raw_buf, QBOOT_BENCH_DATA_SIZE);
+    return(true);
+}
+#endif
+
+#ifdef QBOOT_USING_GZIP
+static bool qbt_bench_gzip_prepare(void)
+{
+    z_stream strm;
+    bool rst;
+
+    memset(&strm, 0, sizeof(strm));
+    if (deflateInit2(&strm, Z_DEFAULT_COMPRESSION, Z_DEFLATED, 16 + QBOOT_BENCH_GZIP_WINDOW_BITS, 2, Z_DEFAULT_STRATEGY) != Z_OK)
+    {
+        return(false);
+    }
+    strm.next_in = bench.raw_buf;
+    strm.avail_in = QBOOT_BENCH_DATA_SIZE;
+    strm.next_out = bench.cmprs_buf;
+    strm.avail_out = QBOOT_BENCH_CMPRS_SIZE;
+    rst = (deflate(&strm, Z_FINISH) == Z_STREAM_END);
+    bench.cmprs_len = QBOOT_BENCH_CMPRS_SIZE - strm.avail_out;
+    deflateEnd(&strm);
+
+    return(rst);
+}
+
+static bool qbt_bench_gzip(void)
+{
+    u32 out_len = 0;
+
+    qbt_gzip_init();
+    qbt_gzip_set_in(bench.cmprs_buf, bench.cmprs_len);
+    while (out_len < QBOOT_BENCH_DATA_SIZE)
+    {
+        int len = qbt_gzip_decompress(bench.out_buf + out_len, QBOOT_BENCH_DATA_SIZE - out_len);
+        if (len <= 0)
+        {
+            return(false);
+        }
+        out_len += len;
+    }
+    qbt_bench_heap_mark();
+    qbt_gzip_deinit();
+
+    return(true);
+}
+#endif
+
+#ifdef QBOOT_USING_QUICKLZ
+static bool qbt_bench_quicklz_prepare(void)
+{
+    qlz_state_compress *state = rt_malloc(sizeof(qlz_state_compress));
+
+    if (state == NULL)
+    {
+        return(false);
+    }
+    bench.cmprs_len = 0;
+    for (u32 pos = 0; pos < QBOOT_BENCH_DATA_SIZE; pos += QBOOT_BENCH_BLK_SIZE)
+    {
+        u32 len = (QBOOT_BENCH_DATA_SIZE - pos < QBOOT_BENCH_BLK_SIZE) ? (QBOOT_BENCH_DATA_SIZE - pos) : QBOOT_BENCH_BLK_SIZE;
+        memset(state, 0, sizeof(qlz_state_compress));
+        bench.cmprs_len += qlz_compress(bench.raw_buf + pos, (char *)bench.cmprs_buf + bench.cmprs_len, len, state);
+    }
+    rt_free(state);
+
+    return(true);
+}
+
+static bool qbt_bench_quicklz(void)
+{
+    u32 out_len = 0;
+
+    for (u32 pos = 0; pos < bench.cmprs_len; pos += qlz_size_compressed((char *)bench.cmprs_buf + pos))
+    {
+        qbt_quicklz_state_init();
+        out_len += qbt_quicklz_decompress(bench.out_buf + out_len, bench.cmprs_buf + pos);
+    }
+
+    return(out_len == QBOOT_BENCH_DATA_SIZE);
+}
+#endif
+
+#ifdef QBOOT_USING_FASTLZ
+static u32 qbt_bench_fastlz_literal(u8 *dst, const u8 *src, u32 len)
+{
+    u32 op = 0;
+
+    while (len > 0)
+    {
+        u32 run = (len > QBOOT_BENCH_FASTLZ_MAX_COPY) ? QBOOT_BENCH_FASTLZ_MAX_COPY : len;
+        dst[op++] = run - 1;
+        memcpy(dst + op, src, run);
+        op += run;
+        src += run;
+        len -= run;
+    }
+
+    return(op);
+}
+
+static u32 qbt_bench_fastlz_encode(u8 *dst, const u8 *src, u32 len)//greedy level 1 encoder, the package compressor needs 32K stack
+{
+    u16 htab[QBOOT_BENCH_FASTLZ_HASH_SIZE];
+    u32 ip = 0, anchor = 0, op = 0;
+
+    memset(htab, 0, sizeof(htab));
+    while (ip + 3 <= len)
+    {
+        u32 hash = ((src[ip] << 8) ^ (src[ip + 1] << 4) ^ src[ip + 2]) % QBOOT_BENCH_FASTLZ_HASH_SIZE;
+        u32 ref = htab[hash];
+        htab[hash] = ip + 1;
+        if ((ref > 0) && (ip - (ref - 1) <= QBOOT_BENCH_FASTLZ_MAX_DISTANCE) && (memcmp(src + ref - 1, src + ip, 3) == 0))
+        {
+            u32 dist = ip - ref;//distance - 1
+            u32 match_len = 3;
+            ref--;
+            while ((ip + match_len < len) && (match_len < QBOOT_BENCH_FASTLZ_MAX_LEN) && (src[ref + match_len] == src[ip + match_len]))
+            {
+                match_len++;
+            }
+            op += qbt_bench_fastlz_literal(dst + op, src + anchor, ip - anchor);
+            if (match_len - 2 < 7)
+            {
+                dst[op++] = ((match_len - 2) << 5) + (dist >> 8);
+            }
+            else
+            {
+                dst[op++] = (7 << 5) + (dist >> 8);
+                dst[op++] = match_len - 2 - 7;
+            }
+            dst[op++] = dist & 0xFF;
+            ip += match_len;
+            anchor = ip;
+            continue;
+        }
+        ip++;
+    }
+    op += qbt_bench_fastlz_literal(dst + op, src + anchor, len - anchor);
+
+    return(op);
+}
+
+static bool qbt_bench_fastlz_prepare(void)
+{
+    bench.cmprs_len = 0;
+    for (u32 pos = 0; pos < QBOOT_BENCH_DATA_SIZE; pos += QBOOT_BENCH_BLK_SIZE)
+    {
+        u32 len = (QBOOT_BENCH_DATA_SIZE - pos < QBOOT_BENCH_BLK_SIZE) ? (QBOOT_BENCH_DATA_SIZE - pos) : QBOOT_BENCH_BLK_SIZE;
+        u8 *hdr = bench.cmprs_buf + bench.cmprs_len;
+        u32 block_size = qbt_bench_fastlz_encode(hdr + QBOOT_FASTLZ_BLOCK_HDR_SIZE, bench.raw_buf + pos, len);
+        for (int i = 0; i < QBOOT_FASTLZ_BLOCK_HDR_SIZE; i++)//big endian block size, same as the packager
+        {
+            hdr[i] = block_size >> (8 * (QBOOT_FASTLZ_BLOCK_HDR_SIZE - 1 - i));
+        }
+        bench.cmprs_len += QBOOT_FASTLZ_BLOCK_HDR_SIZE + block_size;
+    }
+
+    return(true);
+}
+
+static bool qbt_bench_fastlz(void)
+{
+    u32 out_len = 0;
+
+    for (u32 pos = 0; pos < bench.cmprs_len; )
+    {
+        u32 block_size = qbt_fastlz_get_block_size(bench.cmprs_buf + pos);
+        u32 len = qbt_fastlz_decompress(bench.out_buf + out_len, QBOOT_BENCH_DATA_SIZE - out_len, bench.cmprs_buf + pos + QBOOT_FASTLZ_BLOCK_HDR_SIZE, block_size);
+        if (len == 0)
+        {
+            return(false);
+        }
+        out_len += len;
+        pos += QBOOT_FASTLZ_BLOCK_HDR_SIZE + block_size;
+    }
+
+    return(out_len == QBOOT_BENCH_DATA_SIZE);
+}
+#endif
+
+#ifdef QBOOT_USING_LZ4
+static u32 qbt_bench_lz4_len_put(u8 *dst, u32 len)//length beyond the 4 bits of token
+{
+    u32 op = 0;
+
+    while (len >= 255)
+    {
+        dst[op++] = 255;
+        len -= 255;
+    }
+    dst[op++] = len;
+
+    return(op);
+}
+
+static u32 qbt_bench_lz4_seq_put(u8 *dst, const u8 *lit, u32 lit_len, u32 dist, u32 match_len)//match_len 0 for the last sequence
+{
+    u32 op = 1;
+
+    dst[0] = ((lit_len < 15) ? lit_len : 15) << 4;
+    if (lit_len >= 15)
+    {
+        op += qbt_bench_lz4_len_put(dst + op, lit_len - 15);
+    }
+    memcpy(dst + op, lit, lit_len);
+    op += lit_len;
+    if (match_len == 0)
+    {
+        return(op);
+    }
+    dst[op++] = dist & 0xFF;
+    dst[op++] = dist >> 8;
+    match_len -= QBOOT_BENCH_LZ4_MIN_MATCH;
+    dst[0] |= (match_len < 15) ? match_len : 15;
+    if (match_len >= 15)
+    {
+        op += qbt_bench_lz4_len_put(dst + op, match_len - 15);
+    }
+
+    return(op);
+}
+
+static u32 qbt_bench_lz4_encode(u8 *dst, const u8 *src, u32 len)//greedy encoder of the block format
+{
+    u16 htab[1 << QBOOT_BENCH_LZ4_HASH_BITS];
+    u32 ip = 0, anchor = 0, op = 0;
+
+    memset(htab, 0, sizeof(htab));
+    while (ip + QBOOT_BENCH_LZ4_MF_LIMIT <= len)
+    {
+        u32 seq = src[ip] | (src[ip + 1] << 8) | (src[ip + 2] << 16) | ((u32)src[ip + 3] << 24);
+        u32 hash = (seq * 2654435761U) >> (32 - QBOOT_BENCH_LZ4_HASH_BITS);
+        u32 ref = htab[hash];
+        htab[hash] = ip + 1;
+        if ((ref > 0) && (memcmp(src + ref - 1, src + ip, QBOOT_BENCH_LZ4_MIN_MATCH) == 0))
+        {
+            u32 match_len = QBOOT_BENCH_LZ4_MIN_MATCH;
+            ref--;
+            while ((ip + match_len < len - QBOOT_BENCH_LZ4_LAST_LITERALS) && (src[ref + match_len] == src[ip + match_len]))
+            {
+                match_len++;
+            }
+            op += qbt_bench_lz4_seq_put(dst + op, src + anchor, ip - anchor, ip - ref, match_len);
+            ip += match_len;
+            anchor = ip;
+            continue;
+        }
+        ip++;
+    }
+    op += qbt_bench_lz4_seq_put(dst + op, src + anchor, len - anchor, 0, 0);
+
+    return(op);
+}
+
+static bool qbt_bench_lz4_prepare(void)
+{
+    bench.cmprs_len = 0;
+    for (u32 pos = 0; pos < QBOOT_BENCH_DATA_SIZE; pos += QBOOT_BENCH_BLK_SIZE)
+    {
+        u32 len = (QBOOT_BENCH_DATA_SIZE - pos < QBOOT_BENCH_BLK_SIZE) ? (QBOOT_BENCH_DATA_SIZE - pos) : QBOOT_BENCH_BLK_SIZE;
+        u8 *hdr = bench.cmprs_buf + bench.cmprs_len;
+        u32 block_size = qbt_bench_lz4_encode(hdr + QBOOT_LZ4_BLOCK_HDR_SIZE, bench.raw_buf + pos, len);
+        for (int i = 0; i < QBOOT_LZ4_BLOCK_HDR_SIZE; i++)
+        {
+            hdr[i] = block_size >> (8 * (QBOOT_LZ4_BLOCK_HDR_SIZE - 1 - i));
+        }
+        bench.cmprs_len += QBOOT_LZ4_BLOCK_HDR_SIZE + block_size;
+    }
+
+    return(true);
+}
+
+static bool qbt_bench_lz4(void)
+{
+    u32 out_len = 0;
+
+    for (u32 pos = 0; pos < bench.cmprs_len; )
+    {
+        u32 block_size = qbt_lz4_get_block_size(bench.cmprs_buf + pos);
+        u32 len = qbt_lz4_decompress(bench.out_buf + out_len, QBOOT_BENCH_DATA_SIZE - out_len, bench.cmprs_buf + pos + QBOOT_LZ4_BLOCK_HDR_SIZE, block_size);
+        if (len == 0)
+        {
+            return(false);
+        }
+        out_len += len;
+        pos += QBOOT_LZ4_BLOCK_HDR_SIZE + block_size;
+    }
+
+    return(out_len == QBOOT_BENCH_DATA_SIZE);
+}
+#endif
+
+static void qbt_bench_codec(const char *name, bool (*prepare)(void), qbt_bench_func_t decode)
+{
+    u32 kbps = 0;
+
+    memset(bench.out_buf, 0, QBOOT_BENCH_DATA_SIZE);
+    if (((prepare == NULL) || prepare()) && decode())
+    {
+        if (memcmp(bench.out_buf, bench.raw_buf, QBOOT_BENCH_DATA_SIZE) == 0)//decoded datas must be same as synthetic datas
+        {
+            kbps = qbt_bench_repeat(decode, QBOOT_BENCH_DATA_SIZE);
+        }
+    }
+    rt_kprintf("| %-12s %-16s | ", "Decode", name);
+    if (kbps == 0)
+    {
+        rt_kprintf("%14s |\n", "fail");
+        return;
+    }
+    rt_kprintf("%9d KB/s |  ratio %3d%%\n", kbps, bench.cmprs_len * 100 / QBOOT_BENCH_DATA_SIZE);
+}
+
+void qbt_bench_run(const char *scratch_part_name)
+{
+    memset(&bench, 0, sizeof(bench));
+    bench.heap_base = qbt_bench_heap_used();
+    bench.raw_buf = rt_malloc(QBOOT_BENCH_DATA_SIZE);
+    bench.cmprs_buf = rt_malloc(QBOOT_BENCH_CMPRS_SIZE);
+    bench.out_buf = rt_malloc(QBOOT_BENCH_DATA_SIZE);
+    if ((bench.raw_buf == NULL) || (bench.cmprs_buf == NULL) || (bench.out_buf == NULL))
+    {
+        rt_kprintf("Qboot bench fail. no memory for %d bytes buffers.\n", QBOOT_BENCH_DATA_SIZE * 2 + QBOOT_BENCH_CMPRS_SIZE);
+        goto exit;
+    }
+    qbt_bench_data_gen(bench.raw_buf, QBOOT_BENCH_DATA_SIZE);
+    qbt_bench_heap_mark();
+
+    rt_kprintf("==== Qboot bench, %d bytes synthetic datas ====\n", QBOOT_BENCH_DATA_SIZE);
+    qbt_bench_flash_read();
+    if (scratch_part_name != NULL)
+    {
+        qbt_bench_flash_write(scratch_part_name);
+    }
+
+    rt_kprintf("| %-12s %-16s | %9d KB/s |\n", "CRC32", "", qbt_bench_repeat(qbt_bench_crc, QBOOT_BENCH_DATA_SIZE));
+    #ifdef QBOOT_USING_HW_CRC
+    rt_kprintf("| %-12s %-16s | %9d KB/s |\n", "CRC32", "software", qbt_bench_repeat(qbt_bench_crc_sw, QBOOT_BENCH_DATA_SIZE));
+    #endif
+
+    #ifdef QBOOT_USING_AES
+    qbt_aes_decrypt_init(QBOOT_AES_MODE_CBC);
+    rt_kprintf("| %-12s %-16s | %9d KB/s |\n", "Decrypt", "AES-CBC", qbt_bench_repeat(qbt_bench_aes, QBOOT_BENCH_DATA_SIZE));
+    qbt_aes_decrypt_init(QBOOT_AES_MODE_CTR);
+    rt_kprintf("| %-12s %-16s | %9d KB/s |\n", "Decrypt", "AES-CTR", qbt_bench_repeat(qbt_bench_aes, QBOOT_BENCH_DATA_SIZE));
+    #endif
+
+    #ifdef QBOOT_USING_GZIP
+    qbt_bench_codec("GZIP", qbt_bench_gzip_prepare, qbt_bench_gzip);
+    #endif
+    #ifdef QBOOT_USING_QUICKLZ
+    qbt_bench_codec("QUICKLZ", qbt_bench_quicklz_prepare, qbt_bench_quicklz);
+    #endif
+    #ifdef QBOOT_USING_FASTLZ
+    qbt_bench_codec("FASTLZ", qbt_bench_fastlz_prepare, qbt_bench_fastlz);
+    #endif
+    #ifdef QBOOT_USING_LZ4
+    qbt_bench_codec("LZ4", qbt_bench_lz4_prepare, qbt_bench_lz4);
+    #endif
+
+    rt_kprintf("| %-29s | %8d B    |\n", "Heap peak", bench.heap_peak);
+    rt_kprintf("\n");
+
+exit:
+    if (bench.raw_buf != NULL)
+    {
+        rt_free(bench.raw_buf);
+    }
+    if (bench.cmprs_buf != NULL)
+    {
+        rt_free(bench.cmprs_buf);
+    }
+    if (bench.out_buf != NULL)
+    {
+        rt_free(bench.out_buf);
+    }
+}
+
+#endif
+
@@ -0,0 +1,118 @@
+/*
+ * qboot_burst.c
+ *
+ * Change Logs:
+ * Date           Author            Notes
+ * 2026-10-14     qboot             first version
+ */
+
+#include <qboot_burst.h>
+#include <string.h>
+
+typedef struct {
+    qbt_burst_out_t out;
+    const struct fal_partition *part;
+    u32 pos;                            //position of the first kept byte
+    u32 fill;                           //bytes kept in buf
+    u8 buf[QBOOT_WRITE_BURST_SIZE];
+}qbt_burst_t;
+
+static qbt_burst_t burst = {0};
+
+static int qbt_burst_out(u32 pos, const u8 *buf, u32 len)
+{
+    if (burst.out != RT_NULL)
+    {
+        return(burst.out(burst.part, pos, buf, len));
+    }
+    return(fal_partition_write(burst.part, pos, buf, len));
+}
+
+void qbt_burst_begin(qbt_burst_out_t out)
+{
+    burst.out = out;
+    burst.part = RT_NULL;
+    burst.fill = 0;
+}
+
+int qbt_burst_write(const struct fal_partition *part, u32 pos, const u8 *buf, u32 len)
+{
+    u32 done = 0;
+    u32 n;
+
+    if ((part != burst.part) || (pos != burst.pos + burst.fill))
+    {
+        if ( ! qbt_burst_flush())
+        {
+            return(-1);
+        }
+        burst.part = part;
+        burst.pos = pos;
+    }
+
+    if (burst.fill > 0)//complete the kept burst first
+    {
+        n = QBOOT_WRITE_BURST_SIZE - burst.fill;
+        if (n > len)
+        {
+            n = len;
+        }
+        memcpy(burst.buf + burst.fill, buf, n);
+        burst.fill += n;
+        done = n;
+        if (burst.fill < QBOOT_WRITE_BURST_SIZE)//all datas are kept
+        {
+            return(len);
+        }
+        if (qbt_burst_out(burst.pos, burst.buf, burst.fill) < 0)
+        {
+            return(-1);
+        }
+        burst.pos += burst.fill;
+        burst.fill = 0;
+    }
+
+    n = (len - done) - ((len - done) % QBOOT_PROG_UNIT_SIZE);
+    if (n >= QBOOT_WRITE_BURST_SIZE)//large enough, no copy
+    {
+        if (qbt_burst_out(burst.pos, buf + done, n) < 0)
+        {
+            return(-1);
+        }
+        burst.pos += n;
+        done += n;
+    }
+    memcpy(burst.buf, buf + done, len - done);//shorter than a burst
+    burst.fill = len - done;
+
+    return(len);
+}
+
+bool qbt_burst_flush(void)
+{
+    u32 len = burst.fill;
+
+    if (len == 0)
+    {
+        return(true);
+    }
+    if (len % QBOOT_PROG_UNIT_SIZE != 0)
+    {
+        u32 pad = QBOOT_PROG_UNIT_SIZE - (len % QBOOT_PROG_UNIT_SIZE);
+        memset(burst.buf + len, 0xFF, pad);
+        len += pad;
+    }
+    burst.fill = 0;
+    if (qbt_burst_out(burst.pos, burst.buf, len) < 0)
+    {
+        return(false);
+    }
+    burst.pos += len;
+    return(true);
+}
+
+void qbt_burst_discard(void)
+{
+    burst.fill = 0;
+    burst.part = RT_NULL;
+}
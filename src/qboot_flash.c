@@ -0,0 +1,318 @@
+/*
+ * qboot_flash.c
+ *
+ * Change Logs:
+ * Date           Author            Notes
+ * 2026-10-14     qboot             first version
+ */
+
+#include <qboot_flash.h>
+#include <qboot_stats.h>
+#include <string.h>
+
+#ifdef QBOOT_USING_FLASH_WRITER
+
+//#define QBOOT_FLASH_DEBUG
+#define QBOOT_FLASH_USING_LOG
+#define DBG_TAG "Qboot"
+
+#ifdef QBOOT_FLASH_DEBUG
+#define DBG_LVL DBG_LOG
+#else
+#define DBG_LVL DBG_INFO
+#endif
+
+#ifdef QBOOT_FLASH_USING_LOG
+#ifndef DBG_ENABLE
+#define DBG_ENABLE
+#endif
+#ifndef DBG_COLOR
+#define DBG_COLOR
+#endif
+#endif
+
+#include <rtdbg.h>
+
+#define QBOOT_FLASH_CMP_BUF_SIZE        256
+
+typedef struct {
+    fal_partition_t part;
+    u32 sector_size;
+    u32 sect_pos;                       //start of current sector in partition
+    u32 sect_len;                       //length written into sector buffer
+    bool sect_open;
+    u8 *sect_buf;                       //NULL when the sector is too large to be buffered
+    u32 skip_cnt;
+    u32 prog_cnt;
+    u32 erase_cnt;
+}qbt_flash_writer_t;
+
+static qbt_flash_writer_t flash_wr = {0};
+#ifdef QBOOT_USING_DIFF_WRITE
+static u8 flash_cmp_buf[QBOOT_FLASH_CMP_BUF_SIZE];
+#endif
+
+static u32 qbt_flash_sector_len(u32 sect_pos)
+{
+    u32 len = flash_wr.sector_size;
+    if (len > flash_wr.part->len - sect_pos)
+    {
+        len = flash_wr.part->len - sect_pos;
+    }
+    return(len);
+}
+
+static bool qbt_flash_sector_erase(u32 sect_pos)
+{
+    if (fal_partition_erase(flash_wr.part, sect_pos, qbt_flash_sector_len(sect_pos)) < 0)
+    {
+        LOG_E("Qboot erase sector fail. part = %s, addr = %08X", flash_wr.part->name, sect_pos);
+        return(false);
+    }
+    flash_wr.erase_cnt++;
+    return(true);
+}
+
+#ifdef QBOOT_USING_DIFF_WRITE
+static int qbt_flash_blank_check(u32 pos, u32 len)//return 1 if blank, 0 if not, -1 if read error
+{
+    while (len > 0)
+    {
+        u32 read_len = (len > QBOOT_FLASH_CMP_BUF_SIZE) ? QBOOT_FLASH_CMP_BUF_SIZE : len;
+        if (fal_partition_read(flash_wr.part, pos, flash_cmp_buf, read_len) < 0)
+        {
+            return(-1);
+        }
+        for (u32 i = 0; i < read_len; i++)
+        {
+            if (flash_cmp_buf[i] != 0xFF)
+            {
+                return(0);
+            }
+        }
+        pos += read_len;
+        len -= read_len;
+    }
+    return(1);
+}
+
+static bool qbt_flash_sector_commit(void)
+{
+    int first_diff = -1;
+    int last_used = -1;
+    u32 prog_ofs;
+
+    for (u32 ofs = 0; ofs < flash_wr.sect_len; )
+    {
+        u32 read_len = flash_wr.sect_len - ofs;
+        if (read_len > QBOOT_FLASH_CMP_BUF_SIZE)
+        {
+            read_len = QBOOT_FLASH_CMP_BUF_SIZE;
+        }
+        if (fal_partition_read(flash_wr.part, flash_wr.sect_pos + ofs, flash_cmp_buf, read_len) < 0)
+        {
+            LOG_E("Qboot read sector fail. part = %s, addr = %08X", flash_wr.part->name, flash_wr.sect_pos + ofs);
+            return(false);
+        }
+        for (u32 i = 0; i < read_len; i++)
+        {
+            if ((first_diff < 0) && (flash_cmp_buf[i] != flash_wr.sect_buf[ofs + i]))
+            {
+                first_diff = ofs + i;
+            }
+            if (flash_cmp_buf[i] != 0xFF)
+            {
+                last_used = ofs + i;
+            }
+        }
+        ofs += read_len;
+    }
+
+    if (first_diff < 0)//same as new datas
+    {
+        flash_wr.skip_cnt++;
+        return(true);
+    }
+
+    prog_ofs = first_diff - (first_diff % QBOOT_DIFF_PROG_ALIGN);
+    if (last_used >= (int)prog_ofs)//datas to be programmed are not blank
+    {
+        if ( ! qbt_flash_sector_erase(flash_wr.sect_pos))
+        {
+            return(false);
+        }
+        prog_ofs = 0;
+    }
+
+    if (fal_partition_write(flash_wr.part, flash_wr.sect_pos + prog_ofs, flash_wr.sect_buf + prog_ofs, flash_wr.sect_len - prog_ofs) < 0)
+    {
+        LOG_E("Qboot write sector fail. part = %s, addr = %08X", flash_wr.part->name, flash_wr.sect_pos + prog_ofs);
+        return(false);
+    }
+    flash_wr.prog_cnt++;
+
+    return(true);
+}
+
+#endif
+
+static bool qbt_flash_sector_open(u32 sect_pos)
+{
+    flash_wr.sect_pos = sect_pos;
+    flash_wr.sect_open = true;
+
+    if (flash_wr.sect_buf != NULL)
+    {
+        memset(flash_wr.sect_buf, 0xFF, flash_wr.sector_size);
+        flash_wr.sect_len = 0;
+        return(true);
+    }
+
+    #ifdef QBOOT_USING_DIFF_WRITE
+    //the sector is too large to be compared, only skip the erase when it is blank
+    switch (qbt_flash_blank_check(sect_pos, qbt_flash_sector_len(sect_pos)))
+    {
+    case 1:
+        return(true);
+    case 0:
+        return(qbt_flash_sector_erase(sect_pos));
+    default:
+        LOG_E("Qboot read sector fail. part = %s, addr = %08X", flash_wr.part->name, sect_pos);
+        return(false);
+    }
+    #else
+    return(qbt_flash_sector_erase(sect_pos));//erase just before the write cursor reaches it
+    #endif
+}
+
+static bool qbt_flash_sector_close(void)
+{
+    if ( ! flash_wr.sect_open)
+    {
+        return(true);
+    }
+    flash_wr.sect_open = false;
+    if (flash_wr.sect_buf == NULL)
+    {
+        flash_wr.prog_cnt++;
+        return(true);
+    }
+    #ifdef QBOOT_USING_DIFF_WRITE
+    return(qbt_flash_sector_commit());
+    #else
+    return(true);
+    #endif
+}
+
+bool qbt_flash_write_begin(fal_partition_t part)
+{
+    const struct fal_flash_dev *flash_dev = fal_flash_device_find(part->flash_name);
+
+    if ((flash_dev == NULL) || (flash_dev->blk_size == 0))
+    {
+        LOG_E("Qboot flash write begin fail. unknown sector size of %s.", part->name);
+        return(false);
+    }
+
+    memset(&flash_wr, 0, sizeof(flash_wr));
+    flash_wr.part = part;
+    flash_wr.sector_size = flash_dev->blk_size;
+    #ifdef QBOOT_USING_DIFF_WRITE
+    if (flash_wr.sector_size <= QBOOT_DIFF_SECTOR_MAX_SIZE)
+    {
+        flash_wr.sect_buf = rt_malloc(flash_wr.sector_size);
+    }
+    if (flash_wr.sect_buf == NULL)
+    {
+        LOG_D("Qboot flash write without sector buffer, sector size = %d", flash_wr.sector_size);
+    }
+    #endif
+
+    return(true);
+}
+
+int qbt_flash_write(const struct fal_partition *part, uint32_t addr, const uint8_t *buf, size_t size)
+{
+    u32 write_len = 0;
+
+    if (part != flash_wr.part)//not managed
+    {
+        return(fal_partition_write(part, addr, buf, size));
+    }
+
+    while (write_len < size)
+    {
+        u32 pos = addr + write_len;
+        u32 sect_pos = pos - ((part->offset + pos) % flash_wr.sector_size);
+        u32 ofs = pos - sect_pos;
+        u32 len = flash_wr.sector_size - ofs;
+        if (len > size - write_len)
+        {
+            len = size - write_len;
+        }
+
+        if (( ! flash_wr.sect_open) || (sect_pos != flash_wr.sect_pos))
+        {
+            if (flash_wr.sect_open && (sect_pos < flash_wr.sect_pos))
+            {
+                LOG_E("Qboot flash write fail. out of sequence, addr = %08X", pos);
+                return(-1);
+            }
+            if (( ! qbt_flash_sector_close()) || ( ! qbt_flash_sector_open(sect_pos)))
+            {
+                return(-1);
+            }
+        }
+
+        if (flash_wr.sect_buf != NULL)
+        {
+            memcpy(flash_wr.sect_buf + ofs, buf + write_len, len);
+            if (flash_wr.sect_len < ofs + len)
+            {
+                flash_wr.sect_len = ofs + len;
+            }
+        }
+        else if (fal_partition_write(part, pos, buf + write_len, len) < 0)
+        {
+            return(-1);
+        }
+        write_len += len;
+    }
+
+    return(size);
+}
+
+bool qbt_flash_write_sync(void)
+{
+    if (flash_wr.part == NULL)
+    {
+        return(true);
+    }
+    return(qbt_flash_sector_close());
+}
+
+bool qbt_flash_write_end(bool commit)
+{
+    bool ret = true;
+
+    if (flash_wr.part == NULL)
+    {
+        return(true);
+    }
+
+    if (commit)
+    {
+        ret = qbt_flash_sector_close();
+        LOG_I("Qboot flash write %s: %d sectors skipped, %d programmed, %d erased.", flash_wr.part->name, flash_wr.skip_cnt, flash_wr.prog_cnt, flash_wr.erase_cnt);
+    }
+    if (flash_wr.sect_buf != NULL)
+    {
+        rt_free(flash_wr.sect_buf);
+    }
+    memset(&flash_wr, 0, sizeof(flash_wr));
+
+    return(ret);
+}
+
+#endif
+
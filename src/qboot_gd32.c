@@ -13,6 +13,7 @@
 #include <rtthread.h>
 #include <rtdevice.h>
 #include <qboot.h>
+#include <qboot_jump.h>
 
 //#define QBOOT_APP_RUN_IN_QSPI_FLASH
 //#define QBOOT_DEBUG
@@ -36,6 +37,99 @@
 
 #include <rtdbg.h>
 
+#if defined(QBOOT_USING_HW_CRC) && defined(CRC_CTL_REV_O)
+#include <qboot_crc.h>
+
+u32 qbt_crc32_cyc_cal(u32 crc, const u8 *buf, u32 len)
+{
+    u32 head = (4 - ((rt_ubase_t)buf & 0x03)) & 0x03;
+    u32 words;
+
+    if (head > len)
+    {
+        head = len;
+    }
+    crc = qbt_crc32_sw_cyc_cal(crc, buf, head);//unaligned head
+    buf += head;
+    len -= head;
+
+    words = len / 4;
+    if (words > 0)
+    {
+        const u32 *p = (const u32 *)buf;
+        rcu_periph_clock_enable(RCU_CRC);
+        qbt_jump_periph_mark(QBOOT_JUMP_PERIPH_CRC);
+        #ifdef CRC_POLY
+        CRC_POLY = 0x04C11DB7;
+        #endif
+        CRC_IDATA = __RBIT(crc);//reflected crc32: bit reversed init, word input reversed, output reversed
+        CRC_CTL = CRC_CTL_REV_I | CRC_CTL_REV_O | CRC_CTL_RST;
+        for (u32 i = 0; i < words; i++)
+        {
+            CRC_DATA = p[i];
+        }
+        crc = CRC_DATA;
+        buf += words * 4;
+        len -= words * 4;
+    }
+
+    return(qbt_crc32_sw_cyc_cal(crc, buf, len));//remain tail
+}
+#endif
+
+#if defined(QBOOT_USING_AES) && defined(QBOOT_USING_HW_AES) && defined(CAU_CTL_CAUEN)
+#include <qboot_aes.h>
+
+bool qbt_aes_hw_decrypt(int mode, const u8 *key, const u8 *iv, u8 *dst_buf, const u8 *src_buf, u32 len)
+{
+    cau_parameter_struct cau_parameter;
+    u8 key_buf[32];
+    u8 iv_buf[16];
+
+    rt_memcpy(key_buf, key, sizeof(key_buf));//the library takes writable buffers
+    rt_memcpy(iv_buf, iv, sizeof(iv_buf));
+    rcu_periph_clock_enable(RCU_CAU);
+    qbt_jump_periph_mark(QBOOT_JUMP_PERIPH_AES);
+    cau_deinit();
+    cau_struct_para_init(&cau_parameter);
+    cau_parameter.alg_dir = CAU_DECRYPT;
+    cau_parameter.key = key_buf;
+    cau_parameter.key_size = 256;
+    cau_parameter.iv = iv_buf;
+    cau_parameter.iv_size = sizeof(iv_buf);
+    cau_parameter.input = (u8 *)src_buf;
+    cau_parameter.in_length = len;
+    cau_parameter.output = dst_buf;
+
+    if (mode == QBOOT_AES_MODE_CTR)
+    {
+        return(cau_aes_ctr(&cau_parameter) == SUCCESS);//low 32 bits of counter are increased
+    }
+    return(cau_aes_cbc(&cau_parameter) == SUCCESS);
+}
+#endif
+
+#if defined(QBOOT_USING_STATS) && defined(DWT_CTRL_CYCCNTENA_Msk)
+#include <qboot_stats.h>
+
+u32 qbt_stats_cycle_get(void)
+{
+    if ((DWT->CTRL & DWT_CTRL_CYCCNTENA_Msk) == 0)
+    {
+        CoreDebug->DEMCR |= CoreDebug_DEMCR_TRCENA_Msk;
+        DWT->CYCCNT = 0;
+        DWT->CTRL |= DWT_CTRL_CYCCNTENA_Msk;
+        qbt_jump_periph_mark(QBOOT_JUMP_PERIPH_CYCCNT);
+    }
+    return(DWT->CYCCNT);
+}
+
+u32 qbt_stats_cycle_freq(void)
+{
+    return(SystemCoreClock);
+}
+#endif
+
 
 void hal_DeInit(void)
 {
@@ -176,11 +270,43 @@ void hal_DeInit(void)
     rcu_periph_reset_disable(RCU_IREFRST); 
 }
 
+#ifdef QBOOT_USING_FAST_JUMP
+#if defined(QBOOT_USING_HW_CRC) && defined(CRC_CTL_REV_O)
+static void qbt_crc_deinit(void)
+{
+    rcu_periph_reset_enable(RCU_CRCRST);
+    rcu_periph_reset_disable(RCU_CRCRST);
+    rcu_periph_clock_disable(RCU_CRC);
+}
+#endif
+
+#if defined(QBOOT_USING_AES) && defined(QBOOT_USING_HW_AES) && defined(CAU_CTL_CAUEN)
+static void qbt_aes_deinit(void)
+{
+    cau_deinit();//reset of cau
+    rcu_periph_clock_disable(RCU_CAU);
+}
+#endif
+
+static const qbt_jump_periph_t qbt_jump_periph_tab[] = {
+    #if defined(QBOOT_USING_HW_CRC) && defined(CRC_CTL_REV_O)
+    {QBOOT_JUMP_PERIPH_CRC, qbt_crc_deinit},
+    #endif
+    #if defined(QBOOT_USING_AES) && defined(QBOOT_USING_HW_AES) && defined(CAU_CTL_CAUEN)
+    {QBOOT_JUMP_PERIPH_AES, qbt_aes_deinit},
+    #endif
+    {QBOOT_JUMP_PERIPH_ALWAYS, RT_NULL},//end of table, it is never empty
+};
+
+static const qbt_jump_port_t qbt_jump_port = {
+    qbt_jump_periph_tab, sizeof(qbt_jump_periph_tab) / sizeof(qbt_jump_periph_tab[0]), hal_DeInit, rcu_deinit
+};
+#endif
 
 rt_weak void qbt_jump_to_app(void)
 {
    typedef void (*app_func_t)(void);
-    u32 app_addr = QBOOT_APP_ADDR;
+    u32 app_addr = qbt_app_addr_get();
     u32 stk_addr = *((__IO uint32_t *)app_addr);
     app_func_t app_func = (app_func_t)(*((__IO uint32_t *)(app_addr + 4)));
 
@@ -191,7 +317,13 @@ rt_weak void qbt_jump_to_app(void)
     }
 
     rt_kprintf("Jump to application running ... \n");
-    rt_thread_mdelay(200);
+    #ifdef QBOOT_USING_FAST_JUMP
+    qbt_jump_app_run(&qbt_jump_port, stk_addr, (u32)app_func);
+    #else
+    if (rt_thread_self() != RT_NULL)//not in early jump before the scheduler starts
+    {
+        rt_thread_mdelay(200);
+    }
 
     __disable_irq();
     hal_DeInit();
@@ -213,6 +345,7 @@ rt_weak void qbt_jump_to_app(void)
     __set_MSP(stk_addr);
 
     app_func();//Jump to application running
+    #endif
 
     LOG_E("Qboot jump to application fail.");
 }
@@ -5,9 +5,11 @@
  * Date           Author            Notes
  * 2020-07-08     qiyongzhong       first version
  * 2020-09-18     qiyongzhong       add deinit function
+ * 2026-10-14     qboot             allocate from the arena, configurable window
  */
 
 #include <qboot_gzip.h>
+#include <qboot_arena.h>
 
 #ifdef QBOOT_USING_GZIP
 
@@ -16,10 +18,22 @@
 
 static z_stream qbt_strm;
 
+static voidpf qbt_gzip_zalloc(voidpf opaque, uInt items, uInt size)
+{
+    return(qbt_arena_alloc(items * size));
+}
+
+static void qbt_gzip_zfree(voidpf opaque, voidpf ptr)
+{
+    qbt_arena_free(ptr);
+}
+
 void qbt_gzip_init(void)
 {
     memset((u8 *)&qbt_strm, 0, sizeof(qbt_strm));
-    inflateInit2(&qbt_strm, 47);
+    qbt_strm.zalloc = qbt_gzip_zalloc;//inflate state and window are carved from the arena
+    qbt_strm.zfree = qbt_gzip_zfree;
+    inflateInit2(&qbt_strm, 32 + QBOOT_GZIP_WINDOW_BITS);//32 for gzip header
 }
 
 void qbt_gzip_set_in(const u8 *in_buf, u32 in_size)
@@ -2,12 +2,12 @@
  * @file qboot_hpatchlite.c
  * @brief In-place OTA update implementation using HPatchLite.
  * @author huangly ()
- * @version 1.4
+ * @version 1.8
  * @date 2025-09-29
  * 
  * @copyright Copyright (c) 2025  
  * 
- * @note Supports both FLASH swap and RAM buffer strategies via Kconfig.
+ * @note Supports FLASH swap, RAM buffer and hybrid strategies via Kconfig.
  *       This implementation is designed for in-place updates where the old firmware
  *       partition is directly overwritten to become the new firmware partition.
  * 
@@ -17,6 +17,10 @@
  * 2025-09-26 1.1     huangly     Refactored to support both RAM and FLASH buffer strategies.
  * 2025-09-27 1.2     huangly     Refined with Kconfig integration, ULOG, Doxygen, and bug fixes.
  * 2025-09-29 1.4     huangly     Completed RAM buffer strategy based on user's unified logic.
+ * 2026-10-14 1.5     qboot       FLASH swap uses a sector-granular swap ring with pipelined commits.
+ * 2026-10-14 1.6     qboot       Hybrid strategy sizes the RAM buffer and caches by the free heap.
+ * 2026-10-14 1.7     qboot       Old data reads go through an aligned read cache, or the mapped view.
+ * 2026-10-14 1.8     qboot       Copy buffer and old data cache are carved from the qboot arena.
  */
 
 #include "qboot_hpatchlite.h"
@@ -27,12 +31,58 @@
 #ifdef QBOOT_USING_HPATCHLITE
 
 #include "hpatch_impl.h"
+#include <qboot_stats.h>
+#include <qboot_progress.h>
+#include <qboot_map.h>
+#include <qboot_arena.h>
 
 // Define ULOG tag and level
 #define DBG_TAG "qboot.hpatch"
 #define DBG_LVL DBG_INFO
 #include <rtdbg.h>
 
+// Read cache of the old partition
+#ifndef QBOOT_HPATCH_OLD_CACHE_SIZE
+#define QBOOT_HPATCH_OLD_CACHE_SIZE         1024        /**< Size of the old data read cache, 0 to read flash for every request */
+#endif
+#ifndef QBOOT_HPATCH_OLD_CACHE_ALIGN
+#define QBOOT_HPATCH_OLD_CACHE_ALIGN        256         /**< Alignment of the cache fills, the read unit of the old flash */
+#endif
+#ifndef QBOOT_HPATCH_OLD_READ_AHEAD
+#define QBOOT_HPATCH_OLD_READ_AHEAD         512         /**< Bytes read beyond a missed request */
+#endif
+
+// The hybrid strategy builds both buffer strategies and selects one at runtime
+#if defined(QBOOT_HPATCH_USE_HYBRID)
+#ifndef QBOOT_HPATCH_USE_FLASH_SWAP
+#define QBOOT_HPATCH_USE_FLASH_SWAP
+#endif
+#ifndef QBOOT_HPATCH_USE_RAM_BUFFER
+#define QBOOT_HPATCH_USE_RAM_BUFFER
+#endif
+#ifndef QBOOT_HPATCH_SWAP_PART_NAME
+#define QBOOT_HPATCH_SWAP_PART_NAME         "swap"
+#endif
+#ifndef QBOOT_HPATCH_SWAP_OFFSET
+#define QBOOT_HPATCH_SWAP_OFFSET            0
+#endif
+#ifndef QBOOT_HPATCH_COPY_BUFFER_SIZE
+#define QBOOT_HPATCH_COPY_BUFFER_SIZE       4096
+#endif
+#ifndef QBOOT_HPATCH_WINDOW_SIZE
+#define QBOOT_HPATCH_WINDOW_SIZE            0           /**< Read-after-write window of the patch, RAM smaller than it spills to swap, at least a sector */
+#endif
+#ifndef QBOOT_HPATCH_RAM_BUFFER_MAX_SIZE
+#define QBOOT_HPATCH_RAM_BUFFER_MAX_SIZE    (512 * 1024)/**< Upper limit of the RAM buffer taken from the heap */
+#endif
+#ifndef QBOOT_HPATCH_CACHE_MAX_SIZE
+#define QBOOT_HPATCH_CACHE_MAX_SIZE         8192        /**< Upper limit of the patch and decompress caches */
+#endif
+#ifndef QBOOT_HPATCH_HEAP_RESERVE_SIZE
+#define QBOOT_HPATCH_HEAP_RESERVE_SIZE      (8 * 1024)  /**< Heap kept for the others while patching */
+#endif
+#endif
+
 /**
  * @brief Instance structure to hold state during the patching process.
  *        Conditionally includes members based on the selected buffer strategy.
@@ -45,7 +95,6 @@ typedef struct hpatchi_instance_t
     int patch_read_pos;                     /**< Current read position within the patch data stream */
     int newer_file_len;                     /**< Expected final length of the new firmware */
     int newer_write_pos;                    /**< Logical current write position in the new firmware */
-    int progress_percent;                   /**< Last reported progress percentage to avoid duplicate logs */
 
     const fal_partition_t patch_part;       /**< FAL partition handle for the patch data */
     const fal_partition_t old_part;         /**< FAL partition handle for the old firmware (the one being updated) */
@@ -54,16 +103,29 @@ typedef struct hpatchi_instance_t
     // --- Members for FLASH swap strategy ---
     fal_partition_t swap_part;              /**< FAL partition handle for the swap buffer */
     int swap_offset;                        /**< Starting offset of the usable area within the swap partition */
-    int swap_write_pos;                     /**< Current write position within the swap buffer area */
-    int swap_size;                          /**< Total usable size of the swap buffer area */
-#elif defined(QBOOT_HPATCH_USE_RAM_BUFFER)
+    int swap_write_pos;                     /**< Logical position of the next new byte written into the swap ring */
+    int swap_size;                          /**< Total usable size of the swap ring, a multiple of slot_size */
+    int slot_size;                          /**< Size of a ring slot, the larger sector of the swap and old partitions */
+    int slot_num;                           /**< Number of slots in the swap ring */
+    uint8_t *copy_buffer;                   /**< RAM buffer for swap-to-old copy, allocated once per patch session */
+#endif
+#if defined(QBOOT_HPATCH_USE_RAM_BUFFER)
     // --- Members for RAM buffer strategy ---
     uint8_t *swap_buffer;                   /**< Pointer to the RAM buffer */
     int swap_buffer_size;                   /**< Size of the RAM buffer */
-    int swap_write_pos;                     /**< Current write position within the RAM buffer */
+    int swap_buffer_pos;                    /**< Current write position within the RAM buffer */
 #endif
     int committed_len;                      /**< Total length of data already committed from RAM/Flash to the old partition */
 
+#if defined(QBOOT_USING_MAPPED_READ)
+    const uint8_t *old_mapped;              /**< Mapped view of the old partition, RT_NULL if it is read through FAL */
+#endif
+#if (QBOOT_HPATCH_OLD_CACHE_SIZE > 0)
+    uint8_t *old_cache;                     /**< Read cache of the old partition, RT_NULL to read flash directly */
+    int old_cache_addr;                     /**< Old partition address of the cached data */
+    int old_cache_len;                      /**< Length of the cached data, 0 if the cache is empty */
+#endif
+
 } hpatchi_instance_t;
 
 
@@ -123,117 +185,220 @@ static hpi_BOOL _do_read_patch(hpi_TInputStreamHandle input_stream, hpi_byte *da
 static hpi_BOOL _do_read_old(struct hpatchi_listener_t *listener, hpi_pos_t addr, hpi_byte *data, hpi_size_t size)
 {
     hpatchi_instance_t *instance = (hpatchi_instance_t *)listener;
+#if defined(QBOOT_USING_MAPPED_READ)
+    if (instance->old_mapped)
+    {
+        if (addr + size > instance->old_part->len)
+            return hpi_FALSE;
+        rt_memcpy(data, instance->old_mapped + addr, size);
+        return hpi_TRUE;
+    }
+#endif
+#if (QBOOT_HPATCH_OLD_CACHE_SIZE > 0)
+    int pos = (int)addr, len = (int)size;
+
+    if (instance->old_cache && (len <= QBOOT_HPATCH_OLD_CACHE_SIZE))
+    {
+        if ((pos < instance->old_cache_addr) || (pos + len > instance->old_cache_addr + instance->old_cache_len))
+        {
+            // Refill from the aligned address before the request, with read-ahead after it
+            int fill_addr = pos - (pos % QBOOT_HPATCH_OLD_CACHE_ALIGN);
+            int fill_len = pos + len + QBOOT_HPATCH_OLD_READ_AHEAD - fill_addr;
+
+            if (fill_len > QBOOT_HPATCH_OLD_CACHE_SIZE)
+                fill_len = QBOOT_HPATCH_OLD_CACHE_SIZE;
+            if (fill_len > instance->old_part->len - fill_addr)
+                fill_len = instance->old_part->len - fill_addr;
+            if (fill_len < pos + len - fill_addr)
+            {
+                fill_addr = pos;//the aligned fill can not hold the request
+                fill_len = len;
+            }
+            instance->old_cache_len = 0;
+            if (fal_partition_read(instance->old_part, fill_addr, instance->old_cache, fill_len) < 0)
+                return hpi_FALSE;
+            instance->old_cache_addr = fill_addr;
+            instance->old_cache_len = fill_len;
+        }
+        rt_memcpy(data, instance->old_cache + (pos - instance->old_cache_addr), len);
+        return hpi_TRUE;
+    }
+#endif
     return (fal_partition_read(instance->old_part, addr, data, size) >= 0);
 }
 
+/**
+ * @brief Drops the cached old data of a range of the old partition before it is erased or written.
+ * @param instance Pointer to the patch instance.
+ * @param addr     Start address of the range in the old partition.
+ * @param size     Size of the range.
+ */
+static void _old_cache_invalidate(hpatchi_instance_t *instance, int addr, int size)
+{
+#if (QBOOT_HPATCH_OLD_CACHE_SIZE > 0)
+    if ((addr < instance->old_cache_addr + instance->old_cache_len) && (instance->old_cache_addr < addr + size))
+        instance->old_cache_len = 0;
+#endif
+}
+
+/**
+ * @brief Prepares the old data reads, takes the mapped view of the old partition or allocates its read cache.
+ * @param instance Pointer to the patch instance.
+ */
+static void _old_read_init(hpatchi_instance_t *instance)
+{
+#if defined(QBOOT_USING_MAPPED_READ)
+    instance->old_mapped = qbt_map_view(instance->old_part, 0, RT_NULL);
+    if (instance->old_mapped)
+    {
+        LOG_D("Old data are read from the mapped view of '%s'.", instance->old_part->name);
+        return;
+    }
+#endif
+#if (QBOOT_HPATCH_OLD_CACHE_SIZE > 0)
+    instance->old_cache = qbt_arena_alloc(QBOOT_HPATCH_OLD_CACHE_SIZE);
+    instance->old_cache_len = 0;
+    if (!instance->old_cache)
+        LOG_W("Failed to malloc %d bytes for old data cache, read flash directly.", QBOOT_HPATCH_OLD_CACHE_SIZE);
+#endif
+}
+
+/**
+ * @brief Releases the resources of the old data reads.
+ * @param instance Pointer to the patch instance.
+ */
+static void _old_read_deinit(hpatchi_instance_t *instance)
+{
+#if (QBOOT_HPATCH_OLD_CACHE_SIZE > 0)
+    if (instance->old_cache)
+        qbt_arena_free(instance->old_cache);
+    instance->old_cache = RT_NULL;
+#endif
+}
+
 
 // -----------------------------------------------------------------------------
 // FLASH Swap Strategy Implementation
 // -----------------------------------------------------------------------------
 #if defined(QBOOT_HPATCH_USE_FLASH_SWAP)
 
+/*
+ * The swap area is a ring of slots, a slot is the larger erase unit of the swap and old partitions.
+ * New data are written into the slot at the head, a swap slot is erased only just before it is reused.
+ * While the last free slot is filling, the oldest full slot is copied into the old partition at the same
+ * rate, so it is free when the head reaches it and no commit stalls the patch for a whole swap area.
+ * Old data are never overwritten before the new data at the same position are written, as before.
+ */
+
 /**
- * @brief Copies data from one FAL partition to another using a temporary RAM buffer.
- * @param src_part      Source partition handle.
- * @param src_offset    Starting offset in the source partition.
- * @param dst_part      Destination partition handle.
- * @param dst_offset    Starting offset in the destination partition.
- * @param size          Total number of bytes to copy.
- * @return 0 on success, non-zero on failure.
+ * @brief Gets the address in the swap partition of a logical position of the new data.
+ * @param instance Pointer to the patch instance.
+ * @param pos      Logical position in the new firmware.
+ * @return Address of the position in the swap partition.
  */
-static int flash_to_flash_copy(const fal_partition_t src_part, int src_offset,
-                               const fal_partition_t dst_part, int dst_offset, int size)
+static int _ring_swap_addr(const hpatchi_instance_t *instance, int pos)
 {
-    uint8_t *buffer = RT_NULL;
-    int result = 0;
-    int remaining_len = size;
-    int current_src_offset = src_offset;
-    int current_dst_offset = dst_offset;
+    return instance->swap_offset + ((pos / instance->slot_size) % instance->slot_num) * instance->slot_size + (pos % instance->slot_size);
+}
 
-    buffer = rt_malloc(QBOOT_HPATCH_COPY_BUFFER_SIZE);
-    if (buffer == RT_NULL)
+/**
+ * @brief Copies the buffered new data from the swap ring to the old partition.
+ *        The target slot of the old partition is erased when its first byte is copied.
+ * @param instance Pointer to the patch instance.
+ * @param end      Logical position the new data are copied up to.
+ * @param budget   Maximum bytes copied by this call.
+ * @return hpi_TRUE on success, hpi_FALSE on failure.
+ */
+static hpi_BOOL _ring_copy(hpatchi_instance_t *instance, int end, int budget)
+{
+    while ((instance->committed_len < end) && (budget > 0))
     {
-        LOG_E("Failed to malloc %d bytes for flash copy buffer!", QBOOT_HPATCH_COPY_BUFFER_SIZE);
-        return -1;
-    }
-
-    LOG_D("Starting flash-to-flash copy of %d bytes...", size);
+        int ofs = instance->committed_len % instance->slot_size;
+        int chunk_size = instance->slot_size - ofs;
 
-    while (remaining_len > 0)
-    {
-        int chunk_size = (remaining_len > QBOOT_HPATCH_COPY_BUFFER_SIZE) ? QBOOT_HPATCH_COPY_BUFFER_SIZE : remaining_len;
+        if (chunk_size > end - instance->committed_len)
+            chunk_size = end - instance->committed_len;
+        if (chunk_size > budget)
+            chunk_size = budget;
+        if (chunk_size > QBOOT_HPATCH_COPY_BUFFER_SIZE)
+            chunk_size = QBOOT_HPATCH_COPY_BUFFER_SIZE;
 
-        if (fal_partition_read(src_part, current_src_offset, buffer, chunk_size) < 0)
+        if (ofs == 0)
         {
-            LOG_E("Flash copy failed at read step from '%s'!", src_part->name);
-            result = -1;
-            break;
+            int erase_size = instance->slot_size;
+            if (erase_size > instance->old_part->len - instance->committed_len)
+                erase_size = instance->old_part->len - instance->committed_len;
+            LOG_D("Erasing '%s' partition from offset %d...", instance->old_part->name, instance->committed_len);
+            _old_cache_invalidate(instance, instance->committed_len, erase_size);
+            if (fal_partition_erase(instance->old_part, instance->committed_len, erase_size) < 0)
+            {
+                LOG_E("Failed to erase '%s' partition at offset %d.", instance->old_part->name, instance->committed_len);
+                return hpi_FALSE;
+            }
         }
 
-        if (fal_partition_write(dst_part, current_dst_offset, buffer, chunk_size) < 0)
+        if (fal_partition_read(instance->swap_part, _ring_swap_addr(instance, instance->committed_len), instance->copy_buffer, chunk_size) < 0)
         {
-            LOG_E("Flash copy failed at write step to '%s'!", dst_part->name);
-            result = -2;
-            break;
+            LOG_E("Flash copy failed at read step from '%s'!", instance->swap_part->name);
+            return hpi_FALSE;
+        }
+        _old_cache_invalidate(instance, instance->committed_len, chunk_size);
+        if (fal_partition_write(instance->old_part, instance->committed_len, instance->copy_buffer, chunk_size) < 0)
+        {
+            LOG_E("Flash copy failed at write step to '%s'!", instance->old_part->name);
+            return hpi_FALSE;
         }
 
-        current_src_offset += chunk_size;
-        current_dst_offset += chunk_size;
-        remaining_len -= chunk_size;
+        instance->committed_len += chunk_size;
+        budget -= chunk_size;
     }
+    return hpi_TRUE;
+}
 
-    rt_free(buffer);
+/**
+ * @brief Makes the slot the head enters ready for new data.
+ *        The data it holds are copied to the old partition first, then the swap slot is erased.
+ * @param instance Pointer to the patch instance.
+ * @return hpi_TRUE on success, hpi_FALSE on failure.
+ */
+static hpi_BOOL _ring_slot_reuse(hpatchi_instance_t *instance)
+{
+    int occupant_end = instance->swap_write_pos - instance->swap_size + instance->slot_size;
 
-    if (result == 0)
+    if (!_ring_copy(instance, occupant_end, occupant_end))
+        return hpi_FALSE;
+
+    if (fal_partition_erase(instance->swap_part, _ring_swap_addr(instance, instance->swap_write_pos), instance->slot_size) < 0)
     {
-        LOG_D("Flash copy successful.");
+        LOG_E("Failed to erase swap partition at offset %d.", _ring_swap_addr(instance, instance->swap_write_pos));
+        return hpi_FALSE;
     }
-    return result;
+    return hpi_TRUE;
 }
 
 /**
- * @brief Commits the buffered data from the swap partition to the old partition.
- *        This involves erasing the target area on the old partition, copying data,
- *        and then erasing the swap partition for the next round.
+ * @brief Commits all the buffered data from the swap ring to the old partition.
  * @param instance Pointer to the patch instance.
  * @return hpi_TRUE on success, hpi_FALSE on failure.
  */
 static hpi_BOOL _commit_swap_to_old_flash(hpatchi_instance_t *instance)
 {
-    if (instance->swap_write_pos == 0)
+    if (instance->committed_len == instance->swap_write_pos)
         return hpi_TRUE;
 
-    LOG_I("\nCommitting %d bytes from swap to '%s' partition...", instance->swap_write_pos, instance->old_part->name);
-
-    LOG_D("Erasing '%s' partition from offset %d...", instance->old_part->name, instance->committed_len);
-    if (fal_partition_erase(instance->old_part, instance->committed_len, instance->swap_write_pos) < 0)
-    {
-        LOG_E("Failed to erase '%s' partition at offset %d.", instance->old_part->name, instance->committed_len);
-        return hpi_FALSE;
-    }
-
-    if (flash_to_flash_copy(instance->swap_part, instance->swap_offset, instance->old_part, instance->committed_len, instance->swap_write_pos) < 0)
+    LOG_D("Committing %d bytes from swap to '%s' partition...", instance->swap_write_pos - instance->committed_len, instance->old_part->name);
+    if (!_ring_copy(instance, instance->swap_write_pos, instance->swap_write_pos))
     {
         LOG_E("Failed to copy from swap to '%s' partition.", instance->old_part->name);
         return hpi_FALSE;
     }
-
-    LOG_D("Erasing swap partition for next round...");
-    if (fal_partition_erase(instance->swap_part, instance->swap_offset, instance->swap_size) < 0)
-    {
-        LOG_W("Failed to erase swap partition, may affect next write cycle.");
-        return hpi_FALSE;
-    }
-
-    instance->committed_len += instance->swap_write_pos;
-    instance->swap_write_pos = 0;
-    LOG_I("\nCommit successful. Total committed: %d bytes.", instance->committed_len);
+    LOG_D("Commit successful. Total committed: %d bytes.", instance->committed_len);
     return hpi_TRUE;
 }
 
 /**
- * @brief HPatchLite listener: Writes new data by buffering it in the swap partition.
- *        Triggers a commit when the buffer is full.
+ * @brief HPatchLite listener: Writes new data into the head slot of the swap ring.
+ *        The oldest full slot is copied to the old partition as much as the data written.
  * @param listener  Pointer to the listener instance.
  * @param data      Pointer to the new data to be written.
  * @param size      Size of the new data.
@@ -248,44 +413,83 @@ static hpi_BOOL _do_write_new_flash(struct hpatchi_listener_t *listener, const h
     // The amount of data written at one time may be very large, requiring processing in loops.
     while (remain_size > 0)
     {
-        // Calculate the remaining space of the swap partition
-        int swap_free_space = instance->swap_size - instance->swap_write_pos;
-        // First, fill up the swap partition.
-        if (swap_free_space < remain_size)
-        {
-            if (swap_free_space > 0)
-            {
-                if (fal_partition_write(instance->swap_part, instance->swap_offset + instance->swap_write_pos, (const uint8_t *)data_cur, swap_free_space) < 0)
-                    return hpi_FALSE;
-                instance->swap_write_pos += swap_free_space;
-                data_cur += swap_free_space;
-                remain_size -= swap_free_space;
-            }
-            //Execute submit operation
-            if (!_commit_swap_to_old_flash(instance))
-                return hpi_FALSE;
-        }
-        else
-        {
-            // Write all remaining data (which could be all the data or just a truncated portion) directly to the swap partition
-            if (remain_size > 0)
-            {
-                if (fal_partition_write(instance->swap_part, instance->swap_offset + instance->swap_write_pos, (const uint8_t *)data_cur, remain_size) < 0)
-                    return hpi_FALSE;
-                instance->swap_write_pos += remain_size;
-            }
-            break;
-        }
+        int ofs = instance->swap_write_pos % instance->slot_size;
+        int head_start = instance->swap_write_pos - ofs;
+        int write_len = instance->slot_size - ofs;
+        int copy_end;
+
+        if (write_len > remain_size)
+            write_len = remain_size;
+
+        // The head enters a new slot
+        if ((ofs == 0) && !_ring_slot_reuse(instance))
+            return hpi_FALSE;
+
+        if (fal_partition_write(instance->swap_part, _ring_swap_addr(instance, instance->swap_write_pos), (const uint8_t *)data_cur, write_len) < 0)
+            return hpi_FALSE;
+        instance->swap_write_pos += write_len;
+        data_cur += write_len;
+        remain_size -= write_len;
+
+        // Copy the slot the head will enter next while this one fills
+        copy_end = head_start - instance->swap_size + 2 * instance->slot_size;
+        if (copy_end > head_start)
+            copy_end = head_start;
+        if (!_ring_copy(instance, copy_end, write_len))
+            return hpi_FALSE;
     }
 
     instance->newer_write_pos += size;
 
-    int percent = instance->newer_write_pos * 100 / instance->newer_file_len;
-    if (percent != instance->progress_percent && (percent % 5 == 0))
+    qbt_prog_update(instance->newer_write_pos);
+    return hpi_TRUE;
+}
+
+/**
+ * @brief Initializes the swap ring for a patch session.
+ *        The slot is the larger sector of the swap and old partitions, the copy buffer is allocated once.
+ * @param instance Pointer to the patch instance.
+ * @return hpi_TRUE on success, hpi_FALSE on failure.
+ */
+static hpi_BOOL _ring_init(hpatchi_instance_t *instance)
+{
+    const struct fal_flash_dev *swap_dev;
+    const struct fal_flash_dev *old_dev;
+    int small_size;
+
+    instance->swap_part = (fal_partition_t)fal_partition_find(QBOOT_HPATCH_SWAP_PART_NAME);
+    if (!instance->swap_part)
+    {
+        LOG_E("Swap partition '%s' not found!", QBOOT_HPATCH_SWAP_PART_NAME);
+        return hpi_FALSE;
+    }
+    swap_dev = fal_flash_device_find(instance->swap_part->flash_name);
+    old_dev = fal_flash_device_find(instance->old_part->flash_name);
+    if (!swap_dev || !old_dev || (swap_dev->blk_size == 0) || (old_dev->blk_size == 0))
     {
-        rt_kprintf("\rBuffering... %3d%%", percent);
-        instance->progress_percent = percent;
+        LOG_E("Unknown sector size of '%s' or '%s'!", instance->swap_part->name, instance->old_part->name);
+        return hpi_FALSE;
     }
+    instance->slot_size = (swap_dev->blk_size > old_dev->blk_size) ? swap_dev->blk_size : old_dev->blk_size;
+    small_size = (swap_dev->blk_size > old_dev->blk_size) ? old_dev->blk_size : swap_dev->blk_size;
+    instance->swap_offset = QBOOT_HPATCH_SWAP_OFFSET;
+    instance->slot_num = (instance->swap_part->len - instance->swap_offset) / instance->slot_size;
+    instance->swap_size = instance->slot_num * instance->slot_size;
+    if ((instance->slot_size % small_size != 0) || (instance->slot_num == 0) || ((instance->swap_part->offset + instance->swap_offset) % swap_dev->blk_size != 0))
+    {
+        LOG_E("Swap area of '%s' must be aligned to and hold a sector of %d bytes!", instance->swap_part->name, instance->slot_size);
+        return hpi_FALSE;
+    }
+
+    instance->copy_buffer = qbt_arena_alloc(QBOOT_HPATCH_COPY_BUFFER_SIZE);
+    if (instance->copy_buffer == RT_NULL)
+    {
+        LOG_E("Failed to malloc %d bytes for flash copy buffer!", QBOOT_HPATCH_COPY_BUFFER_SIZE);
+        return hpi_FALSE;
+    }
+    instance->swap_write_pos = 0;
+    instance->committed_len = 0;
+    LOG_I("HPatchLite: swap ring of %d slots, %d bytes each.", instance->slot_num, instance->slot_size);
     return hpi_TRUE;
 }
 
@@ -305,30 +509,31 @@ static hpi_BOOL _do_write_new_flash(struct hpatchi_listener_t *listener, const h
  */
 static hpi_BOOL _commit_ram_to_old(hpatchi_instance_t *instance)
 {
-    if (instance->swap_write_pos == 0)
+    if (instance->swap_buffer_pos == 0)
         return hpi_TRUE;
 
-    LOG_I("\nCommitting %d bytes from RAM buffer to '%s' partition...", instance->swap_write_pos, instance->old_part->name);
+    LOG_D("Committing %d bytes from RAM buffer to '%s' partition...", instance->swap_buffer_pos, instance->old_part->name);
 
     // 1. Erase the target area on the old partition
     LOG_D("Erasing '%s' partition from offset %d...", instance->old_part->name, instance->committed_len);
-    if (fal_partition_erase(instance->old_part, instance->committed_len, instance->swap_write_pos) < 0)
+    _old_cache_invalidate(instance, instance->committed_len, instance->swap_buffer_pos);
+    if (fal_partition_erase(instance->old_part, instance->committed_len, instance->swap_buffer_pos) < 0)
     {
         LOG_E("Failed to erase '%s' partition at offset %d.", instance->old_part->name, instance->committed_len);
         return hpi_FALSE;
     }
 
     // 2. Write the entire RAM buffer content to the erased area
-    if (fal_partition_write(instance->old_part, instance->committed_len, instance->swap_buffer, instance->swap_write_pos) < 0)
+    if (fal_partition_write(instance->old_part, instance->committed_len, instance->swap_buffer, instance->swap_buffer_pos) < 0)
     {
         LOG_E("Failed to write from RAM buffer to '%s' partition.", instance->old_part->name);
         return hpi_FALSE;
     }
 
     // 3. Update state: only reset the write position, no need to clear RAM
-    instance->committed_len += instance->swap_write_pos;
-    instance->swap_write_pos = 0;
-    LOG_I("\nCommit successful. Total committed: %d bytes.", instance->committed_len);
+    instance->committed_len += instance->swap_buffer_pos;
+    instance->swap_buffer_pos = 0;
+    LOG_D("Commit successful. Total committed: %d bytes.", instance->committed_len);
     return hpi_TRUE;
 }
 
@@ -348,13 +553,13 @@ static hpi_BOOL _do_write_new_ram(struct hpatchi_listener_t *listener, const hpi
 
     while (remain_size > 0)
     {
-        int swap_free_space = instance->swap_buffer_size - instance->swap_write_pos;
+        int swap_free_space = instance->swap_buffer_size - instance->swap_buffer_pos;
         if (swap_free_space < remain_size)
         {
             if (swap_free_space > 0)
             {
-                rt_memcpy(instance->swap_buffer + instance->swap_write_pos, data_cur, swap_free_space);
-                instance->swap_write_pos += swap_free_space;
+                rt_memcpy(instance->swap_buffer + instance->swap_buffer_pos, data_cur, swap_free_space);
+                instance->swap_buffer_pos += swap_free_space;
                 data_cur += swap_free_space;
                 remain_size -= swap_free_space;
             }
@@ -365,8 +570,8 @@ static hpi_BOOL _do_write_new_ram(struct hpatchi_listener_t *listener, const hpi
         {
             if (remain_size > 0)
             {
-                rt_memcpy(instance->swap_buffer + instance->swap_write_pos, data_cur, remain_size);
-                instance->swap_write_pos += remain_size;
+                rt_memcpy(instance->swap_buffer + instance->swap_buffer_pos, data_cur, remain_size);
+                instance->swap_buffer_pos += remain_size;
             }
             break;
         }
@@ -374,18 +579,168 @@ static hpi_BOOL _do_write_new_ram(struct hpatchi_listener_t *listener, const hpi
 
     instance->newer_write_pos += size;
 
-    int percent = instance->newer_write_pos * 100 / instance->newer_file_len;
-    if (percent != instance->progress_percent && (percent % 5 == 0))
-    {
-        rt_kprintf("\rBuffering... %3d%%", percent);
-        instance->progress_percent = percent;
-    }
+    qbt_prog_update(instance->newer_write_pos);
     return hpi_TRUE;
 }
 
 #endif // QBOOT_HPATCH_USE_RAM_BUFFER
 
 
+// -----------------------------------------------------------------------------
+// Buffer Strategy Sessions
+// -----------------------------------------------------------------------------
+#if defined(QBOOT_HPATCH_USE_FLASH_SWAP)
+/**
+ * @brief Runs the patch with the swap ring as the buffer of new data.
+ * @param instance              Pointer to the patch instance.
+ * @param patch_cache_size      Cache size of the patch stream.
+ * @param decompress_cache_size Cache size of the decompressor.
+ * @return Result of the patch.
+ */
+static hpi_patch_result_t _patch_with_flash_swap(hpatchi_instance_t *instance, int patch_cache_size, int decompress_cache_size)
+{
+    hpi_patch_result_t result;
+
+    if (!_ring_init(instance))
+    {
+        LOG_E("Failed to initialize swap ring! OTA aborted.");
+        return HPATCHI_PATCH_ERROR;
+    }
+
+    result = hpi_patch(&instance->parent, patch_cache_size, decompress_cache_size, _do_read_patch, _do_read_old, _do_write_new_flash);
+
+    if (result == HPATCHI_SUCCESS && instance->swap_write_pos > 0)
+    {
+        if (!_commit_swap_to_old_flash(instance))
+            result = HPATCHI_PATCH_ERROR;
+    }
+    qbt_arena_free(instance->copy_buffer);
+    instance->copy_buffer = RT_NULL;
+    return result;
+}
+#endif
+
+#if defined(QBOOT_HPATCH_USE_RAM_BUFFER)
+/**
+ * @brief Runs the patch with a RAM buffer of new data.
+ * @param instance              Pointer to the patch instance.
+ * @param buffer                RAM buffer, its size is a multiple of the sector size of the old partition.
+ * @param buffer_size           Size of the RAM buffer.
+ * @param patch_cache_size      Cache size of the patch stream.
+ * @param decompress_cache_size Cache size of the decompressor.
+ * @return Result of the patch.
+ */
+static hpi_patch_result_t _patch_with_ram(hpatchi_instance_t *instance, uint8_t *buffer, int buffer_size, int patch_cache_size, int decompress_cache_size)
+{
+    hpi_patch_result_t result;
+
+    instance->swap_buffer = buffer;
+    instance->swap_buffer_size = buffer_size;
+    instance->swap_buffer_pos = 0;
+    instance->committed_len = 0;
+
+    result = hpi_patch(&instance->parent, patch_cache_size, decompress_cache_size, _do_read_patch, _do_read_old, _do_write_new_ram);
+
+    // After the patch loop, commit the last data block in RAM if it exists
+    if (result == HPATCHI_SUCCESS && instance->swap_buffer_pos > 0)
+    {
+        if (!_commit_ram_to_old(instance))
+        {
+            result = HPATCHI_PATCH_ERROR;
+        }
+    }
+    instance->swap_buffer = RT_NULL;
+    return result;
+}
+#endif
+
+#if defined(QBOOT_HPATCH_USE_HYBRID)
+/**
+ * @brief Gets the free heap size.
+ * @return Free bytes of the heap.
+ */
+static int _hybrid_heap_free(void)
+{
+    rt_size_t total = 0, used = 0, max_used = 0;
+
+    rt_memory_info(&total, &used, &max_used);
+    return (total > used) ? (int)(total - used) : 0;
+}
+
+/**
+ * @brief Scales a cache size with the free heap.
+ *        The configured size is doubled while the cache takes at most 1/32 of the free heap.
+ * @param base_size Configured cache size.
+ * @param heap_free Free bytes of the heap.
+ * @return Cache size to be used.
+ */
+static int _hybrid_cache_size(int base_size, int heap_free)
+{
+    int size = base_size;
+
+    while ((size * 2 <= QBOOT_HPATCH_CACHE_MAX_SIZE) && (size * 2 * 32 <= heap_free))
+    {
+        size *= 2;
+    }
+    return size;
+}
+
+/**
+ * @brief Runs the patch with the largest RAM buffer the heap gives.
+ *        The swap ring is used only when the RAM buffer can not hold the read-after-write window.
+ * @param instance Pointer to the patch instance.
+ * @return Result of the patch.
+ */
+static hpi_patch_result_t _patch_hybrid(hpatchi_instance_t *instance)
+{
+    const struct fal_flash_dev *old_dev = fal_flash_device_find(instance->old_part->flash_name);
+    int heap_free = _hybrid_heap_free();
+    int patch_cache_size = _hybrid_cache_size(QBOOT_HPATCH_PATCH_CACHE_SIZE, heap_free);
+    int decompress_cache_size = _hybrid_cache_size(QBOOT_HPATCH_DECOMPRESS_CACHE_SIZE, heap_free);
+    int sector_size, window_size, buffer_size, image_size;
+    uint8_t *buffer = RT_NULL;
+    hpi_patch_result_t result;
+
+    if (!old_dev || (old_dev->blk_size == 0))
+    {
+        LOG_E("Unknown sector size of '%s'!", instance->old_part->name);
+        return HPATCHI_PATCH_ERROR;
+    }
+    sector_size = old_dev->blk_size;
+    window_size = (QBOOT_HPATCH_WINDOW_SIZE > sector_size) ? QBOOT_HPATCH_WINDOW_SIZE : sector_size;
+    window_size = (window_size + sector_size - 1) / sector_size * sector_size;
+    image_size = (instance->newer_file_len + sector_size - 1) / sector_size * sector_size;
+
+    // RAM buffer must be a multiple of the sector, no more than the new image needs
+    buffer_size = heap_free - patch_cache_size - decompress_cache_size - QBOOT_HPATCH_HEAP_RESERVE_SIZE;
+    if (buffer_size > QBOOT_HPATCH_RAM_BUFFER_MAX_SIZE)
+        buffer_size = QBOOT_HPATCH_RAM_BUFFER_MAX_SIZE;
+    if (buffer_size > image_size)
+        buffer_size = image_size;
+    buffer_size -= buffer_size % sector_size;
+    while (buffer_size >= window_size)
+    {
+        buffer = rt_malloc(buffer_size);
+        if (buffer)
+            break;
+        buffer_size /= 2;//heap is fragmented
+        buffer_size -= buffer_size % sector_size;
+    }
+
+    if (buffer)
+    {
+        LOG_I("HPatchLite: Using RAM buffer of %d bytes, caches %d/%d bytes.", buffer_size, patch_cache_size, decompress_cache_size);
+        result = _patch_with_ram(instance, buffer, buffer_size, patch_cache_size, decompress_cache_size);
+        rt_free(buffer);
+        return result;
+    }
+
+    LOG_I("HPatchLite: RAM is less than the window of %d bytes, using FLASH swap strategy, caches %d/%d bytes.", window_size, patch_cache_size, decompress_cache_size);
+    return _patch_with_flash_swap(instance, patch_cache_size, decompress_cache_size);
+}
+#endif
+
+
 // -----------------------------------------------------------------------------
 // Main Public Function
 // -----------------------------------------------------------------------------
@@ -394,7 +749,7 @@ static hpi_BOOL _do_write_new_ram(struct hpatchi_listener_t *listener, const hpi
  * @brief Performs an in-place differential update from a patch package.
  * 
  * This function orchestrates the entire patch process. It initializes the appropriate
- * buffer strategy (Flash or RAM), invokes the HPatchLite library, and handles
+ * buffer strategy (Flash, RAM or hybrid), invokes the HPatchLite library, and handles
  * the finalization steps like committing the last block and erasing tail data.
  * 
  * @param patch_part        FAL partition containing the patch data.
@@ -412,62 +767,35 @@ int qbt_hpatchlite_release_from_part(const fal_partition_t patch_part, const fal
         .patch_file_offset = patch_file_offset,
         .patch_file_len = patch_file_len,
         .newer_file_len = newer_file_len,
-        .progress_percent = -1,
     };
     hpi_patch_result_t result = HPATCHI_PATCH_ERROR;
+#if defined(QBOOT_HPATCH_USE_RAM_BUFFER) && !defined(QBOOT_HPATCH_USE_HYBRID)
+    uint8_t *buffer = RT_NULL;
+#endif
 
-#if defined(QBOOT_HPATCH_USE_FLASH_SWAP)
-    LOG_I("HPatchLite: Using FLASH swap strategy.");
-    instance.swap_part = (fal_partition_t)fal_partition_find(QBOOT_HPATCH_SWAP_PART_NAME);
-    if (!instance.swap_part)
-    {
-        LOG_E("Swap partition '%s' not found!", QBOOT_HPATCH_SWAP_PART_NAME);
-        return -1;
-    }
-    instance.swap_offset = QBOOT_HPATCH_SWAP_OFFSET;
-    instance.swap_size = instance.swap_part->len - instance.swap_offset;
-
-    LOG_I("Erasing swap area (size: %d) before use...", instance.swap_size);
-    if (fal_partition_erase(instance.swap_part, instance.swap_offset, instance.swap_size) < 0)
-    {
-        LOG_E("Failed to erase swap partition! OTA aborted.");
-        return -1;
-    }
-
-    result = hpi_patch(&instance.parent, QBOOT_HPATCH_PATCH_CACHE_SIZE, QBOOT_HPATCH_DECOMPRESS_CACHE_SIZE, _do_read_patch, _do_read_old, _do_write_new_flash);
+    _old_read_init(&instance);
 
-    if (result == HPATCHI_SUCCESS && instance.swap_write_pos > 0)
-    {
-        if (!_commit_swap_to_old_flash(&instance))
-            result = HPATCHI_PATCH_ERROR;
-    }
+#if defined(QBOOT_HPATCH_USE_HYBRID)
+    result = _patch_hybrid(&instance);
+#elif defined(QBOOT_HPATCH_USE_FLASH_SWAP)
+    LOG_I("HPatchLite: Using FLASH swap strategy.");
+    result = _patch_with_flash_swap(&instance, QBOOT_HPATCH_PATCH_CACHE_SIZE, QBOOT_HPATCH_DECOMPRESS_CACHE_SIZE);
 #elif defined(QBOOT_HPATCH_USE_RAM_BUFFER)
     LOG_I("HPatchLite: Using RAM buffer strategy.");
-    instance.swap_buffer_size = QBOOT_HPATCH_RAM_BUFFER_SIZE;
-    instance.swap_buffer = rt_malloc(instance.swap_buffer_size);
-    if (!instance.swap_buffer)
+    buffer = rt_malloc(QBOOT_HPATCH_RAM_BUFFER_SIZE);
+    if (!buffer)
     {
-        LOG_E("Failed to malloc %d bytes for RAM buffer.", instance.swap_buffer_size);
+        LOG_E("Failed to malloc %d bytes for RAM buffer.", QBOOT_HPATCH_RAM_BUFFER_SIZE);
+        _old_read_deinit(&instance);
         return -1;
     }
-    instance.swap_write_pos = 0;
-    instance.committed_len = 0;
-    LOG_D("Allocated %d bytes for RAM buffer.", instance.swap_buffer_size);
-
-    result = hpi_patch(&instance.parent, QBOOT_HPATCH_PATCH_CACHE_SIZE, QBOOT_HPATCH_DECOMPRESS_CACHE_SIZE, _do_read_patch, _do_read_old, _do_write_new_ram);
-
-    // After the patch loop, commit the last data block in RAM if it exists
-    if (result == HPATCHI_SUCCESS && instance.swap_write_pos > 0)
-    {
-        if (!_commit_ram_to_old(&instance))
-        {
-            result = HPATCHI_PATCH_ERROR;
-        }
-    }
-    rt_free(instance.swap_buffer);
+    LOG_D("Allocated %d bytes for RAM buffer.", QBOOT_HPATCH_RAM_BUFFER_SIZE);
+    result = _patch_with_ram(&instance, buffer, QBOOT_HPATCH_RAM_BUFFER_SIZE, QBOOT_HPATCH_PATCH_CACHE_SIZE, QBOOT_HPATCH_DECOMPRESS_CACHE_SIZE);
+    rt_free(buffer);
 #else
-#error "No HPatchLite buffer strategy selected. Please define QBOOT_HPATCH_USE_FLASH_SWAP or QBOOT_HPATCH_USE_RAM_BUFFER."
+#error "No HPatchLite buffer strategy selected. Please define QBOOT_HPATCH_USE_FLASH_SWAP, QBOOT_HPATCH_USE_RAM_BUFFER or QBOOT_HPATCH_USE_HYBRID."
 #endif
+    _old_read_deinit(&instance);
 
     // --- Finalization: Tail Erase and Verification ---
     if (result == HPATCHI_SUCCESS)
@@ -0,0 +1,133 @@
+/*
+ * qboot_index.c
+ *
+ * Change Logs:
+ * Date           Author            Notes
+ * 2026-10-14     qboot             first version
+ */
+
+#include <qboot_index.h>
+#include <qboot_crc.h>
+#include <qboot_stats.h>
+#include <string.h>
+
+#ifdef QBOOT_USING_BLOCK_INDEX
+
+//#define QBOOT_INDEX_DEBUG
+#define QBOOT_INDEX_USING_LOG
+#define DBG_TAG "Qboot"
+
+#ifdef QBOOT_INDEX_DEBUG
+#define DBG_LVL DBG_LOG
+#else
+#define DBG_LVL DBG_INFO
+#endif
+
+#ifdef QBOOT_INDEX_USING_LOG
+#ifndef DBG_ENABLE
+#define DBG_ENABLE
+#endif
+#ifndef DBG_COLOR
+#define DBG_COLOR
+#endif
+#endif
+
+#include <rtdbg.h>
+
+#define QBOOT_IDX_READ_NUM              16//entries read at once while checking
+
+static bool qbt_idx_entry_check(const qbt_idx_t *idx, u32 blk_no, const qbt_idx_entry_t *entry)
+{
+    u32 data_pos = sizeof(qbt_idx_hdr_t) + idx->blk_num * sizeof(qbt_idx_entry_t);
+    u32 raw_len = idx->blk_size;
+
+    if (blk_no == idx->blk_num - 1)
+    {
+        raw_len = idx->raw_size - blk_no * idx->blk_size;
+    }
+    if (entry->raw_len != raw_len)
+    {
+        LOG_E("Qboot block index error. block %d raw length %d != %d", blk_no, entry->raw_len, raw_len);
+        return(false);
+    }
+    if ((entry->cmprs_len == 0) || (entry->cmprs_ofs < data_pos) || (entry->cmprs_ofs > idx->pkg_size) || (entry->cmprs_len > idx->pkg_size - entry->cmprs_ofs))
+    {
+        LOG_E("Qboot block index error. block %d is out of package, offset = %08X, length = %d", blk_no, entry->cmprs_ofs, entry->cmprs_len);
+        return(false);
+    }
+    return(true);
+}
+
+bool qbt_idx_open(qbt_idx_t *idx, fal_partition_t part, u32 body_pos, u32 pkg_size, u32 raw_size)
+{
+    qbt_idx_hdr_t hdr;
+    qbt_idx_entry_t entry[QBOOT_IDX_READ_NUM];
+    u32 crc32 = 0xFFFFFFFF;
+
+    if ((pkg_size < sizeof(hdr)) || (fal_partition_read(part, body_pos, (u8 *)&hdr, sizeof(hdr)) < 0))
+    {
+        LOG_E("Qboot block index read fail. part = %s, addr = %08X", part->name, body_pos);
+        return(false);
+    }
+    if ((hdr.magic != QBOOT_IDX_MAGIC) || (hdr.blk_size == 0) || (hdr.blk_size > QBOOT_IDX_BLK_MAX_SIZE)
+        || (hdr.blk_num != (raw_size + hdr.blk_size - 1) / hdr.blk_size)
+        || (hdr.blk_num > (pkg_size - sizeof(hdr)) / sizeof(qbt_idx_entry_t)))
+    {
+        LOG_E("Qboot block index error. magic = %08X, blocks = %d, block size = %d", hdr.magic, hdr.blk_num, hdr.blk_size);
+        return(false);
+    }
+
+    idx->part = part;
+    idx->body_pos = body_pos;
+    idx->pkg_size = pkg_size;
+    idx->raw_size = raw_size;
+    idx->blk_num = hdr.blk_num;
+    idx->blk_size = hdr.blk_size;
+
+    for (u32 blk_no = 0; blk_no < idx->blk_num; )
+    {
+        u32 num = idx->blk_num - blk_no;
+        if (num > QBOOT_IDX_READ_NUM)
+        {
+            num = QBOOT_IDX_READ_NUM;
+        }
+        if (fal_partition_read(part, body_pos + sizeof(hdr) + blk_no * sizeof(qbt_idx_entry_t), (u8 *)entry, num * sizeof(qbt_idx_entry_t)) < 0)
+        {
+            LOG_E("Qboot block index read fail. part = %s, block = %d", part->name, blk_no);
+            return(false);
+        }
+        crc32 = qbt_crc32_cyc_cal(crc32, (u8 *)entry, num * sizeof(qbt_idx_entry_t));
+        for (u32 i = 0; i < num; i++)
+        {
+            if ( ! qbt_idx_entry_check(idx, blk_no + i, &entry[i]))
+            {
+                return(false);
+            }
+        }
+        blk_no += num;
+    }
+    crc32 ^= 0xFFFFFFFF;
+    if (crc32 != hdr.idx_crc)
+    {
+        LOG_E("Qboot block index crc error. cal.crc: %08X != idx.crc: %08X", crc32, hdr.idx_crc);
+        return(false);
+    }
+
+    LOG_D("Qboot block index of %s: %d blocks of %d bytes.", part->name, idx->blk_num, idx->blk_size);
+    return(true);
+}
+
+bool qbt_idx_entry_read(const qbt_idx_t *idx, u32 blk_no, qbt_idx_entry_t *entry)
+{
+    u32 pos = idx->body_pos + sizeof(qbt_idx_hdr_t) + blk_no * sizeof(qbt_idx_entry_t);
+
+    if ((blk_no >= idx->blk_num) || (fal_partition_read(idx->part, pos, (u8 *)entry, sizeof(qbt_idx_entry_t)) < 0))
+    {
+        LOG_E("Qboot block index read fail. part = %s, block = %d", idx->part->name, blk_no);
+        return(false);
+    }
+    return(qbt_idx_entry_check(idx, blk_no, entry));
+}
+
+#endif
+
@@ -0,0 +1,138 @@
+/*
+ * qboot_jump.c
+ *
+ * Change Logs:
+ * Date           Author            Notes
+ * 2026-10-14     qboot             first version
+ */
+
+#include <qboot_jump.h>
+
+#ifdef QBOOT_USING_FAST_JUMP
+
+#include <board.h>
+
+/*
+ * The jump de-initializes only what qboot has enabled, by the tables of port and board,
+ * instead of resetting all peripherals of the buses one by one. The console is waited while
+ * it has datas to send, not for a fixed delay. NVIC is cleared by its 32 bits registers.
+ */
+
+static const qbt_jump_desc_t qbt_jump_desc_none = {RT_NULL, 0, RT_NULL, 0};
+static u32 qbt_jump_marked = 0;
+
+void qbt_jump_periph_mark(u32 periph)
+{
+    qbt_jump_marked |= periph;
+}
+
+u32 qbt_jump_periph_marked(void)
+{
+    return(qbt_jump_marked);
+}
+
+rt_weak const qbt_jump_desc_t *qbt_jump_desc_get(void)
+{
+    return(RT_NULL);
+}
+
+static void qbt_jump_tx_wait(const qbt_jump_desc_t *desc)
+{
+    if (desc->flags & QBOOT_JUMP_FLAG_NO_TX_WAIT)
+    {
+        return;
+    }
+    if (desc->tx_pending != RT_NULL)
+    {
+        u32 loops = SystemCoreClock / 1000;//some milliseconds, not to hang on a console never ready
+        while ((loops > 0) && desc->tx_pending())
+        {
+            loops--;
+        }
+        return;
+    }
+    if (rt_thread_self() != RT_NULL)//not in early jump before the scheduler starts
+    {
+        rt_thread_mdelay(QBOOT_JUMP_TX_DELAY_MS);
+    }
+}
+
+static void qbt_jump_periph_deinit(const qbt_jump_periph_t *tab, u32 num)
+{
+    for (u32 i = 0; i < num; i++)
+    {
+        if ((tab[i].deinit != RT_NULL) && ((tab[i].periph == QBOOT_JUMP_PERIPH_ALWAYS) || (tab[i].periph & qbt_jump_marked)))
+        {
+            tab[i].deinit();
+        }
+    }
+}
+
+static void qbt_jump_nvic_clear(void)
+{
+    u32 num = sizeof(NVIC->ICER) / sizeof(NVIC->ICER[0]);
+    #ifdef SCnSCB_ICTR_INTLINESNUM_Msk
+    u32 lines = (SCnSCB->ICTR & SCnSCB_ICTR_INTLINESNUM_Msk) + 1;//implemented interrupts of 32
+    if (lines < num)
+    {
+        num = lines;
+    }
+    #endif
+
+    for (u32 i = 0; i < num; i++)
+    {
+        NVIC->ICER[i] = 0xFFFFFFFF;
+        NVIC->ICPR[i] = 0xFFFFFFFF;
+    }
+    SCB->ICSR = SCB_ICSR_PENDSTCLR_Msk | SCB_ICSR_PENDSVCLR_Msk;
+}
+
+void qbt_jump_app_run(const qbt_jump_port_t *port, u32 stk_addr, u32 entry_addr)
+{
+    typedef void (*app_func_t)(void);
+    app_func_t app_func = (app_func_t)(rt_ubase_t)entry_addr;
+    const qbt_jump_desc_t *desc = qbt_jump_desc_get();
+
+    if (desc == RT_NULL)
+    {
+        desc = &qbt_jump_desc_none;
+    }
+
+    qbt_jump_tx_wait(desc);
+
+    __disable_irq();
+    if ((desc->flags & QBOOT_JUMP_FLAG_BUS_RESET) && (port->bus_reset != RT_NULL))
+    {
+        port->bus_reset();
+    }
+    else
+    {
+        qbt_jump_periph_deinit(port->periph_tab, port->periph_num);
+        qbt_jump_periph_deinit(desc->periph_tab, desc->periph_num);
+    }
+    if (((desc->flags & QBOOT_JUMP_FLAG_KEEP_CLOCK) == 0) && (port->clock_reset != RT_NULL))
+    {
+        port->clock_reset();
+    }
+
+    SysTick->CTRL = 0;//after the clock reset, it may start the tick again
+    SysTick->LOAD = 0;
+    SysTick->VAL = 0;
+    qbt_jump_nvic_clear();
+
+    #ifdef DWT_CTRL_CYCCNTENA_Msk
+    if (qbt_jump_marked & QBOOT_JUMP_PERIPH_CYCCNT)
+    {
+        DWT->CTRL &= ~DWT_CTRL_CYCCNTENA_Msk;
+    }
+    #endif
+
+    __set_CONTROL(0);
+    __ISB();
+    __set_MSP(stk_addr);
+
+    app_func();//Jump to application running
+}
+
+#endif
+
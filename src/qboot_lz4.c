@@ -0,0 +1,121 @@
+/*
+ * qboot_lz4.c
+ *
+ * Decoder of the lz4 block format, each block of the package is decoded independently.
+ *
+ * Change Logs:
+ * Date           Author            Notes
+ * 2026-10-14     qboot             first version
+ */
+
+#include <qboot_lz4.h>
+
+#ifdef QBOOT_USING_LZ4
+
+#include <string.h>
+
+#define QBOOT_LZ4_MIN_MATCH             4
+#define QBOOT_LZ4_RUN_MASK              0x0F
+
+static bool qbt_lz4_len_ext(const u8 **p_ip, const u8 *ip_end, u32 *p_len)
+{
+    const u8 *ip = *p_ip;
+    u32 len = *p_len;
+    u8 b;
+
+    do
+    {
+        if (ip >= ip_end)
+        {
+            return(false);
+        }
+        b = *ip++;
+        len += b;
+    } while (b == 255);
+
+    *p_ip = ip;
+    *p_len = len;
+    return(true);
+}
+
+u32 qbt_lz4_get_block_size(const u8 *comp_datas)
+{
+    u32 block_size = 0;
+    for(int i = 0; i < QBOOT_LZ4_BLOCK_HDR_SIZE; i++)
+    {
+         block_size <<= 8;
+         block_size += comp_datas[i];
+    }
+    return(block_size);
+}
+
+u32 qbt_lz4_decompress(u8 *out_buf, u32 out_buf_size, const u8 *in_buf, u32 block_size)
+{
+    const u8 *ip = in_buf;
+    const u8 *ip_end = in_buf + block_size;
+    u8 *op = out_buf;
+    u8 *op_end = out_buf + out_buf_size;
+
+    while (ip < ip_end)
+    {
+        u32 token = *ip++;
+        u32 len = (token >> 4);
+        u32 offset;
+        const u8 *ref;
+
+        if ((len == QBOOT_LZ4_RUN_MASK) && ! qbt_lz4_len_ext(&ip, ip_end, &len))
+        {
+            return(0);
+        }
+        if ((len > (u32)(ip_end - ip)) || (len > (u32)(op_end - op)))
+        {
+            return(0);
+        }
+        memcpy(op, ip, len);
+        op += len;
+        ip += len;
+        if (ip >= ip_end)//the last sequence has literals only
+        {
+            break;
+        }
+
+        if (ip_end - ip < 2)
+        {
+            return(0);
+        }
+        offset = ip[0] | (ip[1] << 8);
+        ip += 2;
+        if ((offset == 0) || (offset > (u32)(op - out_buf)))
+        {
+            return(0);
+        }
+        len = (token & QBOOT_LZ4_RUN_MASK);
+        if ((len == QBOOT_LZ4_RUN_MASK) && ! qbt_lz4_len_ext(&ip, ip_end, &len))
+        {
+            return(0);
+        }
+        len += QBOOT_LZ4_MIN_MATCH;
+        if (len > (u32)(op_end - op))
+        {
+            return(0);
+        }
+        ref = op - offset;
+        if (offset >= len)
+        {
+            memcpy(op, ref, len);
+            op += len;
+        }
+        else
+        {
+            while (len--)//overlapped copy repeats the last offset bytes
+            {
+                *op++ = *ref++;
+            }
+        }
+    }
+
+    return(op - out_buf);
+}
+
+#endif
+
@@ -0,0 +1,105 @@
+/*
+ * qboot_manifest.c
+ *
+ * Change Logs:
+ * Date           Author            Notes
+ * 2026-10-14     qboot             first version
+ */
+
+#include <qboot_manifest.h>
+#include <qboot_crc.h>
+#include <string.h>
+
+#ifdef QBOOT_USING_MANIFEST
+
+//#define QBOOT_MANIFEST_DEBUG
+#define QBOOT_MANIFEST_USING_LOG
+#define DBG_TAG "Qboot"
+
+#ifdef QBOOT_MANIFEST_DEBUG
+#define DBG_LVL DBG_LOG
+#else
+#define DBG_LVL DBG_INFO
+#endif
+
+#ifdef QBOOT_MANIFEST_USING_LOG
+#ifndef DBG_ENABLE
+#define DBG_ENABLE
+#endif
+#ifndef DBG_COLOR
+#define DBG_COLOR
+#endif
+#endif
+
+#include <rtdbg.h>
+
+static bool qbt_mnf_entry_check(const qbt_mnf_t *mnf, u32 img_no, const qbt_mnf_entry_t *entry, u32 data_pos)
+{
+    if ((entry->img_size == 0) || (entry->img_ofs < data_pos) || (entry->img_ofs > mnf->pkg_size) || (entry->img_size > mnf->pkg_size - entry->img_ofs))
+    {
+        LOG_E("Qboot manifest error. image %d is out of package, offset = %08X, size = %d", img_no, entry->img_ofs, entry->img_size);
+        return(false);
+    }
+    return(true);
+}
+
+bool qbt_mnf_open(qbt_mnf_t *mnf, fal_partition_t part, u32 body_pos, u32 pkg_size)
+{
+    qbt_mnf_hdr_t hdr;
+    qbt_mnf_entry_t entry[QBOOT_MNF_IMG_MAX_NUM];
+    u32 data_pos;
+
+    if ((pkg_size < sizeof(hdr)) || (fal_partition_read(part, body_pos, (u8 *)&hdr, sizeof(hdr)) < 0))
+    {
+        LOG_E("Qboot manifest read fail. part = %s, addr = %08X", part->name, body_pos);
+        return(false);
+    }
+    if ((hdr.magic != QBOOT_MNF_MAGIC) || (hdr.img_num == 0) || (hdr.img_num > QBOOT_MNF_IMG_MAX_NUM)
+        || (hdr.img_num > (pkg_size - sizeof(hdr)) / sizeof(qbt_mnf_entry_t)))
+    {
+        LOG_E("Qboot manifest error. magic = %08X, images = %d", hdr.magic, hdr.img_num);
+        return(false);
+    }
+    if (fal_partition_read(part, body_pos + sizeof(hdr), (u8 *)entry, hdr.img_num * sizeof(qbt_mnf_entry_t)) < 0)
+    {
+        LOG_E("Qboot manifest read fail. part = %s, addr = %08X", part->name, (u32)(body_pos + sizeof(hdr)));
+        return(false);
+    }
+    if (qbt_crc32_cal((u8 *)entry, hdr.img_num * sizeof(qbt_mnf_entry_t)) != hdr.tbl_crc)
+    {
+        LOG_E("Qboot manifest crc error. table crc: %08X", hdr.tbl_crc);
+        return(false);
+    }
+
+    mnf->part = part;
+    mnf->body_pos = body_pos;
+    mnf->pkg_size = pkg_size;
+    mnf->img_num = hdr.img_num;
+
+    data_pos = sizeof(hdr) + hdr.img_num * sizeof(qbt_mnf_entry_t);
+    for (u32 i = 0; i < hdr.img_num; i++)
+    {
+        if ( ! qbt_mnf_entry_check(mnf, i, &entry[i], data_pos))
+        {
+            return(false);
+        }
+        data_pos = entry[i].img_ofs + entry[i].img_size;//images do not overlap
+    }
+
+    LOG_D("Qboot manifest of %s: %d images.", part->name, mnf->img_num);
+    return(true);
+}
+
+bool qbt_mnf_entry_read(const qbt_mnf_t *mnf, u32 img_no, qbt_mnf_entry_t *entry)
+{
+    u32 pos = mnf->body_pos + sizeof(qbt_mnf_hdr_t) + img_no * sizeof(qbt_mnf_entry_t);
+
+    if ((img_no >= mnf->img_num) || (fal_partition_read(mnf->part, pos, (u8 *)entry, sizeof(qbt_mnf_entry_t)) < 0))
+    {
+        LOG_E("Qboot manifest read fail. part = %s, image = %d", mnf->part->name, img_no);
+        return(false);
+    }
+    return(qbt_mnf_entry_check(mnf, img_no, entry, sizeof(qbt_mnf_hdr_t) + mnf->img_num * sizeof(qbt_mnf_entry_t)));
+}
+
+#endif
@@ -0,0 +1,56 @@
+/*
+ * qboot_map.c
+ *
+ * Change Logs:
+ * Date           Author            Notes
+ * 2026-10-14     qboot             first version
+ */
+
+#include <qboot_map.h>
+
+#ifdef QBOOT_USING_MAPPED_READ
+
+/*
+ * A mapped view reads the partition by its address, without copying it through fal_partition_read.
+ * By default, the flash holding the application entry QBOOT_APP_ADDR is mapped at its fal address,
+ * as the application runs from it. Other flashes, e.g. a QSPI flash in memory mapped mode, are added
+ * by qbt_map_flash_addr of the port, which must keep the mapping valid while the views are read.
+ */
+
+rt_weak const u8 *qbt_map_flash_addr(const struct fal_flash_dev *flash)
+{
+    if ((QBOOT_APP_ADDR >= flash->addr) && (QBOOT_APP_ADDR - flash->addr < flash->len))
+    {
+        return((const u8 *)(rt_ubase_t)flash->addr);
+    }
+    return(RT_NULL);
+}
+
+const u8 *qbt_map_view(const struct fal_partition *part, u32 addr, u32 *p_len)
+{
+    const struct fal_flash_dev *flash;
+    const u8 *base;
+
+    if ((part == RT_NULL) || (addr > part->len))
+    {
+        return(RT_NULL);
+    }
+    flash = fal_flash_device_find(part->flash_name);
+    if (flash == RT_NULL)
+    {
+        return(RT_NULL);
+    }
+    base = qbt_map_flash_addr(flash);
+    if (base == RT_NULL)
+    {
+        return(RT_NULL);
+    }
+    if (p_len != RT_NULL)
+    {
+        *p_len = part->len - addr;
+    }
+    return(base + part->offset + addr);
+}
+
+#endif
+
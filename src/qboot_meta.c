@@ -0,0 +1,298 @@
+/*
+ * qboot_meta.c
+ *
+ * Change Logs:
+ * Date           Author            Notes
+ * 2026-10-14     qboot             first version
+ */
+
+#include <qboot_meta.h>
+#include <qboot_crc.h>
+#include <fal.h>
+#include <qboot_stats.h>
+#include <string.h>
+
+#ifdef QBOOT_USING_META
+
+//#define QBOOT_META_DEBUG
+#define QBOOT_META_USING_LOG
+#define DBG_TAG "Qboot"
+
+#ifdef QBOOT_META_DEBUG
+#define DBG_LVL DBG_LOG
+#else
+#define DBG_LVL DBG_INFO
+#endif
+
+#ifdef QBOOT_META_USING_LOG
+#ifndef DBG_ENABLE
+#define DBG_ENABLE
+#endif
+#ifndef DBG_COLOR
+#define DBG_COLOR
+#endif
+#endif
+
+#include <rtdbg.h>
+
+/*
+ * The metadata partition is a log of fixed size records, appended in sequence.
+ * The record with the largest sequence number of a type is the valid one.
+ * When the current sector is full, the next sector is erased and the latest records
+ * of all types are copied into it first, so there is always a sector holding them all,
+ * and a power loss at any time can not lose metadata.
+ */
+
+#define QBOOT_META_MAGIC                0x4154454D//"META"
+#define QBOOT_META_HDR_CRC_SIZE         12//magic, type, len, seq
+
+typedef struct {
+    u32 magic;
+    u16 type;
+    u16 len;
+    u32 seq;
+    u32 crc;
+    u8  data[QBOOT_META_DATA_SIZE];
+}qbt_meta_rec_t;
+
+typedef struct {
+    fal_partition_t part;
+    u32 sector_size;
+    u32 wr_pos;                         //next record position
+    u32 seq;                            //largest sequence number used
+    bool scanned;
+}qbt_meta_ctx_t;
+
+static qbt_meta_ctx_t meta = {0};
+static qbt_meta_rec_t meta_rec;
+static qbt_meta_rec_t meta_copy[QBOOT_META_TYPE_MAX];
+
+static u32 qbt_meta_rec_crc(const qbt_meta_rec_t *rec)
+{
+    u32 crc = qbt_crc32_cyc_cal(0xFFFFFFFF, (const u8 *)rec, QBOOT_META_HDR_CRC_SIZE);
+    crc = qbt_crc32_cyc_cal(crc, rec->data, QBOOT_META_DATA_SIZE);
+    return(crc ^ 0xFFFFFFFF);
+}
+
+static bool qbt_meta_rec_is_blank(const qbt_meta_rec_t *rec)
+{
+    const u8 *p = (const u8 *)rec;
+    for (int i = 0; i < sizeof(qbt_meta_rec_t); i++)
+    {
+        if (p[i] != 0xFF)
+        {
+            return(false);
+        }
+    }
+    return(true);
+}
+
+static bool qbt_meta_rec_is_valid(const qbt_meta_rec_t *rec)
+{
+    return((rec->magic == QBOOT_META_MAGIC) && (rec->len <= QBOOT_META_DATA_SIZE) && (qbt_meta_rec_crc(rec) == rec->crc));
+}
+
+static bool qbt_meta_open(void)
+{
+    const struct fal_flash_dev *flash_dev;
+
+    if (meta.part != NULL)
+    {
+        return(true);
+    }
+
+    meta.part = (fal_partition_t)fal_partition_find(QBOOT_META_PART_NAME);
+    if (meta.part == NULL)
+    {
+        LOG_E("Qboot metadata fail. partition %s is not exist.", QBOOT_META_PART_NAME);
+        return(false);
+    }
+    flash_dev = fal_flash_device_find(meta.part->flash_name);
+    if ((flash_dev == NULL) || (flash_dev->blk_size < QBOOT_META_REC_SIZE) || (meta.part->len < flash_dev->blk_size * 2))
+    {
+        LOG_E("Qboot metadata fail. partition %s must have 2 sectors at least.", QBOOT_META_PART_NAME);
+        meta.part = NULL;
+        return(false);
+    }
+    meta.sector_size = flash_dev->blk_size;
+    meta.scanned = false;
+
+    return(true);
+}
+
+static bool qbt_meta_scan(void)//find the write position
+{
+    u32 last_pos = 0;
+    u32 cur_sector;
+
+    if (meta.scanned)
+    {
+        return(true);
+    }
+
+    meta.seq = 0;
+    for (u32 pos = 0; pos + QBOOT_META_REC_SIZE <= meta.part->len; pos += QBOOT_META_REC_SIZE)
+    {
+        if (fal_partition_read(meta.part, pos, (u8 *)&meta_rec, QBOOT_META_REC_SIZE) < 0)
+        {
+            return(false);
+        }
+        if (qbt_meta_rec_is_valid(&meta_rec) && (meta_rec.seq >= meta.seq))
+        {
+            meta.seq = meta_rec.seq;
+            last_pos = pos;
+        }
+    }
+
+    //append after the last used record in the sector of the latest record
+    cur_sector = last_pos - (last_pos % meta.sector_size);
+    meta.wr_pos = cur_sector;
+    for (u32 pos = cur_sector; pos < cur_sector + meta.sector_size; pos += QBOOT_META_REC_SIZE)
+    {
+        if (fal_partition_read(meta.part, pos, (u8 *)&meta_rec, QBOOT_META_REC_SIZE) < 0)
+        {
+            return(false);
+        }
+        if ( ! qbt_meta_rec_is_blank(&meta_rec))
+        {
+            meta.wr_pos = pos + QBOOT_META_REC_SIZE;
+        }
+    }
+    meta.scanned = true;
+
+    return(true);
+}
+
+static bool qbt_meta_find(u16 type, u32 begin, u32 end, qbt_meta_rec_t *rec)
+{
+    bool found = false;
+    u32 seq = 0;
+
+    for (u32 pos = begin; pos + QBOOT_META_REC_SIZE <= end; pos += QBOOT_META_REC_SIZE)
+    {
+        if (fal_partition_read(meta.part, pos, (u8 *)&meta_rec, QBOOT_META_REC_SIZE) < 0)
+        {
+            return(false);
+        }
+        if (qbt_meta_rec_is_valid(&meta_rec) && (meta_rec.type == type) && (( ! found) || (meta_rec.seq >= seq)))
+        {
+            memcpy(rec, &meta_rec, sizeof(qbt_meta_rec_t));
+            seq = meta_rec.seq;
+            found = true;
+        }
+    }
+
+    return(found);
+}
+
+static bool qbt_meta_rec_write(qbt_meta_rec_t *rec)
+{
+    rec->magic = QBOOT_META_MAGIC;
+    rec->seq = ++meta.seq;
+    rec->crc = qbt_meta_rec_crc(rec);
+    if (fal_partition_write(meta.part, meta.wr_pos, (u8 *)rec, QBOOT_META_REC_SIZE) < 0)
+    {
+        LOG_E("Qboot metadata write fail. addr = %08X", meta.wr_pos);
+        meta.scanned = false;
+        return(false);
+    }
+    meta.wr_pos += QBOOT_META_REC_SIZE;
+    return(true);
+}
+
+static bool qbt_meta_sector_switch(u16 skip_type)
+{
+    u32 cur_sector = (meta.wr_pos - QBOOT_META_REC_SIZE) - ((meta.wr_pos - QBOOT_META_REC_SIZE) % meta.sector_size);
+    u32 new_sector = cur_sector + meta.sector_size;
+    int copy_cnt = 0;
+
+    if (new_sector + meta.sector_size > meta.part->len)
+    {
+        new_sector = 0;
+    }
+
+    //all the latest records are in current sector
+    for (u16 type = 0; type < QBOOT_META_TYPE_MAX; type++)
+    {
+        if ((type != skip_type) && qbt_meta_find(type, cur_sector, cur_sector + meta.sector_size, &meta_copy[copy_cnt]))
+        {
+            copy_cnt++;
+        }
+    }
+
+    if (fal_partition_erase(meta.part, new_sector, meta.sector_size) < 0)
+    {
+        LOG_E("Qboot metadata erase fail. addr = %08X", new_sector);
+        meta.scanned = false;
+        return(false);
+    }
+    meta.wr_pos = new_sector;
+
+    for (int i = 0; i < copy_cnt; i++)
+    {
+        if ( ! qbt_meta_rec_write(&meta_copy[i]))
+        {
+            return(false);
+        }
+    }
+
+    return(true);
+}
+
+bool qbt_meta_read(u16 type, void *data, u32 len)
+{
+    qbt_meta_rec_t *rec = &meta_copy[0];
+
+    if ( ! qbt_meta_open())
+    {
+        return(false);
+    }
+    if ( ! qbt_meta_find(type, 0, meta.part->len, rec))
+    {
+        return(false);
+    }
+
+    memset(data, 0, len);
+    memcpy(data, rec->data, (len < rec->len) ? len : rec->len);
+
+    return(true);
+}
+
+bool qbt_meta_write(u16 type, const void *data, u32 len)
+{
+    if ((type >= QBOOT_META_TYPE_MAX) || (len > QBOOT_META_DATA_SIZE))
+    {
+        return(false);
+    }
+    if (( ! qbt_meta_open()) || ( ! qbt_meta_scan()))
+    {
+        return(false);
+    }
+
+    if ((meta.seq == 0) && (meta.wr_pos > 0))//no valid record, but not blank
+    {
+        if (fal_partition_erase(meta.part, 0, meta.sector_size) < 0)
+        {
+            LOG_E("Qboot metadata erase fail. addr = %08X", 0);
+            return(false);
+        }
+        meta.wr_pos = 0;
+    }
+    else if ((meta.wr_pos % meta.sector_size == 0) && (meta.seq > 0))//current sector is full
+    {
+        if ( ! qbt_meta_sector_switch(type))
+        {
+            return(false);
+        }
+    }
+
+    memset(&meta_rec, 0xFF, sizeof(meta_rec));
+    meta_rec.type = type;
+    meta_rec.len = len;
+    memcpy(meta_rec.data, data, len);
+
+    return(qbt_meta_rec_write(&meta_rec));
+}
+
+#endif
+
@@ -13,6 +13,7 @@
 #include <rtthread.h>
 #include <rtdevice.h>
 #include <qboot.h>
+#include <qboot_jump.h>
 #include <n32g45x_conf.h>
 
 //#define QBOOT_APP_RUN_IN_QSPI_FLASH
@@ -65,10 +66,20 @@ static void qbt_reset_periph(void)
     RCC->APB1PRST = 0x00000000;
 }
 
+#ifdef QBOOT_USING_FAST_JUMP
+static const qbt_jump_periph_t qbt_jump_periph_tab[] = {
+    {QBOOT_JUMP_PERIPH_ALWAYS, RT_NULL},//no peripheral is enabled by qboot on n32
+};
+
+static const qbt_jump_port_t qbt_jump_port = {
+    qbt_jump_periph_tab, sizeof(qbt_jump_periph_tab) / sizeof(qbt_jump_periph_tab[0]), qbt_reset_periph, RCC_DeInit
+};
+#endif
+
 rt_weak void qbt_jump_to_app(void)
 {
     typedef void (*app_func_t)(void);
-    u32 app_addr = QBOOT_APP_ADDR;
+    u32 app_addr = qbt_app_addr_get();
     u32 stk_addr = *((__IO uint32_t *)app_addr);
     app_func_t app_func = (app_func_t)(*((__IO uint32_t *)(app_addr + 4)));
 
@@ -79,7 +90,13 @@ rt_weak void qbt_jump_to_app(void)
     }
 
     rt_kprintf("Jump to application running ... \n");
-    rt_thread_mdelay(200);
+    #ifdef QBOOT_USING_FAST_JUMP
+    qbt_jump_app_run(&qbt_jump_port, stk_addr, (u32)app_func);
+    #else
+    if (rt_thread_self() != RT_NULL)//not in early jump before the scheduler starts
+    {
+        rt_thread_mdelay(200);
+    }
     
     __disable_irq();
     qbt_reset_periph();
@@ -100,6 +117,7 @@ rt_weak void qbt_jump_to_app(void)
     __set_MSP(stk_addr);
     
     app_func();//Jump to application running
+    #endif
     
     LOG_E("Qboot jump to application fail.");
 }
@@ -0,0 +1,358 @@
+/*
+ * qboot_pipe.c
+ *
+ * Change Logs:
+ * Date           Author            Notes
+ * 2026-10-14     qboot             first version
+ */
+
+#include <qboot_pipe.h>
+#include <qboot_arena.h>
+#include <qboot_stats.h>
+#include <string.h>
+
+#ifdef QBOOT_USING_PIPELINE
+
+#if (QBOOT_PIPE_BUF_NUM < 2)
+#error "QBOOT_PIPE_BUF_NUM must >= 2"
+#endif
+
+//#define QBOOT_PIPE_DEBUG
+#define QBOOT_PIPE_USING_LOG
+#define DBG_TAG "Qboot"
+
+#ifdef QBOOT_PIPE_DEBUG
+#define DBG_LVL DBG_LOG
+#else
+#define DBG_LVL DBG_INFO
+#endif
+
+#ifdef QBOOT_PIPE_USING_LOG
+#ifndef DBG_ENABLE
+#define DBG_ENABLE
+#endif
+#ifndef DBG_COLOR
+#define DBG_COLOR
+#endif
+#endif
+
+#include <rtdbg.h>
+
+struct qbt_pipe
+{
+    fal_partition_t part;
+    qbt_pipe_write_t write_func;        //NULL for reader
+    u32 blk_size;
+    u32 pos;                            //reader : next position to read by thread
+    u32 end_pos;
+    u32 cur_pos;                        //reader : next position to read by user
+    u8 *buf;
+    u32 slot_pos[QBOOT_PIPE_BUF_NUM];
+    u32 slot_len[QBOOT_PIPE_BUF_NUM];
+    u32 head;                           //slot filled by producer
+    u32 tail;                           //slot drained by consumer
+    u32 tail_ofs;                       //reader : read offset in tail slot
+    bool slot_open;                     //reader : tail slot is taken; writer : head slot is taken
+    volatile bool stop;
+    volatile bool error;
+    rt_sem_t sem_free;
+    rt_sem_t sem_full;
+    rt_sem_t sem_exit;
+    rt_thread_t tid;
+};
+
+static void qbt_pipe_reader_entry(void *params)
+{
+    qbt_pipe_t pipe = (qbt_pipe_t)params;
+
+    while (( ! pipe->stop) && (pipe->pos < pipe->end_pos))
+    {
+        u8 *slot_buf = pipe->buf + pipe->head * pipe->blk_size;
+        u32 len = pipe->blk_size;
+
+        rt_sem_take(pipe->sem_free, RT_WAITING_FOREVER);
+        if (pipe->stop)
+        {
+            break;
+        }
+        if (len > pipe->end_pos - pipe->pos)
+        {
+            len = pipe->end_pos - pipe->pos;
+        }
+        if (fal_partition_read(pipe->part, pipe->pos, slot_buf, len) < 0)
+        {
+            pipe->error = true;
+            rt_sem_release(pipe->sem_full);//wake up user to get the error
+            break;
+        }
+        pipe->slot_pos[pipe->head] = pipe->pos;
+        pipe->slot_len[pipe->head] = len;
+        pipe->head = (pipe->head + 1) % QBOOT_PIPE_BUF_NUM;
+        pipe->pos += len;
+        rt_sem_release(pipe->sem_full);
+    }
+
+    rt_sem_release(pipe->sem_exit);
+}
+
+static void qbt_pipe_writer_entry(void *params)
+{
+    qbt_pipe_t pipe = (qbt_pipe_t)params;
+
+    while (1)
+    {
+        u32 slot = pipe->tail;
+
+        rt_sem_take(pipe->sem_full, RT_WAITING_FOREVER);
+        if (pipe->stop)
+        {
+            break;
+        }
+        if (( ! pipe->error) && (pipe->write_func(pipe->part, pipe->slot_pos[slot], pipe->buf + slot * pipe->blk_size, pipe->slot_len[slot]) < 0))
+        {
+            LOG_E("Qboot pipe write fail. part = %s, addr = %08X, length = %d", pipe->part->name, pipe->slot_pos[slot], pipe->slot_len[slot]);
+            pipe->error = true;
+        }
+        pipe->tail = (slot + 1) % QBOOT_PIPE_BUF_NUM;
+        rt_sem_release(pipe->sem_free);
+    }
+
+    rt_sem_release(pipe->sem_exit);
+}
+
+static void qbt_pipe_free(qbt_pipe_t pipe)
+{
+    if (pipe->sem_free != NULL)
+    {
+        rt_sem_delete(pipe->sem_free);
+    }
+    if (pipe->sem_full != NULL)
+    {
+        rt_sem_delete(pipe->sem_full);
+    }
+    if (pipe->sem_exit != NULL)
+    {
+        rt_sem_delete(pipe->sem_exit);
+    }
+    qbt_arena_free(pipe);
+}
+
+static qbt_pipe_t qbt_pipe_create(fal_partition_t part, u32 blk_size, void (*entry)(void *params))
+{
+    qbt_pipe_t pipe;
+
+    if (rt_thread_self() == NULL)//scheduler is not started
+    {
+        return(NULL);
+    }
+
+    pipe = qbt_arena_alloc(sizeof(struct qbt_pipe) + blk_size * QBOOT_PIPE_BUF_NUM);
+    if (pipe == NULL)
+    {
+        LOG_W("Qboot pipe create fail. no memory for %d bytes.", (int)(sizeof(struct qbt_pipe) + blk_size * QBOOT_PIPE_BUF_NUM));
+        return(NULL);
+    }
+    memset(pipe, 0, sizeof(struct qbt_pipe));
+    pipe->part = part;
+    pipe->blk_size = blk_size;
+    pipe->buf = (u8 *)(pipe + 1);
+
+    pipe->sem_free = rt_sem_create("qbt_pf", QBOOT_PIPE_BUF_NUM, RT_IPC_FLAG_FIFO);
+    pipe->sem_full = rt_sem_create("qbt_pd", 0, RT_IPC_FLAG_FIFO);
+    pipe->sem_exit = rt_sem_create("qbt_pe", 0, RT_IPC_FLAG_FIFO);
+    if ((pipe->sem_free == NULL) || (pipe->sem_full == NULL) || (pipe->sem_exit == NULL))
+    {
+        LOG_W("Qboot pipe create fail. no memory for semaphore.");
+        qbt_pipe_free(pipe);
+        return(NULL);
+    }
+
+    pipe->tid = rt_thread_create("qbt_pipe", entry, pipe, QBOOT_PIPE_THREAD_STACK_SIZE, QBOOT_PIPE_THREAD_PRIO, 10);
+    if (pipe->tid == NULL)
+    {
+        LOG_W("Qboot pipe create fail. no memory for thread.");
+        qbt_pipe_free(pipe);
+        return(NULL);
+    }
+
+    return(pipe);
+}
+
+qbt_pipe_t qbt_pipe_reader_open(fal_partition_t part, u32 pos, u32 end_pos, u32 blk_size)
+{
+    qbt_pipe_t pipe = qbt_pipe_create(part, blk_size, qbt_pipe_reader_entry);
+    if (pipe == NULL)
+    {
+        return(NULL);
+    }
+
+    pipe->pos = pos;
+    pipe->cur_pos = pos;
+    pipe->end_pos = end_pos;
+    rt_thread_startup(pipe->tid);
+
+    return(pipe);
+}
+
+qbt_pipe_t qbt_pipe_writer_open(fal_partition_t part, u32 blk_size, qbt_pipe_write_t write_func)
+{
+    qbt_pipe_t pipe = qbt_pipe_create(part, blk_size, qbt_pipe_writer_entry);
+    if (pipe == NULL)
+    {
+        return(NULL);
+    }
+
+    pipe->write_func = write_func;
+    rt_thread_startup(pipe->tid);
+
+    return(pipe);
+}
+
+int qbt_pipe_read(qbt_pipe_t pipe, u32 pos, u8 *buf, u32 len)
+{
+    u32 read_len = 0;
+
+    if ((pos != pipe->cur_pos) || (pos + len > pipe->end_pos))
+    {
+        LOG_E("Qboot pipe read fail. out of sequence, addr = %08X, length = %d", pos, len);
+        return(-1);
+    }
+
+    while (read_len < len)
+    {
+        u32 copy_len;
+
+        if ( ! pipe->slot_open)
+        {
+            if (pipe->error)
+            {
+                return(-1);
+            }
+            rt_sem_take(pipe->sem_full, RT_WAITING_FOREVER);
+            if (pipe->error)
+            {
+                return(-1);
+            }
+            pipe->tail_ofs = 0;
+            pipe->slot_open = true;
+        }
+
+        copy_len = pipe->slot_len[pipe->tail] - pipe->tail_ofs;
+        if (copy_len > len - read_len)
+        {
+            copy_len = len - read_len;
+        }
+        memcpy(buf + read_len, pipe->buf + pipe->tail * pipe->blk_size + pipe->tail_ofs, copy_len);
+        pipe->tail_ofs += copy_len;
+        read_len += copy_len;
+
+        if (pipe->tail_ofs >= pipe->slot_len[pipe->tail])
+        {
+            pipe->slot_open = false;
+            pipe->tail = (pipe->tail + 1) % QBOOT_PIPE_BUF_NUM;
+            rt_sem_release(pipe->sem_free);
+        }
+    }
+
+    pipe->cur_pos += len;
+
+    return(len);
+}
+
+static void qbt_pipe_submit(qbt_pipe_t pipe)
+{
+    pipe->slot_open = false;
+    pipe->head = (pipe->head + 1) % QBOOT_PIPE_BUF_NUM;
+    rt_sem_release(pipe->sem_full);
+}
+
+int qbt_pipe_write(qbt_pipe_t pipe, u32 pos, const u8 *buf, u32 len)
+{
+    u32 write_len = 0;
+
+    while (write_len < len)
+    {
+        u32 copy_len;
+
+        if (pipe->error)
+        {
+            return(-1);
+        }
+
+        if (pipe->slot_open && (pos != pipe->slot_pos[pipe->head] + pipe->slot_len[pipe->head]))//not continuous
+        {
+            qbt_pipe_submit(pipe);
+        }
+        if ( ! pipe->slot_open)
+        {
+            rt_sem_take(pipe->sem_free, RT_WAITING_FOREVER);
+            pipe->slot_pos[pipe->head] = pos;
+            pipe->slot_len[pipe->head] = 0;
+            pipe->slot_open = true;
+        }
+
+        copy_len = pipe->blk_size - pipe->slot_len[pipe->head];
+        if (copy_len > len - write_len)
+        {
+            copy_len = len - write_len;
+        }
+        memcpy(pipe->buf + pipe->head * pipe->blk_size + pipe->slot_len[pipe->head], buf + write_len, copy_len);
+        pipe->slot_len[pipe->head] += copy_len;
+        write_len += copy_len;
+        pos += copy_len;
+
+        if (pipe->slot_len[pipe->head] >= pipe->blk_size)
+        {
+            qbt_pipe_submit(pipe);
+        }
+    }
+
+    return(len);
+}
+
+bool qbt_pipe_flush(qbt_pipe_t pipe)
+{
+    int i;
+
+    if (pipe->write_func == NULL)
+    {
+        return( ! pipe->error);
+    }
+
+    if (pipe->slot_open)
+    {
+        qbt_pipe_submit(pipe);
+    }
+    for (i = 0; i < QBOOT_PIPE_BUF_NUM; i++)//all slots free means all datas written
+    {
+        rt_sem_take(pipe->sem_free, RT_WAITING_FOREVER);
+    }
+    for (i = 0; i < QBOOT_PIPE_BUF_NUM; i++)
+    {
+        rt_sem_release(pipe->sem_free);
+    }
+
+    return( ! pipe->error);
+}
+
+bool qbt_pipe_close(qbt_pipe_t pipe)
+{
+    bool ret = qbt_pipe_flush(pipe);
+
+    pipe->stop = true;
+    if (pipe->write_func == NULL)
+    {
+        rt_sem_release(pipe->sem_free);//wake up reader waiting for free slot
+    }
+    else
+    {
+        rt_sem_release(pipe->sem_full);
+    }
+    rt_sem_take(pipe->sem_exit, RT_WAITING_FOREVER);
+    qbt_pipe_free(pipe);
+
+    return(ret);
+}
+
+#endif
+
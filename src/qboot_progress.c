@@ -0,0 +1,137 @@
+/*
+ * qboot_progress.c
+ *
+ * Change Logs:
+ * Date           Author            Notes
+ * 2026-10-14     qboot             first version
+ */
+
+#include <qboot_progress.h>
+#include <string.h>
+
+typedef struct {
+    qbt_prog_cb_t cb;
+    void *user;
+}prog_sink_t;
+
+typedef struct {
+    bool active;
+    qbt_prog_info_t info;
+    rt_tick_t begin_tick;
+    rt_tick_t next_tick;
+    rt_tick_t interval;
+}prog_ctx_t;
+
+static prog_sink_t prog_sink[QBOOT_PROGRESS_SINK_NUM];
+static prog_ctx_t prog_ctx;
+
+#ifndef QBOOT_USING_PROGRESS_QUIET
+static void qbt_prog_console(const qbt_prog_info_t *info)
+{
+    static const char *phase_name[QBOOT_PROG_PHASE_NUM] = {"release", "clone"};
+    u32 percent = (info->total > 0) ? (u32)((u64)info->done * 100 / info->total) : 100;
+
+    switch (info->event)
+    {
+    case QBOOT_PROG_EVT_BEGIN:
+        rt_kprintf("Start %s firmware to %s ...     ", phase_name[info->phase], info->part_name);
+        break;
+    case QBOOT_PROG_EVT_UPDATE:
+        rt_kprintf("\b\b\b%02d%%", percent);
+        break;
+    case QBOOT_PROG_EVT_END:
+        rt_kprintf("\b\b\b%02d%%, %d KB/s\n", percent, info->kbps);
+        break;
+    default:
+        rt_kprintf("\n");
+        break;
+    }
+}
+#endif
+
+static void qbt_prog_notify(int event)
+{
+    qbt_prog_info_t *info = &prog_ctx.info;
+
+    info->event = event;
+    info->elapsed_ms = (u32)((u64)(rt_tick_get() - prog_ctx.begin_tick) * 1000 / RT_TICK_PER_SECOND);
+    info->kbps = (info->elapsed_ms > 0) ? (u32)((u64)info->done * 1000 / 1024 / info->elapsed_ms) : 0;
+
+    #ifndef QBOOT_USING_PROGRESS_QUIET
+    qbt_prog_console(info);
+    #endif
+    for (int i = 0; i < QBOOT_PROGRESS_SINK_NUM; i++)
+    {
+        if (prog_sink[i].cb != RT_NULL)
+        {
+            prog_sink[i].cb(info, prog_sink[i].user);
+        }
+    }
+}
+
+bool qbt_prog_register(qbt_prog_cb_t cb, void *user)
+{
+    for (int i = 0; i < QBOOT_PROGRESS_SINK_NUM; i++)
+    {
+        if ((prog_sink[i].cb == RT_NULL) || (prog_sink[i].cb == cb))
+        {
+            prog_sink[i].user = user;
+            prog_sink[i].cb = cb;
+            return(true);
+        }
+    }
+    return(false);
+}
+
+void qbt_prog_unregister(qbt_prog_cb_t cb)
+{
+    for (int i = 0; i < QBOOT_PROGRESS_SINK_NUM; i++)
+    {
+        if (prog_sink[i].cb == cb)
+        {
+            prog_sink[i].cb = RT_NULL;
+            prog_sink[i].user = RT_NULL;
+        }
+    }
+}
+
+void qbt_prog_begin(int phase, const char *part_name, u32 total)
+{
+    memset(&prog_ctx, 0, sizeof(prog_ctx));
+    prog_ctx.active = true;
+    prog_ctx.info.phase = phase;
+    prog_ctx.info.part_name = part_name;
+    prog_ctx.info.total = total;
+    prog_ctx.interval = rt_tick_from_millisecond(QBOOT_PROGRESS_INTERVAL_MS);
+    prog_ctx.begin_tick = rt_tick_get();
+    prog_ctx.next_tick = prog_ctx.begin_tick + prog_ctx.interval;
+    qbt_prog_notify(QBOOT_PROG_EVT_BEGIN);
+}
+
+void qbt_prog_update(u32 done)
+{
+    rt_tick_t tick;
+
+    prog_ctx.info.done = done;
+    if ( ! prog_ctx.active)
+    {
+        return;
+    }
+    tick = rt_tick_get();
+    if ((rt_int32_t)(tick - prog_ctx.next_tick) < 0)
+    {
+        return;
+    }
+    prog_ctx.next_tick = tick + prog_ctx.interval;
+    qbt_prog_notify(QBOOT_PROG_EVT_UPDATE);
+}
+
+void qbt_prog_end(bool is_ok)
+{
+    if ( ! prog_ctx.active)
+    {
+        return;
+    }
+    prog_ctx.active = false;
+    qbt_prog_notify(is_ok ? QBOOT_PROG_EVT_END : QBOOT_PROG_EVT_FAIL);
+}
@@ -0,0 +1,249 @@
+/*
+ * qboot_slot.c
+ *
+ * Change Logs:
+ * Date           Author            Notes
+ * 2026-10-14     qboot             first version
+ */
+
+#include <qboot_slot.h>
+#include <qboot_meta.h>
+#include <fal.h>
+#include <string.h>
+
+#ifdef QBOOT_USING_AB_SLOT
+
+//#define QBOOT_SLOT_DEBUG
+#define QBOOT_SLOT_USING_LOG
+#define DBG_TAG "Qboot"
+
+#ifdef QBOOT_SLOT_DEBUG
+#define DBG_LVL DBG_LOG
+#else
+#define DBG_LVL DBG_INFO
+#endif
+
+#ifdef QBOOT_SLOT_USING_LOG
+#ifndef DBG_ENABLE
+#define DBG_ENABLE
+#endif
+#ifndef DBG_COLOR
+#define DBG_COLOR
+#endif
+#endif
+
+#include <rtdbg.h>
+
+#define QBOOT_SLOT_BIT(slot)            (1 << (slot))
+
+typedef struct {
+    u8 active;                          //confirmed slot booted normally
+    u8 pending;                         //new installed slot waiting for confirm
+    u8 tries;                           //remain trial boot times of pending slot
+    u8 confirmed;                       //bit mask of slots confirmed running well
+}qbt_slot_tbl_t;
+
+static qbt_slot_tbl_t slot_tbl;
+static u8 slot_boot = QBOOT_SLOT_A;
+
+static void qbt_slot_tbl_load(void)
+{
+    if (( ! qbt_meta_read(QBOOT_META_TYPE_SLOT, &slot_tbl, sizeof(slot_tbl))) || (slot_tbl.active >= QBOOT_SLOT_NUM))
+    {
+        slot_tbl.active = QBOOT_SLOT_A;
+        slot_tbl.pending = QBOOT_SLOT_NONE;
+        slot_tbl.tries = 0;
+        slot_tbl.confirmed = QBOOT_SLOT_BIT(QBOOT_SLOT_A);
+    }
+    if (slot_tbl.pending >= QBOOT_SLOT_NUM)
+    {
+        slot_tbl.pending = QBOOT_SLOT_NONE;
+    }
+}
+
+static bool qbt_slot_tbl_save(void)
+{
+    if ( ! qbt_meta_write(QBOOT_META_TYPE_SLOT, &slot_tbl, sizeof(slot_tbl)))
+    {
+        LOG_E("Qboot slot table save fail.");
+        return(false);
+    }
+    return(true);
+}
+
+static bool qbt_slot_map(int slot)//a slot can not boot if it is not mapped
+{
+    #ifdef QBOOT_USING_BANK_SWAP
+    if ( ! qbt_slot_bank_swap(slot))
+    {
+        LOG_E("Qboot slot %s bank swap fail.", qbt_slot_part_name(slot));
+        return(false);
+    }
+    #endif
+    return(true);
+}
+
+int qbt_slot_of_part(const char *part_name)
+{
+    if (strcmp(part_name, QBOOT_APP_PART_NAME) == 0)
+    {
+        return(QBOOT_SLOT_A);
+    }
+    if (strcmp(part_name, QBOOT_APP_B_PART_NAME) == 0)
+    {
+        return(QBOOT_SLOT_B);
+    }
+    return(-1);
+}
+
+const char *qbt_slot_part_name(int slot)
+{
+    return((slot == QBOOT_SLOT_B) ? QBOOT_APP_B_PART_NAME : QBOOT_APP_PART_NAME);
+}
+
+const char *qbt_slot_release_target(const char *part_name)
+{
+    if (qbt_slot_of_part(part_name) < 0)//not application
+    {
+        return(part_name);
+    }
+
+    #ifdef QBOOT_USING_BANK_SWAP
+    qbt_slot_tbl_load();
+    return(qbt_slot_part_name(1 - slot_tbl.active));//images of both banks are linked at the same address
+    #else
+    return(part_name);//image is linked at the address of its slot
+    #endif
+}
+
+bool qbt_slot_installed(int slot)
+{
+    qbt_slot_tbl_load();
+    if (slot == slot_tbl.active)//updated in place
+    {
+        slot_tbl.pending = QBOOT_SLOT_NONE;
+        slot_tbl.tries = 0;
+        slot_tbl.confirmed |= QBOOT_SLOT_BIT(slot);
+    }
+    else
+    {
+        slot_tbl.pending = slot;
+        slot_tbl.tries = QBOOT_SLOT_TRIAL_TIMES;
+        slot_tbl.confirmed &= ~QBOOT_SLOT_BIT(slot);
+    }
+    return(qbt_slot_tbl_save());
+}
+
+bool qbt_slot_confirm(void)
+{
+    qbt_slot_tbl_load();
+    if (slot_tbl.pending == QBOOT_SLOT_NONE)
+    {
+        return(true);
+    }
+
+    LOG_I("Qboot slot %s is confirmed.", qbt_slot_part_name(slot_tbl.pending));
+    slot_tbl.active = slot_tbl.pending;
+    slot_tbl.confirmed |= QBOOT_SLOT_BIT(slot_tbl.pending);
+    slot_tbl.pending = QBOOT_SLOT_NONE;
+    slot_tbl.tries = 0;
+
+    return(qbt_slot_tbl_save());
+}
+
+int qbt_slot_select(qbt_slot_verify_t verify)
+{
+    qbt_slot_tbl_load();
+    slot_boot = slot_tbl.active;
+
+    if (slot_tbl.pending != QBOOT_SLOT_NONE)
+    {
+        if ((slot_tbl.tries > 0) && verify(qbt_slot_part_name(slot_tbl.pending)))
+        {
+            slot_tbl.tries--;
+            slot_boot = slot_tbl.pending;
+            LOG_I("Qboot trial boot slot %s, remain %d times.", qbt_slot_part_name(slot_boot), slot_tbl.tries);
+        }
+        else
+        {
+            LOG_W("Qboot slot %s is not confirmed, back to slot %s.", qbt_slot_part_name(slot_tbl.pending), qbt_slot_part_name(slot_tbl.active));
+            slot_tbl.pending = QBOOT_SLOT_NONE;
+            slot_tbl.tries = 0;
+        }
+        qbt_slot_tbl_save();
+    }
+
+    if ( ! qbt_slot_map(slot_boot))
+    {
+        return(qbt_slot_fallback(verify) ? slot_boot : -1);
+    }
+
+    return(slot_boot);
+}
+
+bool qbt_slot_fallback(qbt_slot_verify_t verify)
+{
+    int other = 1 - slot_boot;
+
+    qbt_slot_tbl_load();
+    if (slot_boot == slot_tbl.pending)
+    {
+        slot_tbl.pending = QBOOT_SLOT_NONE;
+        slot_tbl.tries = 0;
+    }
+    else
+    {
+        slot_tbl.confirmed &= ~QBOOT_SLOT_BIT(slot_boot);
+    }
+
+    if (((slot_tbl.confirmed & QBOOT_SLOT_BIT(other)) == 0) || ( ! verify(qbt_slot_part_name(other))))
+    {
+        qbt_slot_tbl_save();
+        return(false);
+    }
+
+    LOG_I("Qboot slot %s can not boot, fall back to slot %s.", qbt_slot_part_name(slot_boot), qbt_slot_part_name(other));
+    slot_tbl.active = other;
+    slot_boot = other;
+    qbt_slot_tbl_save();
+
+    return(qbt_slot_map(slot_boot));
+}
+
+u32 qbt_slot_boot_addr(void)
+{
+    #ifdef QBOOT_USING_BANK_SWAP
+    return(QBOOT_APP_ADDR);
+    #else
+    if (slot_boot == QBOOT_SLOT_B)
+    {
+        #ifdef QBOOT_APP_B_ADDR
+        return(QBOOT_APP_B_ADDR);
+        #else
+        const struct fal_partition *part = fal_partition_find(QBOOT_APP_B_PART_NAME);
+        const struct fal_flash_dev *flash_dev = (part != NULL) ? fal_flash_device_find(part->flash_name) : NULL;
+        if (flash_dev != NULL)
+        {
+            return(flash_dev->addr + part->offset);
+        }
+        LOG_E("Qboot slot %s address is unknown.", QBOOT_APP_B_PART_NAME);
+        #endif
+    }
+    return(QBOOT_APP_ADDR);
+    #endif
+}
+
+void qbt_slot_show(void)
+{
+    qbt_slot_tbl_load();
+    rt_kprintf("==== Slot table ====\n");
+    rt_kprintf("| Active slot           | %20s |\n", qbt_slot_part_name(slot_tbl.active));
+    rt_kprintf("| Pending slot          | %20s |\n", (slot_tbl.pending == QBOOT_SLOT_NONE) ? "none" : qbt_slot_part_name(slot_tbl.pending));
+    rt_kprintf("| Remain trial times    | %20d |\n", slot_tbl.tries);
+    rt_kprintf("| Confirmed slots       | %18s%s |\n", (slot_tbl.confirmed & QBOOT_SLOT_BIT(QBOOT_SLOT_A)) ? "A" : "-", (slot_tbl.confirmed & QBOOT_SLOT_BIT(QBOOT_SLOT_B)) ? " B" : " -");
+    rt_kprintf("| Boot slot             | %20s |\n", qbt_slot_part_name(slot_boot));
+    rt_kprintf("\n");
+}
+
+#endif
+
@@ -0,0 +1,174 @@
+/*
+ * qboot_stats.c
+ *
+ * Change Logs:
+ * Date           Author            Notes
+ * 2026-10-14     qboot             first version
+ */
+
+#include <qboot_stats.h>
+#include <qboot_crc.h>
+#include <string.h>
+
+#ifdef QBOOT_USING_STATS
+
+#undef fal_partition_read
+#undef fal_partition_write
+#undef fal_partition_erase
+
+#define QBOOT_STATS_CYCLE_MAX_MS        1000//longer phase is timed by tick, cycle counter may wrap around
+
+#ifdef QBOOT_STATS_ADDR
+#define stats_rec                       (*(qbt_stats_t *)QBOOT_STATS_ADDR)
+#else
+static qbt_stats_t stats_rec rt_section(QBOOT_STATS_SECTION);
+#endif
+
+static bool stats_inited = false;
+static u32 stats_start_tick = 0;
+static u32 phase_tick[QBOOT_STATS_PHASE_NUM];
+static u32 phase_cycle[QBOOT_STATS_PHASE_NUM];
+static u32 phase_last_us[QBOOT_STATS_PHASE_NUM];
+
+static const char *phase_name[QBOOT_STATS_PHASE_NUM] = {
+    "Package check", "App check", "Erase", "Release", "Verify"
+};
+static const char *algo_name[QBOOT_STATS_ALGO_NUM] = {
+    "NONE", "GZIP", "QUICKLZ", "FASTLZ", "HPATCHLITE", "LZ4", "UNKNOW", "UNKNOW"
+};
+
+static u32 qbt_stats_crc(void)
+{
+    return(qbt_crc32_cal((u8 *)&stats_rec, sizeof(qbt_stats_t) - sizeof(u32)));
+}
+
+static u32 qbt_stats_tick_to_ms(u32 tick)
+{
+    return((u32)((u64)tick * 1000 / RT_TICK_PER_SECOND));
+}
+
+rt_weak u32 qbt_stats_cycle_get(void)
+{
+    return(0);
+}
+
+rt_weak u32 qbt_stats_cycle_freq(void)
+{
+    return(0);
+}
+
+void qbt_stats_init(void)
+{
+    u32 boot_cnt = 0;
+
+    if (stats_inited)
+    {
+        return;
+    }
+    if ((stats_rec.magic == QBOOT_STATS_MAGIC) && (stats_rec.crc == qbt_stats_crc()))//kept from last boot
+    {
+        boot_cnt = stats_rec.boot_cnt;
+    }
+    memset(&stats_rec, 0, sizeof(qbt_stats_t));
+    stats_rec.magic = QBOOT_STATS_MAGIC;
+    stats_rec.boot_cnt = boot_cnt + 1;
+    stats_start_tick = rt_tick_get();
+    stats_inited = true;
+}
+
+void qbt_stats_phase_begin(int phase)
+{
+    phase_tick[phase] = rt_tick_get();
+    phase_cycle[phase] = qbt_stats_cycle_get();
+}
+
+void qbt_stats_phase_end(int phase)
+{
+    u32 ms = qbt_stats_tick_to_ms(rt_tick_get() - phase_tick[phase]);
+    u32 freq = qbt_stats_cycle_freq();
+    u32 us = ms * 1000;
+
+    if ((freq >= 1000000) && (ms < QBOOT_STATS_CYCLE_MAX_MS))
+    {
+        us = (qbt_stats_cycle_get() - phase_cycle[phase]) / (freq / 1000000);
+    }
+    phase_last_us[phase] = us;
+    stats_rec.phase_us[phase] += us;
+    stats_rec.phase_cnt[phase]++;
+}
+
+void qbt_stats_decode_add(int algo, u32 raw_size, int phase)
+{
+    if ((algo < 0) || (algo >= QBOOT_STATS_ALGO_NUM))
+    {
+        return;
+    }
+    stats_rec.decode_bytes[algo] += raw_size;
+    stats_rec.decode_us[algo] += phase_last_us[phase];
+}
+
+void qbt_stats_seal(void)
+{
+    stats_rec.boot_ms = qbt_stats_tick_to_ms(rt_tick_get() - stats_start_tick);
+    stats_rec.crc = qbt_stats_crc();
+}
+
+const qbt_stats_t *qbt_stats_get(void)
+{
+    return(&stats_rec);
+}
+
+void qbt_stats_show(void)
+{
+    rt_kprintf("==== Boot statistics ====\n");
+    rt_kprintf("| Boot count            | %20d |\n", stats_rec.boot_cnt);
+    rt_kprintf("| Running time (ms)     | %20d |\n", qbt_stats_tick_to_ms(rt_tick_get() - stats_start_tick));
+    rt_kprintf("| Timer                 | %20s |\n", (qbt_stats_cycle_freq() >= 1000000) ? "cycle counter" : "tick");
+    for (int i = 0; i < QBOOT_STATS_PHASE_NUM; i++)
+    {
+        rt_kprintf("| %-14s cnt,us | %8d %11d |\n", phase_name[i], stats_rec.phase_cnt[i], stats_rec.phase_us[i]);
+    }
+    for (int i = 0; i < QBOOT_STATS_ALGO_NUM; i++)
+    {
+        if (stats_rec.decode_bytes[i] == 0)
+        {
+            continue;
+        }
+        rt_kprintf("| Decode %-9s KB/s | %20d |\n", algo_name[i],
+                   (stats_rec.decode_us[i] > 0) ? (u32)((u64)stats_rec.decode_bytes[i] * 1000000 / 1024 / stats_rec.decode_us[i]) : 0);
+    }
+    rt_kprintf("| Read  calls, bytes    | %8d %11d |\n", stats_rec.rd_cnt, stats_rec.rd_bytes);
+    rt_kprintf("| Write calls, bytes    | %8d %11d |\n", stats_rec.wr_cnt, stats_rec.wr_bytes);
+    rt_kprintf("| Erase calls, bytes    | %8d %11d |\n", stats_rec.er_cnt, stats_rec.er_bytes);
+    rt_kprintf("\n");
+}
+
+int qbt_stats_fal_read(const struct fal_partition *part, uint32_t addr, uint8_t *buf, size_t size)
+{
+    rt_base_t level = rt_hw_interrupt_disable();//called by the pipeline threads too
+    stats_rec.rd_cnt++;
+    stats_rec.rd_bytes += size;
+    rt_hw_interrupt_enable(level);
+    return(fal_partition_read(part, addr, buf, size));
+}
+
+int qbt_stats_fal_write(const struct fal_partition *part, uint32_t addr, const uint8_t *buf, size_t size)
+{
+    rt_base_t level = rt_hw_interrupt_disable();
+    stats_rec.wr_cnt++;
+    stats_rec.wr_bytes += size;
+    rt_hw_interrupt_enable(level);
+    return(fal_partition_write(part, addr, buf, size));
+}
+
+int qbt_stats_fal_erase(const struct fal_partition *part, uint32_t addr, size_t size)
+{
+    rt_base_t level = rt_hw_interrupt_disable();
+    stats_rec.er_cnt++;
+    stats_rec.er_bytes += size;
+    rt_hw_interrupt_enable(level);
+    return(fal_partition_erase(part, addr, size));
+}
+
+#endif
+
@@ -13,6 +13,7 @@
 
 #include <rtdevice.h>
 #include <qboot.h>
+#include <qboot_jump.h>
 
 //#define QBOOT_APP_RUN_IN_QSPI_FLASH
 #define QBOOT_QSPI_FLASH_DEVICE_NAME    "norspi"
@@ -38,6 +39,117 @@
 
 #include <rtdbg.h>
 
+#if defined(QBOOT_USING_HW_CRC) && defined(CRC_CR_REV_OUT)
+#include <qboot_crc.h>
+
+u32 qbt_crc32_cyc_cal(u32 crc, const u8 *buf, u32 len)
+{
+    u32 head = (4 - ((rt_ubase_t)buf & 0x03)) & 0x03;
+    u32 words;
+
+    if (head > len)
+    {
+        head = len;
+    }
+    crc = qbt_crc32_sw_cyc_cal(crc, buf, head);//unaligned head
+    buf += head;
+    len -= head;
+
+    words = len / 4;
+    if (words > 0)
+    {
+        const u32 *p = (const u32 *)buf;
+        __HAL_RCC_CRC_CLK_ENABLE();
+        qbt_jump_periph_mark(QBOOT_JUMP_PERIPH_CRC);
+        #ifdef CRC_POL_POL
+        CRC->POL = 0x04C11DB7;
+        #endif
+        CRC->INIT = __RBIT(crc);//reflected crc32: bit reversed init, word input reversed, output reversed
+        CRC->CR = CRC_CR_REV_IN | CRC_CR_REV_OUT | CRC_CR_RESET;
+        for (u32 i = 0; i < words; i++)
+        {
+            CRC->DR = p[i];
+        }
+        crc = CRC->DR;
+        buf += words * 4;
+        len -= words * 4;
+    }
+
+    return(qbt_crc32_sw_cyc_cal(crc, buf, len));//remain tail
+}
+#endif
+
+#if defined(QBOOT_USING_AES) && defined(QBOOT_USING_HW_AES) && defined(HAL_CRYP_MODULE_ENABLED)
+#include <qboot_aes.h>
+
+static void qbt_aes_words_load(u32 *words, const u8 *buf, u32 size)//key and iv are taken as big endian words
+{
+    for (u32 i = 0; i < size / 4; i++)
+    {
+        words[i] = ((u32)buf[i * 4] << 24) | ((u32)buf[i * 4 + 1] << 16) | ((u32)buf[i * 4 + 2] << 8) | buf[i * 4 + 3];
+    }
+}
+
+bool qbt_aes_hw_decrypt(int mode, const u8 *key, const u8 *iv, u8 *dst_buf, const u8 *src_buf, u32 len)
+{
+    static CRYP_HandleTypeDef hcryp;
+    static u32 key_words[8];
+    static u32 iv_words[4];
+
+    if (((rt_ubase_t)dst_buf | (rt_ubase_t)src_buf) & 0x03)//datas are moved by words
+    {
+        return(false);
+    }
+
+    qbt_aes_words_load(key_words, key, sizeof(key_words));
+    qbt_aes_words_load(iv_words, iv, sizeof(iv_words));
+    #ifdef __HAL_RCC_CRYP_CLK_ENABLE
+    __HAL_RCC_CRYP_CLK_ENABLE();
+    #else
+    __HAL_RCC_AES_CLK_ENABLE();
+    #endif
+    qbt_jump_periph_mark(QBOOT_JUMP_PERIPH_AES);
+    rt_memset(&hcryp, 0, sizeof(hcryp));//initialized again with the key and iv of every call
+    #ifdef CRYP
+    hcryp.Instance = CRYP;
+    #else
+    hcryp.Instance = AES;
+    #endif
+    hcryp.Init.DataType = CRYP_DATATYPE_8B;//bytes of package are swapped in words by peripheral
+    hcryp.Init.KeySize = CRYP_KEYSIZE_256B;
+    hcryp.Init.pKey = key_words;
+    hcryp.Init.pInitVect = iv_words;
+    hcryp.Init.Algorithm = (mode == QBOOT_AES_MODE_CTR) ? CRYP_AES_CTR : CRYP_AES_CBC;//low 32 bits of counter are increased in ctr
+    if (HAL_CRYP_Init(&hcryp) != HAL_OK)
+    {
+        return(false);
+    }
+
+    return(HAL_CRYP_Decrypt(&hcryp, (u32 *)src_buf, len / 4, (u32 *)dst_buf, 1000) == HAL_OK);
+}
+#endif
+
+#if defined(QBOOT_USING_STATS) && defined(DWT_CTRL_CYCCNTENA_Msk)
+#include <qboot_stats.h>
+
+u32 qbt_stats_cycle_get(void)
+{
+    if ((DWT->CTRL & DWT_CTRL_CYCCNTENA_Msk) == 0)
+    {
+        CoreDebug->DEMCR |= CoreDebug_DEMCR_TRCENA_Msk;
+        DWT->CYCCNT = 0;
+        DWT->CTRL |= DWT_CTRL_CYCCNTENA_Msk;
+        qbt_jump_periph_mark(QBOOT_JUMP_PERIPH_CYCCNT);
+    }
+    return(DWT->CYCCNT);
+}
+
+u32 qbt_stats_cycle_freq(void)
+{
+    return(SystemCoreClock);
+}
+#endif
+
 #ifdef QBOOT_APP_RUN_IN_QSPI_FLASH
 static void qbt_qspi_flash_init(void)
 {
@@ -150,10 +262,62 @@ rt_weak void qbt_jump_to_app(void)
     LOG_E("Qboot jump to application fail.");
 }
 #else
+#ifdef QBOOT_USING_FAST_JUMP
+#if defined(QBOOT_USING_HW_CRC) && defined(CRC_CR_REV_OUT)
+static void qbt_crc_deinit(void)
+{
+    #ifdef __HAL_RCC_CRC_FORCE_RESET
+    __HAL_RCC_CRC_FORCE_RESET();
+    __HAL_RCC_CRC_RELEASE_RESET();
+    #endif
+    __HAL_RCC_CRC_CLK_DISABLE();
+}
+#endif
+
+#if defined(QBOOT_USING_AES) && defined(QBOOT_USING_HW_AES) && defined(HAL_CRYP_MODULE_ENABLED)
+static void qbt_aes_deinit(void)
+{
+    #ifdef __HAL_RCC_CRYP_CLK_ENABLE
+    __HAL_RCC_CRYP_FORCE_RESET();
+    __HAL_RCC_CRYP_RELEASE_RESET();
+    __HAL_RCC_CRYP_CLK_DISABLE();
+    #else
+    __HAL_RCC_AES_FORCE_RESET();
+    __HAL_RCC_AES_RELEASE_RESET();
+    __HAL_RCC_AES_CLK_DISABLE();
+    #endif
+}
+#endif
+
+static void qbt_bus_reset(void)
+{
+    HAL_DeInit();
+}
+
+static void qbt_clock_reset(void)
+{
+    HAL_RCC_DeInit();
+}
+
+static const qbt_jump_periph_t qbt_jump_periph_tab[] = {
+    #if defined(QBOOT_USING_HW_CRC) && defined(CRC_CR_REV_OUT)
+    {QBOOT_JUMP_PERIPH_CRC, qbt_crc_deinit},
+    #endif
+    #if defined(QBOOT_USING_AES) && defined(QBOOT_USING_HW_AES) && defined(HAL_CRYP_MODULE_ENABLED)
+    {QBOOT_JUMP_PERIPH_AES, qbt_aes_deinit},
+    #endif
+    {QBOOT_JUMP_PERIPH_ALWAYS, RT_NULL},//end of table, it is never empty
+};
+
+static const qbt_jump_port_t qbt_jump_port = {
+    qbt_jump_periph_tab, sizeof(qbt_jump_periph_tab) / sizeof(qbt_jump_periph_tab[0]), qbt_bus_reset, qbt_clock_reset
+};
+#endif
+
 rt_weak void qbt_jump_to_app(void)
 {
     typedef void (*app_func_t)(void);
-    u32 app_addr = QBOOT_APP_ADDR;
+    u32 app_addr = qbt_app_addr_get();
     u32 stk_addr = *((__IO uint32_t *)app_addr);
     app_func_t app_func = (app_func_t)(*((__IO uint32_t *)(app_addr + 4)));
 
@@ -164,7 +328,13 @@ rt_weak void qbt_jump_to_app(void)
     }
 
     rt_kprintf("Jump to application running ... \n");
-    rt_thread_mdelay(200);
+    #ifdef QBOOT_USING_FAST_JUMP
+    qbt_jump_app_run(&qbt_jump_port, stk_addr, (u32)app_func);
+    #else
+    if (rt_thread_self() != RT_NULL)//not in early jump before the scheduler starts
+    {
+        rt_thread_mdelay(200);
+    }
     
     __disable_irq();
     HAL_DeInit();
@@ -184,6 +354,7 @@ rt_weak void qbt_jump_to_app(void)
     __set_MSP(stk_addr);
     
     app_func();//Jump to application running
+    #endif
     
     LOG_E("Qboot jump to application fail.");
 }
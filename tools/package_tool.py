@@ -1,26 +1,59 @@
 '''
 Author: your name
 Date: 2021-07-15 10:05:16
-LastEditTime: 2025-09-25 08:00:00
-LastEditors: wdfk_prog
+LastEditTime: 2026-10-14 10:00:00
+LastEditors: qboot
 Description: Packages a binary patch file into an RBL package, using the new firmware file for header metadata.
+             Packages a firmware file into an RBL package without compression, with gzip, quicklz, fastlz or lz4.
+             Blocks are compressed in parallel, the algorithm and block size can be selected by the qboot bench output.
+             The package body can be encrypted by AES-256 in CBC or CTR mode.
+             Packs several RBL packages into one manifest package, released in one boot.
 FilePath: /pkg/package_tool.py
 '''
 import os
+import re
 import struct
 import zlib
 import sys
+from concurrent.futures import ProcessPoolExecutor
 
 # --- C语言宏定义对应的Python常量 ---
 
 # 加密算法
 QBOOT_ALGO_CRYPT_NONE = 0
+QBOOT_ALGO_CRYPT_AES = 2
+QBOOT_ALGO_CRYPT_AES_CTR = 3
+
+# 与Bootloader默认的QBOOT_AES_KEY, QBOOT_AES_IV一致, 不足32/16字节时补0
+QBOOT_AES_KEY = '0123456789ABCDEF0123456789ABCDEF'
+QBOOT_AES_IV = '0123456789ABCDEF'
 
 # 压缩算法 (用于告知Bootloader包体类型是差分补丁)
+QBOOT_ALGO_CMPRS_NONE = (0 << 8)
+QBOOT_ALGO_CMPRS_GZIP = (1 << 8)
+QBOOT_ALGO_CMPRS_QUICKLZ = (2 << 8)
+QBOOT_ALGO_CMPRS_FASTLZ = (3 << 8)
 QBOOT_ALGO_CMPRS_HPATCHLITE = (4 << 8)
+QBOOT_ALGO_CMPRS_LZ4 = (5 << 8)
 
 # 校验算法
 QBOOT_ALGO2_VERIFY_CRC = 1
+# 包头后为块索引
+QBOOT_ALGO2_BLOCK_INDEX = 0x10
+QBOOT_IDX_MAGIC = 0x58444951
+# 包头后为镜像表, 每个镜像为完整的RBL包
+QBOOT_ALGO2_MANIFEST = 0x20
+QBOOT_MNF_MAGIC = 0x464E4D51
+QBOOT_MNF_IMG_MAX_NUM = 8
+
+# 分块压缩的默认块大小, 不能大于Bootloader的QBOOT_BLOCK_SIZE
+QBOOT_CMPRS_BLOCK_SIZE = 4096
+# gzip默认窗口位数, 不能大于Bootloader的QBOOT_GZIP_WINDOW_BITS
+QBOOT_GZIP_WINDOW_BITS = 15
+# 自动选择时尝试的最小块大小, 逐次加倍到-b指定的块大小
+QBOOT_AUTO_MIN_BLOCK_SIZE = 1024
+# quicklz块按level 3编码, Bootloader的quicklz软件包需使用相同的QLZ_COMPRESSION_LEVEL
+QBOOT_QUICKLZ_LEVEL = 3
 
 
 def crc32(bytes_obj):
@@ -104,12 +137,534 @@ def package_patch(patch_file, new_file, output_file):
     print(f"Successfully created RBL patch package: '{output_file}'")
 
 
+def lz4_block_compress(block):
+    """LZ4块格式压缩, 优先使用lz4模块的高压缩比模式, 未安装时使用贪婪匹配"""
+    try:
+        import lz4.block
+        return lz4.block.compress(block, mode='high_compression', compression=12, store_size=False)
+    except ImportError:
+        pass
+
+    def put_len(out, length):
+        while length >= 255:
+            out.append(255)
+            length -= 255
+        out.append(length)
+
+    def put_seq(out, literals, dist, match_len):
+        lit_len = len(literals)
+        token = min(lit_len, 15) << 4
+        if match_len:
+            token |= min(match_len - 4, 15)
+        out.append(token)
+        if lit_len >= 15:
+            put_len(out, lit_len - 15)
+        out += literals
+        if match_len:
+            out += struct.pack('<H', dist)
+            if match_len - 4 >= 15:
+                put_len(out, match_len - 4 - 15)
+
+    out = bytearray()
+    table = {}
+    ip = anchor = 0
+    end = len(block)
+    while ip + 12 <= end:  # 最后一个匹配距块尾至少12字节
+        seq = block[ip:ip + 4]
+        ref = table.get(seq)
+        table[seq] = ip
+        if ref is not None and ip - ref <= 0xFFFF:
+            match_len = 4
+            while ip + match_len < end - 5 and block[ref + match_len] == block[ip + match_len]:  # 最后5字节为文字
+                match_len += 1
+            put_seq(out, block[anchor:ip], ip - ref, match_len)
+            ip += match_len
+            anchor = ip
+            continue
+        ip += 1
+    put_seq(out, block[anchor:], 0, 0)
+    return bytes(out)
+
+
+def fastlz_block_compress(block):
+    """FastLZ level 1块格式压缩, 贪婪匹配, 首个指令为文字"""
+    out = bytearray()
+
+    def put_literals(literals):
+        for pos in range(0, len(literals), 32):
+            run = literals[pos:pos + 32]
+            out.append(len(run) - 1)
+            out.extend(run)
+
+    table = {}
+    ip = anchor = 0
+    end = len(block)
+    while ip + 3 <= end:
+        seq = block[ip:ip + 3]
+        ref = table.get(seq)
+        table[seq] = ip
+        if ref is not None and ip - ref <= 8191:
+            match_len = 3
+            while ip + match_len < end and match_len < 264 and block[ref + match_len] == block[ip + match_len]:
+                match_len += 1
+            put_literals(block[anchor:ip])
+            dist = ip - ref - 1
+            if match_len - 2 < 7:
+                out.append(((match_len - 2) << 5) | (dist >> 8))
+            else:
+                out.append((7 << 5) | (dist >> 8))
+                out.append(match_len - 9)
+            out.append(dist & 0xFF)
+            ip += match_len
+            anchor = ip
+            continue
+        ip += 1
+    put_literals(block[anchor:])
+    return bytes(out)
+
+
+def quicklz_block_compress(block):
+    """QuickLZ level 3块格式压缩, 带9字节长包头; 每个32位控制字管31个指令, 距块尾11字节内只有文字"""
+    size = len(block)
+    tail = size - 11  # 解压时从此处之后的首个文字起, 余下全部按文字复制
+    body = bytearray(4)
+    state = {'cword_pos': 0, 'bits': 0, 'num': 0}
+
+    def put_token(is_match, data):
+        if state['num'] == 31:
+            struct.pack_into('<I', body, state['cword_pos'], state['bits'] | (1 << 31))
+            state.update(cword_pos=len(body), bits=0, num=0)
+            body.extend(bytes(4))
+        if is_match:
+            state['bits'] |= 1 << state['num']
+        state['num'] += 1
+        body.extend(data)
+
+    table = {}
+    ip = 0
+    while ip < size:
+        if ip < tail:
+            seq = block[ip:ip + 3]
+            ref = table.get(seq)
+            ofs = ip - ref if ref is not None else 0
+            if ref is None or ofs >= 3:  # 连续相同数据保留较早的位置
+                table[seq] = ip
+            if 3 <= ofs <= 0x1FFFF and tail - ip >= 3:  # 解压时按3字节步长复制, 偏移不小于3
+                limit = min(tail - ip, 258)
+                match_len = 3
+                while match_len < limit and block[ref + match_len] == block[ip + match_len]:
+                    match_len += 1
+                if match_len > 3 or ofs < 16384:
+                    if match_len == 3 and ofs < 64:
+                        token = struct.pack('<B', ofs << 2)
+                    elif match_len == 3:
+                        token = struct.pack('<H', (ofs << 2) | 1)
+                    elif match_len <= 18 and ofs < 1024:
+                        token = struct.pack('<H', (ofs << 6) | ((match_len - 3) << 2) | 2)
+                    elif match_len <= 33:
+                        token = struct.pack('<I', (ofs << 7) | ((match_len - 2) << 2) | 3)[:3]
+                    else:
+                        token = struct.pack('<I', (ofs << 15) | ((match_len - 3) << 7) | 3)
+                    put_token(True, token)
+                    ip += match_len
+                    continue
+        put_token(False, block[ip:ip + 1])
+        ip += 1
+    struct.pack_into('<I', body, state['cword_pos'], state['bits'] | (1 << 31))
+
+    flags = (QBOOT_QUICKLZ_LEVEL << 2) | (1 << 6) | 2  # 长包头
+    if len(body) >= size:  # 不可压缩, 存储原始数据
+        return struct.pack('<BII', flags, 9 + size, size) + block
+    return struct.pack('<BII', flags | 1, 9 + len(body), size) + bytes(body)
+
+
+BLOCK_COMPRESSORS = {
+    'quicklz': (quicklz_block_compress, QBOOT_ALGO_CMPRS_QUICKLZ),
+    'fastlz': (fastlz_block_compress, QBOOT_ALGO_CMPRS_FASTLZ),
+    'lz4': (lz4_block_compress, QBOOT_ALGO_CMPRS_LZ4),
+}
+
+
+def _compress_block(args):
+    cmprs, block = args
+    block = BLOCK_COMPRESSORS[cmprs][0](block)
+    return struct.pack('>I', len(block)) + block  # 每块前为4字节大端块长度
+
+
+def compress_blocks(fw_obj, cmprs, blk_size, jobs):
+    """按块独立压缩, jobs大于1时分配到多个进程"""
+    tasks = [(cmprs, fw_obj[pos:pos + blk_size]) for pos in range(0, len(fw_obj), blk_size)]
+    if jobs <= 1 or len(tasks) <= 1:
+        return [_compress_block(task) for task in tasks]
+    with ProcessPoolExecutor(max_workers=jobs) as pool:
+        return list(pool.map(_compress_block, tasks, chunksize=max(1, len(tasks) // (jobs * 4))))
+
+
+def _aes_tables():
+    """生成AES的S盒及乘2表"""
+    sbox = [0] * 256
+    p = q = 1
+    while True:
+        p = (p ^ (p << 1) ^ (0x1B if p & 0x80 else 0)) & 0xFF  # p乘3
+        q ^= q << 1  # q除3
+        q ^= q << 2
+        q ^= q << 4
+        q &= 0xFF
+        if q & 0x80:
+            q ^= 0x09
+        x = q ^ ((q << 1 | q >> 7) & 0xFF) ^ ((q << 2 | q >> 6) & 0xFF) ^ ((q << 3 | q >> 5) & 0xFF) ^ ((q << 4 | q >> 4) & 0xFF)
+        sbox[p] = x ^ 0x63
+        if p == 1:
+            break
+    sbox[0] = 0x63
+    xtime = [((a << 1) ^ (0x1B if a & 0x80 else 0)) & 0xFF for a in range(256)]
+    return sbox, xtime
+
+
+class Aes256:
+    """AES-256加密, 仅用于打包, 与Bootloader中tinycrypt或硬件解密对应"""
+    SBOX, XTIME = _aes_tables()
+
+    def __init__(self, key):
+        sbox = self.SBOX
+        w = [list(key[i:i + 4]) for i in range(0, 32, 4)]
+        rcon = 1
+        for i in range(8, 60):
+            t = list(w[i - 1])
+            if i % 8 == 0:
+                t = [sbox[t[1]] ^ rcon, sbox[t[2]], sbox[t[3]], sbox[t[0]]]
+                rcon = self.XTIME[rcon]
+            elif i % 8 == 4:
+                t = [sbox[b] for b in t]
+            w.append([a ^ b for a, b in zip(w[i - 8], t)])
+        self.round_keys = [sum(w[r * 4:r * 4 + 4], []) for r in range(15)]
+
+    def encrypt_block(self, block):
+        sbox, xtime = self.SBOX, self.XTIME
+        s = [a ^ b for a, b in zip(block, self.round_keys[0])]
+        for r in range(1, 15):
+            s = [sbox[s[(i + 4 * (i % 4)) % 16]] for i in range(16)]  # 字节代换及行移位
+            if r < 14:
+                m = []
+                for c in range(0, 16, 4):
+                    a0, a1, a2, a3 = s[c:c + 4]
+                    t = a0 ^ a1 ^ a2 ^ a3
+                    m += [a0 ^ t ^ xtime[a0 ^ a1], a1 ^ t ^ xtime[a1 ^ a2], a2 ^ t ^ xtime[a2 ^ a3], a3 ^ t ^ xtime[a3 ^ a0]]
+                s = m
+            s = [a ^ b for a, b in zip(s, self.round_keys[r])]
+        return bytes(s)
+
+
+def _aes_ctr_chunk(args):
+    key, ctr, chunk = args
+    aes = Aes256(key)
+    out = bytearray()
+    for pos in range(0, len(chunk), 16):
+        stream = aes.encrypt_block(ctr.to_bytes(16, 'big'))
+        out += bytes(a ^ b for a, b in zip(chunk[pos:pos + 16], stream))
+        ctr = (ctr + 1) & ((1 << 128) - 1)
+    return bytes(out)
+
+
+def aes_encrypt(pkg_obj, mode, key_str=QBOOT_AES_KEY, iv_str=QBOOT_AES_IV, jobs=1):
+    """加密包体: cbc补0到16字节整数倍, ctr的计数器为128位大端, 初值为iv; ctr分段在多个进程中加密, cbc只能顺序加密"""
+    key = key_str.encode('utf-8')[:32].ljust(32, b'\0')
+    iv = iv_str.encode('utf-8')[:16].ljust(16, b'\0')
+    if mode == 'aes':
+        aes = Aes256(key)
+        out = bytearray()
+        if len(pkg_obj) % 16:
+            pkg_obj += b'\0' * (16 - len(pkg_obj) % 16)
+        chain = iv
+        for pos in range(0, len(pkg_obj), 16):
+            chain = aes.encrypt_block(bytes(a ^ b for a, b in zip(pkg_obj[pos:pos + 16], chain)))
+            out += chain
+        return bytes(out)
+
+    ctr = int.from_bytes(iv, 'big')
+    chunk_size = 16 * 1024
+    tasks = [(key, (ctr + pos // 16) & ((1 << 128) - 1), pkg_obj[pos:pos + chunk_size]) for pos in range(0, len(pkg_obj), chunk_size)]
+    if jobs <= 1 or len(tasks) <= 1:
+        return b''.join(_aes_ctr_chunk(task) for task in tasks)
+    with ProcessPoolExecutor(max_workers=jobs) as pool:
+        return b''.join(pool.map(_aes_ctr_chunk, tasks))
+
+
+def build_block_index(fw_obj, blocks, blk_size):
+    """块索引: 索引头(magic, 块数, 块大小, 索引CRC) + 每块(包体内偏移, 压缩长度, 原始长度, 原始数据CRC) + 各块数据"""
+    entry_obj = b''
+    ofs = 16 + 16 * len(blocks)
+    for i, block in enumerate(blocks):
+        raw = fw_obj[i * blk_size:(i + 1) * blk_size]
+        entry_obj += struct.pack('<IIII', ofs, len(block), len(raw), crc32(raw))
+        ofs += len(block)
+    hdr_obj = struct.pack('<IIII', QBOOT_IDX_MAGIC, len(blocks), blk_size, crc32(entry_obj))
+    return hdr_obj + entry_obj + b''.join(blocks)
+
+
+def build_body(fw_obj, cmprs, index, blk_size, wbits, jobs):
+    """生成未加密的包体, 返回(包体, algo, algo2)"""
+    if cmprs == 'gzip':
+        # 与Bootloader中inflateInit2(.., 32 + QBOOT_GZIP_WINDOW_BITS)一致, 使用gzip格式, gzip流不能分块并行压缩
+        compressor = zlib.compressobj(9, zlib.DEFLATED, 16 + wbits)
+        pkg_obj = compressor.compress(fw_obj) + compressor.flush()
+        algo = QBOOT_ALGO_CMPRS_GZIP
+    elif cmprs in BLOCK_COMPRESSORS:
+        blocks = compress_blocks(fw_obj, cmprs, blk_size, jobs)
+        pkg_obj = b''.join(blocks)
+        algo = BLOCK_COMPRESSORS[cmprs][1]
+    else:
+        blocks = [fw_obj[pos:pos + blk_size] for pos in range(0, len(fw_obj), blk_size)]
+        pkg_obj = fw_obj
+        algo = QBOOT_ALGO_CMPRS_NONE
+
+    algo2 = QBOOT_ALGO2_VERIFY_CRC
+    if index:
+        pkg_obj = build_block_index(fw_obj, blocks, blk_size)
+        algo2 |= QBOOT_ALGO2_BLOCK_INDEX
+    return pkg_obj, algo, algo2
+
+
+BENCH_LINE = re.compile(r'^\|\s*(Flash read|Flash write|Flash erase|CRC32|Decrypt|Decode)\s+(\S*)\s*\|\s*(\d+) KB/s')
+
+
+def bench_load(bench_file):
+    """读取qboot bench命令的输出, 返回{(项目, 名称): KB/s}, 没有解压速度的算法未编入Bootloader"""
+    speeds = {}
+    with open(bench_file, encoding='utf-8', errors='ignore') as f:
+        for line in f:
+            m = BENCH_LINE.match(line.strip())
+            if m and (m.group(1), m.group(2)) not in speeds:
+                speeds[(m.group(1), m.group(2))] = int(m.group(3))
+    return speeds
+
+
+def release_time_predict(speeds, cmprs, crypt, raw_size, pkg_size, dst_part):
+    """预测设备上的释放耗时(ms): 包体校验、应用校验及释放各读一遍包体, 应用校验及释放各解密、解压一遍,
+       包体及两遍代码计算CRC, 目标分区擦除、写入并回读校验"""
+    def cost(item, name, size):
+        kbps = speeds.get((item, name))
+        if kbps is None and item.startswith('Flash'):  # bench的写入擦除速度是临时分区的
+            kbps = next((v for (i, n), v in speeds.items() if i == item), None)
+        return size * 1000 / 1024 / kbps if kbps else 0.0
+
+    ms = 3 * cost('Flash read', 'download', pkg_size) + cost('CRC32', '', pkg_size + 2 * raw_size)
+    if cmprs != 'none':
+        ms += 2 * cost('Decode', cmprs.upper(), raw_size)
+    if crypt != 'none':
+        ms += 2 * cost('Decrypt', 'AES-CBC' if crypt == 'aes' else 'AES-CTR', pkg_size)
+    ms += cost('Flash erase', dst_part, raw_size) + cost('Flash write', dst_part, raw_size) + cost('Flash read', dst_part, raw_size)
+    return ms
+
+
+def select_algorithm(fw_obj, bench_file, index, max_blk_size, wbits, crypt, part_name_str, jobs):
+    """按bench结果预测各算法及块大小的释放耗时, 返回耗时最短的(算法, 块大小, 包体, algo, algo2)"""
+    speeds = bench_load(bench_file)
+    if not speeds:
+        print(f"Error: no qboot bench result in '{bench_file}'")
+        sys.exit(1)
+    blk_sizes = []
+    size = QBOOT_AUTO_MIN_BLOCK_SIZE
+    while size < max_blk_size:
+        blk_sizes.append(size)
+        size *= 2
+    blk_sizes.append(max_blk_size)
+
+    candidates = [('none', max_blk_size)]
+    for cmprs in ('gzip', 'quicklz', 'fastlz', 'lz4'):
+        if ('Decode', cmprs.upper()) not in speeds or (index and cmprs in ('gzip', 'quicklz')):
+            continue
+        candidates += [(cmprs, max_blk_size)] if cmprs == 'gzip' else [(cmprs, size) for size in blk_sizes]
+
+    best = None
+    print(f"{'algorithm':<10} {'block':>6} {'package':>10} {'predicted':>12}")
+    for cmprs, size in candidates:
+        pkg_obj, algo, algo2 = build_body(fw_obj, cmprs, index, size, wbits, jobs)
+        pkg_size = (len(pkg_obj) + 15) & ~15 if crypt == 'aes' else len(pkg_obj)
+        ms = release_time_predict(speeds, cmprs, crypt, len(fw_obj), pkg_size, part_name_str)
+        blk_str = str(size) if cmprs in BLOCK_COMPRESSORS or index else '-'
+        print(f"{cmprs:<10} {blk_str:>6} {pkg_size:>10} {ms:>9.1f} ms")
+        if best is None or ms < best[0]:
+            best = (ms, cmprs, size, pkg_obj, algo, algo2)
+    print(f"Selected {best[1]}, block size {best[2]}, predicted release time {best[0]:.1f} ms")
+    return best[1:]
+
+
+def package_firmware(fw_file, output_file, cmprs, index=False, blk_size=QBOOT_CMPRS_BLOCK_SIZE, wbits=QBOOT_GZIP_WINDOW_BITS,
+                     crypt='none', key_str=QBOOT_AES_KEY, iv_str=QBOOT_AES_IV, part_name_str='app', jobs=1, bench_file=None):
+    """为一个固件文件添加RBL头部, 包体不压缩或以gzip、quicklz、fastlz、lz4压缩, 可带块索引, 可AES加密"""
+    print(f"--- Packaging Firmware File: '{fw_file}', compression: {cmprs}, encryption: {crypt}, block index: {index}, block size: {blk_size} ---")
+
+    with open(fw_file, "rb") as f:
+        fw_obj = f.read()
+    print(f"Read firmware file '{fw_file}', size: {len(fw_obj)}")
+
+    # 块索引包的块需可单独解压并直接读取, 不能为gzip流, quicklz块, 也不加密
+    if index and cmprs in ('gzip', 'quicklz'):
+        print(f"Error: block index is not supported by {cmprs}")
+        sys.exit(1)
+    if index and crypt != 'none':
+        print("Error: block index is not supported by encryption")
+        sys.exit(1)
+
+    if cmprs == 'auto':
+        cmprs, blk_size, pkg_obj, algo, algo2 = select_algorithm(fw_obj, bench_file, index, blk_size, wbits, crypt, part_name_str, jobs)
+    else:
+        pkg_obj, algo, algo2 = build_body(fw_obj, cmprs, index, blk_size, wbits, jobs)
+    if crypt == 'none':
+        algo |= QBOOT_ALGO_CRYPT_NONE
+    else:
+        pkg_obj = aes_encrypt(pkg_obj, crypt, key_str, iv_str, jobs)
+        algo |= QBOOT_ALGO_CRYPT_AES if crypt == 'aes' else QBOOT_ALGO_CRYPT_AES_CTR
+    print(f"Package body size: {len(pkg_obj)}")
+
+    my_head = create_firmware_header(
+        new_fw_obj=fw_obj,
+        patch_obj=pkg_obj,
+        algo=algo,
+        algo2=algo2,
+        timestamp=os.path.getmtime(fw_file),
+        part_name_str=part_name_str,
+        fw_ver_str='v1.00',
+        prod_code_str='00010203040506070809'
+    )
+
+    with open(output_file, "wb") as f:
+        f.write(my_head)
+        f.write(pkg_obj)
+    print(f"Successfully created RBL package: '{output_file}'")
+
+
+def package_manifest(img_files, output_file):
+    """镜像表: 表头(magic, 镜像数, 保留, 表CRC) + 每镜像(包体内偏移, 镜像大小) + 各镜像, 镜像按4字节对齐"""
+    print(f"--- Packaging Manifest of {len(img_files)} images ---")
+
+    imgs = []
+    for img_file in img_files:
+        with open(img_file, "rb") as f:
+            img_obj = f.read()
+        if len(img_obj) < 96 or img_obj[:3] != b'RBL':
+            print(f"Error: '{img_file}' is not an RBL package")
+            sys.exit(1)
+        algo2, = struct.unpack_from('<H', img_obj, 6)
+        pkg_size, = struct.unpack_from('<I', img_obj, 88)
+        if algo2 & QBOOT_ALGO2_MANIFEST or len(img_obj) < 96 + pkg_size:
+            print(f"Error: '{img_file}' is a manifest or is truncated")
+            sys.exit(1)
+        img_obj = img_obj[:96 + pkg_size]
+        print(f"Image {len(imgs)}: '{img_file}' to {img_obj[12:28].rstrip(bytes(1)).decode('utf-8')}, size: {len(img_obj)}")
+        imgs.append(img_obj)
+
+    entry_obj = b''
+    data_obj = b''
+    ofs = 16 + 8 * len(imgs)
+    for img_obj in imgs:
+        data_obj += b'\xFF' * ((-(ofs + len(data_obj))) & 3)
+        entry_obj += struct.pack('<II', ofs + len(data_obj), len(img_obj))
+        data_obj += img_obj
+    hdr_obj = struct.pack('<IIII', QBOOT_MNF_MAGIC, len(imgs), 0, crc32(entry_obj))
+    pkg_obj = hdr_obj + entry_obj + data_obj
+
+    # 外层包不加密不压缩, 产品码取第一个镜像的
+    my_head = create_firmware_header(
+        new_fw_obj=b'',
+        patch_obj=pkg_obj,
+        algo=QBOOT_ALGO_CRYPT_NONE | QBOOT_ALGO_CMPRS_NONE,
+        algo2=QBOOT_ALGO2_MANIFEST,
+        timestamp=max(os.path.getmtime(img_file) for img_file in img_files),
+        part_name_str='manifest',
+        fw_ver_str='v1.00',
+        prod_code_str=imgs[0][52:76].rstrip(bytes(1)).decode('utf-8')
+    )
+
+    with open(output_file, "wb") as f:
+        f.write(my_head)
+        f.write(pkg_obj)
+    print(f"Successfully created manifest package: '{output_file}', size: {len(my_head) + len(pkg_obj)}")
+
+
+def print_usage():
+    print(f"\nUsage: python {os.path.basename(sys.argv[0])} <patch_file> <new_file> [output_file]")
+    print(f"       python {os.path.basename(sys.argv[0])} -c none|gzip|quicklz|fastlz|lz4|auto [-i] [-b block_size] [-w window_bits] [-e none|aes|aes-ctr] [-k key] [-v iv] [-p part_name] [-j jobs] [-t bench.txt] <fw_file> [output_file]")
+    print(f"       python {os.path.basename(sys.argv[0])} -m <output_file> <rbl_file> [rbl_file ...]")
+    print("\n  <patch_file>: The binary patch data (e.g., from hdiffi).")
+    print("  <new_file>:   The new version file, used for header metadata (raw_size, raw_crc).")
+    print("  -c:           Package <fw_file> itself, without compression, with gzip, quicklz, fastlz or lz4.")
+    print(f"                quicklz blocks are of level {QBOOT_QUICKLZ_LEVEL}, the quicklz package of bootloader must use the same QLZ_COMPRESSION_LEVEL.")
+    print("                auto selects the algorithm and block size of the shortest release time predicted by -t.")
+    print("  -i:           Add block index with crc of every block, not for gzip and quicklz.")
+    print(f"  -b:           Raw block size of quicklz, fastlz, lz4 and block index, default {QBOOT_CMPRS_BLOCK_SIZE}, no larger than QBOOT_BLOCK_SIZE.")
+    print(f"                It is the largest block size tried by auto, from {QBOOT_AUTO_MIN_BLOCK_SIZE}.")
+    print(f"  -w:           Window bits of gzip, 9 ~ 15, default {QBOOT_GZIP_WINDOW_BITS}, no larger than QBOOT_GZIP_WINDOW_BITS.")
+    print("  -e:           Encrypt package body by AES-256, aes is CBC mode, aes-ctr is CTR mode, default none.")
+    print("  -k, -v:       Key and iv of AES, same as QBOOT_AES_KEY and QBOOT_AES_IV, default the ones of qboot.h.")
+    print("  -p:           Destination partition of the package, default app.")
+    print("  -j:           Processes compressing blocks and encrypting aes-ctr in parallel, default the count of cpu cores.")
+    print("  -t:           Output of the 'qboot bench' command of the device, for auto.")
+    print(f"  -m:           Pack up to {QBOOT_MNF_IMG_MAX_NUM} RBL packages into one manifest package, the images are released in one boot.")
+
+
 if __name__ == "__main__":
+    # 固件打包模式
+    if len(sys.argv) >= 2 and sys.argv[1] == '-c':
+        args = sys.argv[2:]
+        index = '-i' in args
+        if index:
+            args.remove('-i')
+        opts = {'-b': QBOOT_CMPRS_BLOCK_SIZE, '-w': QBOOT_GZIP_WINDOW_BITS, '-j': os.cpu_count() or 1}
+        for opt in opts:
+            if opt in args:
+                i = args.index(opt)
+                if i + 1 >= len(args) or not args[i + 1].isdigit():
+                    print_usage()
+                    sys.exit(1)
+                opts[opt] = int(args[i + 1])
+                del args[i:i + 2]
+        strs = {'-e': 'none', '-k': QBOOT_AES_KEY, '-v': QBOOT_AES_IV, '-p': 'app', '-t': None}
+        for opt in strs:
+            if opt in args:
+                i = args.index(opt)
+                if i + 1 >= len(args):
+                    print_usage()
+                    sys.exit(1)
+                strs[opt] = args[i + 1]
+                del args[i:i + 2]
+        if opts['-b'] == 0 or opts['-j'] == 0 or not 9 <= opts['-w'] <= 15 or strs['-e'] not in ('none', 'aes', 'aes-ctr') or not 0 < len(strs['-p']) < 16:
+            print_usage()
+            sys.exit(1)
+        if len(args) < 2 or len(args) > 3 or args[0] not in ('none', 'gzip', 'quicklz', 'fastlz', 'lz4', 'auto'):
+            print_usage()
+            sys.exit(1)
+        if args[0] == 'auto' and (strs['-t'] is None or not os.path.exists(strs['-t'])):
+            print("Error: auto needs the qboot bench output file of -t")
+            sys.exit(1)
+        fw_file = args[1]
+        if not os.path.exists(fw_file):
+            print(f"Error: Firmware file not found at '{fw_file}'")
+            sys.exit(1)
+        if len(args) == 3:
+            output_file = args[2]
+        else:
+            output_file = f"{os.path.splitext(fw_file)[0]}.rbl"
+        package_firmware(fw_file, output_file, args[0], index, opts['-b'], opts['-w'], strs['-e'], strs['-k'], strs['-v'], strs['-p'],
+                         opts['-j'], strs['-t'])
+        sys.exit(0)
+
+    # 多镜像打包模式
+    if len(sys.argv) >= 2 and sys.argv[1] == '-m':
+        if len(sys.argv) < 4 or len(sys.argv) > 3 + QBOOT_MNF_IMG_MAX_NUM:
+            print_usage()
+            sys.exit(1)
+        for img_file in sys.argv[3:]:
+            if not os.path.exists(img_file):
+                print(f"Error: Package file not found at '{img_file}'")
+                sys.exit(1)
+        package_manifest(sys.argv[3:], sys.argv[2])
+        sys.exit(0)
+
     # 检查命令行参数数量
     if len(sys.argv) < 3 or len(sys.argv) > 4:
-        print(f"\nUsage: python {os.path.basename(sys.argv[0])} <patch_file> <new_file> [output_file]")
-        print("\n  <patch_file>: The binary patch data (e.g., from hdiffi).")
-        print("  <new_file>:   The new version file, used for header metadata (raw_size, raw_crc).")
+        print_usage()
         sys.exit(1)
 
     # 获取输入文件
@@ -0,0 +1,19 @@
+/*
+ * crc32.h
+ *
+ * Host simulation shim, only the parts used by qboot.
+ *
+ * Change Logs:
+ * Date           Author            Notes
+ * 2026-10-14     qboot             first version
+ */
+
+#ifndef __CRC32_H__
+#define __CRC32_H__
+
+#include <stdint.h>
+
+uint32_t crc32_cal(uint8_t *buf, uint32_t len);
+uint32_t crc32_cyc_cal(uint32_t crc, uint8_t *buf, uint32_t len);
+
+#endif
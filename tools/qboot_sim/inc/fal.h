@@ -0,0 +1,45 @@
+/*
+ * fal.h
+ *
+ * Host simulation shim, only the parts used by qboot.
+ *
+ * Change Logs:
+ * Date           Author            Notes
+ * 2026-10-14     qboot             first version
+ */
+
+#ifndef __FAL_H__
+#define __FAL_H__
+
+#include <rtthread.h>
+#include <fal_cfg.h>
+
+struct fal_flash_dev
+{
+    char name[24];
+    uint32_t addr;
+    size_t len;
+    size_t blk_size;
+};
+
+struct fal_partition
+{
+    uint32_t magic_word;
+    char name[24];
+    char flash_name[24];
+    long offset;
+    size_t len;
+    uint32_t reserved;
+};
+typedef struct fal_partition *fal_partition_t;
+
+int fal_init(void);
+const struct fal_flash_dev *fal_flash_device_find(const char *name);
+const struct fal_partition *fal_partition_find(const char *name);
+const struct fal_partition *fal_get_partition_table(size_t *len);
+int fal_partition_read(const struct fal_partition *part, uint32_t addr, uint8_t *buf, size_t size);
+int fal_partition_write(const struct fal_partition *part, uint32_t addr, const uint8_t *buf, size_t size);
+int fal_partition_erase(const struct fal_partition *part, uint32_t addr, size_t size);
+int fal_partition_erase_all(const struct fal_partition *part);
+
+#endif
@@ -0,0 +1,16 @@
+/*
+ * fal_cfg.h
+ *
+ * Host simulation shim, only the parts used by qboot.
+ *
+ * Change Logs:
+ * Date           Author            Notes
+ * 2026-10-14     qboot             first version
+ */
+
+#ifndef __FAL_CFG_H__
+#define __FAL_CFG_H__
+
+//the partition table is in qboot_sim_fal.c
+
+#endif
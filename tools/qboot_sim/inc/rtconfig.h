@@ -0,0 +1,16 @@
+/*
+ * rtconfig.h
+ *
+ * Host simulation shim, only the parts used by qboot.
+ *
+ * Change Logs:
+ * Date           Author            Notes
+ * 2026-10-14     qboot             first version
+ */
+
+#ifndef __RTCONFIG_H__
+#define __RTCONFIG_H__
+
+#define RT_CONSOLE_DEVICE_NAME          "uart1"
+
+#endif
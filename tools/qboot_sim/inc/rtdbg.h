@@ -0,0 +1,27 @@
+/*
+ * rtdbg.h
+ *
+ * Host simulation shim, only the parts used by qboot.
+ *
+ * Change Logs:
+ * Date           Author            Notes
+ * 2026-10-14     qboot             first version
+ */
+
+#ifndef DBG_LVL
+#define DBG_LVL                         DBG_INFO
+#endif
+
+#define DBG_ERROR                       3
+#define DBG_WARNING                     4
+#define DBG_INFO                        6
+#define DBG_LOG                         7
+
+#undef LOG_E
+#undef LOG_W
+#undef LOG_I
+#undef LOG_D
+#define LOG_E(...)                      do { printf("E: " __VA_ARGS__); printf("\n"); } while (0)
+#define LOG_W(...)                      do { printf("W: " __VA_ARGS__); printf("\n"); } while (0)
+#define LOG_I(...)                      do { if (DBG_LVL >= DBG_INFO) { printf("I: " __VA_ARGS__); printf("\n"); } } while (0)
+#define LOG_D(...)                      do { if (DBG_LVL >= DBG_LOG) { printf("D: " __VA_ARGS__); printf("\n"); } } while (0)
@@ -0,0 +1,31 @@
+/*
+ * rtdevice.h
+ *
+ * Host simulation shim, only the parts used by qboot.
+ *
+ * Change Logs:
+ * Date           Author            Notes
+ * 2026-10-14     qboot             first version
+ */
+
+#ifndef __RTDEVICE_H__
+#define __RTDEVICE_H__
+
+#include <rtthread.h>
+
+#define PIN_MODE_INPUT_PULLUP           2
+#define PIN_MODE_INPUT_PULLDOWN         3
+
+#define RT_DEVICE_OFLAG_RDWR            0x003
+#define RT_DEVICE_FLAG_INT_RX           0x100
+#define RT_DEVICE_FLAG_STREAM           0x040
+
+void rt_pin_mode(rt_base_t pin, rt_base_t mode);
+int rt_pin_read(rt_base_t pin);
+rt_device_t rt_device_find(const char *name);
+rt_err_t rt_device_open(rt_device_t dev, rt_uint16_t oflag);
+rt_err_t rt_device_close(rt_device_t dev);
+rt_size_t rt_device_read(rt_device_t dev, rt_base_t pos, void *buffer, rt_size_t size);
+rt_err_t rt_device_set_rx_indicate(rt_device_t dev, rt_err_t (*rx_ind)(rt_device_t dev, rt_size_t size));
+
+#endif
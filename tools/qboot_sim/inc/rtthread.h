@@ -0,0 +1,93 @@
+/*
+ * rtthread.h
+ *
+ * Host simulation shim, only the parts used by qboot.
+ *
+ * Change Logs:
+ * Date           Author            Notes
+ * 2026-10-14     qboot             first version
+ */
+
+#ifndef __RTTHREAD_H__
+#define __RTTHREAD_H__
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <stdint.h>
+#include <rtconfig.h>
+
+typedef int                             rt_err_t;
+typedef signed int                      rt_int32_t;
+typedef unsigned char                   rt_uint8_t;
+typedef unsigned short                  rt_uint16_t;
+typedef unsigned int                    rt_uint32_t;
+typedef unsigned long                   rt_size_t;
+typedef unsigned long                   rt_tick_t;
+typedef long                            rt_base_t;
+typedef unsigned long                   rt_ubase_t;
+
+#define RT_EOK                          0
+#define RT_ERROR                        1
+#define RT_NULL                         ((void *)0)
+#define RT_WAITING_FOREVER              -1
+#define RT_IPC_FLAG_FIFO                0
+#define RT_TICK_PER_SECOND              1000
+#define RT_USING_HEAP
+
+#define rt_weak                         __attribute__((weak))
+#define rt_used                         __attribute__((used))
+#define rt_section(x)                   __attribute__((section(x)))
+#define rt_inline                       static inline
+
+struct rt_thread { int dummy; };
+typedef struct rt_thread *rt_thread_t;
+struct rt_semaphore { int dummy; };
+typedef struct rt_semaphore *rt_sem_t;
+struct rt_object { int dummy; };
+typedef struct rt_object *rt_object_t;
+struct rt_device { int dummy; };
+typedef struct rt_device *rt_device_t;
+
+enum { RT_Object_Class_Semaphore = 2 };
+
+#define rt_kprintf                      printf
+#define rt_memset                       memset
+#define rt_memcpy                       memcpy
+#define rt_malloc                       malloc
+#define rt_free                         free
+
+#define INIT_BOARD_EXPORT(fn)
+#define INIT_PREV_EXPORT(fn)
+#define INIT_DEVICE_EXPORT(fn)
+#define INIT_COMPONENT_EXPORT(fn)
+#define INIT_ENV_EXPORT(fn)
+#define INIT_APP_EXPORT(fn)
+#define MSH_CMD_EXPORT(cmd, desc)
+#define MSH_CMD_EXPORT_ALIAS(cmd, alias, desc)
+
+#define FINSH_THREAD_NAME               "tshell"
+#define FINSH_SEM_NAME                  "shrx"
+
+rt_tick_t rt_tick_get(void);
+rt_tick_t rt_tick_from_millisecond(rt_int32_t ms);
+rt_err_t rt_thread_mdelay(rt_int32_t ms);
+rt_thread_t rt_thread_self(void);
+rt_thread_t rt_thread_create(const char *name, void (*entry)(void *), void *parameter, rt_uint32_t stack_size, rt_uint8_t priority, rt_uint32_t tick);
+rt_err_t rt_thread_startup(rt_thread_t thread);
+rt_err_t rt_thread_delete(rt_thread_t thread);
+rt_err_t rt_thread_detach(rt_thread_t thread);
+rt_thread_t rt_thread_find(char *name);
+rt_sem_t rt_sem_create(const char *name, rt_uint32_t value, rt_uint8_t flag);
+rt_err_t rt_sem_delete(rt_sem_t sem);
+rt_err_t rt_sem_detach(rt_sem_t sem);
+rt_err_t rt_sem_take(rt_sem_t sem, rt_int32_t timeout);
+rt_err_t rt_sem_release(rt_sem_t sem);
+rt_object_t rt_object_find(const char *name, rt_uint8_t type);
+int rt_object_is_systemobject(rt_object_t object);
+void rt_memory_info(rt_size_t *total, rt_size_t *used, rt_size_t *max_used);
+void rt_hw_cpu_reset(void);
+rt_base_t rt_hw_interrupt_disable(void);
+void rt_hw_interrupt_enable(rt_base_t level);
+
+#endif
@@ -0,0 +1,16 @@
+/*
+ * shell.h
+ *
+ * Host simulation shim, only the parts used by qboot.
+ *
+ * Change Logs:
+ * Date           Author            Notes
+ * 2026-10-14     qboot             first version
+ */
+
+#ifndef __SHELL_H__
+#define __SHELL_H__
+
+void finsh_set_prompt(const char *prompt);
+
+#endif
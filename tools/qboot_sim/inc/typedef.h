@@ -0,0 +1,33 @@
+/*
+ * typedef.h
+ *
+ * Host simulation shim, only the parts used by qboot.
+ *
+ * Change Logs:
+ * Date           Author            Notes
+ * 2026-10-14     qboot             first version
+ */
+
+#ifndef __TYPEDEF_H__
+#define __TYPEDEF_H__
+
+#include <stdbool.h>
+#include <stdint.h>
+
+//fixed width on 64 bits host, so fw_info_t keeps the layout of the package
+typedef int8_t                          s8;
+typedef int16_t                         s16;
+typedef int32_t                         s32;
+typedef int64_t                         s64;
+
+typedef uint8_t                         u8;
+typedef uint16_t                        u16;
+typedef uint32_t                        u32;
+typedef uint64_t                        u64;
+
+typedef float                           f32;
+typedef double                          f64;
+
+typedef void (*PHOOK_t)(void);
+
+#endif
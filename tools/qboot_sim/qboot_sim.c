@@ -0,0 +1,496 @@
+/*
+ * qboot_sim.c
+ *
+ * Host simulation and benchmark driver of the qboot release engine.
+ * qboot.c is built into this file, so its static functions are exercised as they are on target.
+ *
+ * Build from the root of qboot, options to be tested are given by -D, e.g.:
+ *   gcc -O2 -g -Itools/qboot_sim/inc -Iinc -DQBOOT_USING_GZIP -DQBOOT_USING_CRC_SLICE8 \
+ *       tools/qboot_sim/qboot_sim*.c $(ls src/qboot_*.c | grep -v -e stm32 -e gd32 -e at32 -e n32 -e hc32) \
+ *       -lz -lpthread -o qboot_sim
+ * LZ4 is built with -DQBOOT_USING_LZ4, QuickLZ, FastLZ, AES and HPatchLite need the sources of their packages, add them with -I and the .c files.
+ *
+ * Packages are made by tools/package_tool.py, e.g.:
+ *   python tools/package_tool.py -c lz4 app.bin app.rbl
+ *   ./qboot_sim -n 20 -r app.bin release app.rbl
+ * Partitions released from a manifest package are compared by -r part=raw.bin.
+ *
+ * Change Logs:
+ * Date           Author            Notes
+ * 2026-10-14     qboot             first version
+ */
+
+#include "../../src/qboot.c"
+#include "qboot_sim.h"
+#include <getopt.h>
+#include <time.h>
+
+#define QBOOT_SIM_RAW_MAX_NUM           8
+
+typedef struct {
+    const char *image_dir;
+    const char *raw_file[QBOOT_SIM_RAW_MAX_NUM];//[part=]raw.bin, the released partition if part is not given
+    int raw_num;
+    int loops;
+    long corrupt_ofs;                   //offset of package body to be corrupted, -1 if not
+    u32 corrupt_val;
+}qbt_sim_opt_t;
+
+static qbt_sim_opt_t sim_opt = {NULL, {NULL}, 0, 1, -1, 0x00100000};
+static u8 *sim_pkg = NULL;
+static u32 sim_pkg_len = 0;
+static int sim_jump_cnt = 0;
+
+void qbt_jump_to_app(void)
+{
+    sim_jump_cnt++;
+    rt_kprintf("[sim] jump to application of 0x%08X\n", qbt_app_addr_get());
+}
+
+static u64 qbt_sim_time_us(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return((u64)ts.tv_sec * 1000000 + ts.tv_nsec / 1000);
+}
+
+static u8 *qbt_sim_file_read(const char *file_name, u32 *len)
+{
+    FILE *fp = fopen(file_name, "rb");
+    u8 *buf = NULL;
+    long size;
+
+    if (fp == NULL)
+    {
+        printf("[sim] open %s fail.\n", file_name);
+        return(NULL);
+    }
+    fseek(fp, 0, SEEK_END);
+    size = ftell(fp);
+    fseek(fp, 0, SEEK_SET);
+    buf = malloc((size > 0) ? size : 1);
+    if ((buf != NULL) && (fread(buf, 1, size, fp) != (size_t)size))
+    {
+        free(buf);
+        buf = NULL;
+    }
+    fclose(fp);
+    *len = size;
+    return(buf);
+}
+
+static u8 *qbt_sim_pkg_load(const char *file_name, u32 *len)//the package is corrupted by -c, its crc is kept
+{
+    u8 *buf = qbt_sim_file_read(file_name, len);
+
+    if ((buf != NULL) && (sim_opt.corrupt_ofs >= 0))
+    {
+        u32 pos = sizeof(fw_info_t) + sim_opt.corrupt_ofs;
+        if (pos + 4 > *len)
+        {
+            printf("[sim] corrupt offset is out of package.\n");
+            free(buf);
+            return(NULL);
+        }
+        for (int i = 0; i < 4; i++)//big endian, as the block header of lz4 and fastlz
+        {
+            buf[pos + i] = (u8)(sim_opt.corrupt_val >> (24 - 8 * i));
+        }
+        printf("[sim] package body is corrupted at %ld to %08X.\n", sim_opt.corrupt_ofs, sim_opt.corrupt_val);
+    }
+    return(buf);
+}
+
+static void qbt_sim_counter_show(u32 pkg_len, u32 raw_size)
+{
+    size_t part_num = 0;
+    const struct fal_partition *part_tbl = fal_get_partition_table(&part_num);
+
+    printf("| %-9s | %6s %9s | %6s %9s | %6s %9s | %s\n", "partition", "reads", "bytes", "writes", "bytes", "erases", "bytes", "passes(read/write)");
+    for (size_t i = 0; i < part_num; i++)
+    {
+        const qbt_sim_counter_t *cnt = qbt_sim_fal_counter(part_tbl[i].name);
+        u32 used = (strcmp(part_tbl[i].name, QBOOT_DOWNLOAD_PART_NAME) == 0) ? pkg_len : raw_size;//data size of a full pass
+        if ((cnt->rd_cnt == 0) && (cnt->wr_cnt == 0) && (cnt->er_cnt == 0))
+        {
+            continue;
+        }
+        printf("| %-9s | %6u %9llu | %6u %9llu | %6u %9llu | %.2f/%.2f", part_tbl[i].name,
+               cnt->rd_cnt, (unsigned long long)cnt->rd_bytes, cnt->wr_cnt, (unsigned long long)cnt->wr_bytes,
+               cnt->er_cnt, (unsigned long long)cnt->er_bytes,
+               (used > 0) ? (double)cnt->rd_bytes / used : 0.0, (used > 0) ? (double)cnt->wr_bytes / used : 0.0);
+        if (cnt->prog_err > 0)
+        {
+            printf("  %u bytes programmed without erase", cnt->prog_err);
+        }
+        printf("\n");
+    }
+}
+
+static void qbt_sim_result_show(const char *cmd, int ok_cnt, u64 min_us, u64 total_us, u32 raw_size)
+{
+    printf("[sim] %s: %d/%d ok, min %.3f ms, avg %.3f ms", cmd, ok_cnt, sim_opt.loops, min_us / 1000.0, total_us / 1000.0 / sim_opt.loops);
+    if ((raw_size > 0) && (min_us > 0))
+    {
+        printf(", %.2f MB/s of raw code", (double)raw_size / min_us);
+    }
+    printf(", simulated flash %.3f ms of last run\n", qbt_sim_fal_latency_us() / 1000.0);
+}
+
+static bool qbt_sim_raw_check(const char *part_name)
+{
+    bool rst = true;
+
+    for (int i = 0; i < sim_opt.raw_num; i++)
+    {
+        char name[16] = {0};
+        const char *raw_file = sim_opt.raw_file[i];
+        const char *sep = strchr(raw_file, '=');
+        const u8 *mem;
+        u32 raw_len = 0;
+        u8 *raw;
+        bool same;
+
+        if ((sep != NULL) && (sep - raw_file < sizeof(name)))
+        {
+            memcpy(name, raw_file, sep - raw_file);
+            raw_file = sep + 1;
+        }
+        else
+        {
+            snprintf(name, sizeof(name), "%s", part_name);
+        }
+        mem = qbt_sim_fal_mem(name);
+        raw = qbt_sim_file_read(raw_file, &raw_len);
+        if ((mem == NULL) || (raw == NULL))
+        {
+            printf("[sim] %s partition can not be compared with %s.\n", name, raw_file);
+            free(raw);
+            rst = false;
+            continue;
+        }
+        same = (memcmp(mem, raw, raw_len) == 0);
+        printf("[sim] %s partition %s %s.\n", name, same ? "is same as" : "is different from", raw_file);
+        free(raw);
+        rst = (rst && same);
+    }
+    return(rst);
+}
+
+static int qbt_sim_check(void)
+{
+    u64 min_us = (u64)-1, total_us = 0;
+    int ok_cnt = 0;
+
+    qbt_sim_fal_load(QBOOT_DOWNLOAD_PART_NAME, sim_pkg, sim_pkg_len);
+    for (int i = 0; i < sim_opt.loops; i++)
+    {
+        u64 us;
+        qbt_sim_fal_reset_counter();
+        us = qbt_sim_time_us();
+        ok_cnt += qbt_fw_check(QBOOT_DOWNLOAD_PART_NAME, &fw_info, QBOOT_CHECK_APP, true) ? 1 : 0;
+        us = qbt_sim_time_us() - us;
+        min_us = (us < min_us) ? us : min_us;
+        total_us += us;
+    }
+    qbt_sim_counter_show(sim_pkg_len, fw_info.raw_size);
+    qbt_sim_result_show("check", ok_cnt, min_us, total_us, fw_info.raw_size);
+
+    return((ok_cnt == sim_opt.loops) ? 0 : 1);
+}
+
+static int qbt_sim_release(void)
+{
+    u64 min_us = (u64)-1, total_us = 0;
+    int ok_cnt = 0;
+    const char *dst_part_name = NULL;
+
+    for (int i = 0; i < sim_opt.loops; i++)
+    {
+        u64 us;
+        qbt_sim_fal_load(QBOOT_DOWNLOAD_PART_NAME, sim_pkg, sim_pkg_len);//clear the release sign
+        if (qbt_fw_hdr_check(QBOOT_DOWNLOAD_PART_NAME, &fw_info, true))
+        {
+            dst_part_name = (const char *)fw_info.part_name;
+            #ifdef QBOOT_USING_AB_SLOT
+            dst_part_name = qbt_slot_release_target(dst_part_name);
+            #endif
+        }
+        qbt_sim_fal_reset_counter();
+        us = qbt_sim_time_us();
+        ok_cnt += qbt_release_from_part(QBOOT_DOWNLOAD_PART_NAME, true) ? 1 : 0;
+        us = qbt_sim_time_us() - us;
+        min_us = (us < min_us) ? us : min_us;
+        total_us += us;
+    }
+    qbt_sim_counter_show(sim_pkg_len, fw_info.raw_size);
+    qbt_sim_result_show("release", ok_cnt, min_us, total_us, fw_info.raw_size);
+
+    if ((ok_cnt == sim_opt.loops) && (dst_part_name != NULL) && qbt_sim_raw_check(dst_part_name))
+    {
+        return(0);
+    }
+    return(1);
+}
+
+#ifdef QBOOT_USING_STREAM
+static int qbt_sim_stream(void)
+{
+    u64 min_us = (u64)-1, total_us = 0;
+    int ok_cnt = 0;
+    const char *dst_part_name = NULL;
+
+    for (int i = 0; i < sim_opt.loops; i++)
+    {
+        u64 us;
+        u32 pos = 0;
+        bool rst;
+        srand(i);
+        memcpy(&fw_info, sim_pkg, (sim_pkg_len < sizeof(fw_info_t)) ? sim_pkg_len : sizeof(fw_info_t));
+        dst_part_name = (const char *)fw_info.part_name;
+        #ifdef QBOOT_USING_AB_SLOT
+        dst_part_name = qbt_slot_release_target(dst_part_name);
+        #endif
+        qbt_sim_fal_reset_counter();
+        us = qbt_sim_time_us();
+        rst = qbt_stream_begin();
+        while (rst && (pos < sim_pkg_len))//chunks of random length, as they come from network
+        {
+            u32 len = rand() % 1500 + 1;
+            if (len > sim_pkg_len - pos)
+            {
+                len = sim_pkg_len - pos;
+            }
+            rst = qbt_stream_feed(sim_pkg + pos, len);
+            pos += len;
+        }
+        ok_cnt += (rst && qbt_stream_end()) ? 1 : 0;
+        us = qbt_sim_time_us() - us;
+        min_us = (us < min_us) ? us : min_us;
+        total_us += us;
+    }
+    qbt_sim_counter_show(0, fw_info.raw_size);
+    qbt_sim_result_show("stream", ok_cnt, min_us, total_us, fw_info.raw_size);
+
+    if ((ok_cnt == sim_opt.loops) && qbt_sim_raw_check(dst_part_name))
+    {
+        return(0);
+    }
+    return(1);
+}
+#endif
+
+static int qbt_sim_verify(const char *part_name)
+{
+    u64 min_us = (u64)-1, total_us = 0;
+    int ok_cnt = 0;
+
+    for (int i = 0; i < sim_opt.loops; i++)
+    {
+        u64 us;
+        qbt_sim_fal_reset_counter();
+        us = qbt_sim_time_us();
+        ok_cnt += qbt_dest_part_verify(part_name) ? 1 : 0;
+        us = qbt_sim_time_us() - us;
+        min_us = (us < min_us) ? us : min_us;
+        total_us += us;
+    }
+    qbt_sim_counter_show(0, fw_info.raw_size);
+    qbt_sim_result_show("verify", ok_cnt, min_us, total_us, fw_info.raw_size);
+
+    return((ok_cnt == sim_opt.loops) ? 0 : 1);
+}
+
+#ifdef QBOOT_USING_SHELL
+static int qbt_sim_clone(const char *dst_part_name)
+{
+    u64 min_us = (u64)-1, total_us = 0;
+    int ok_cnt = 0;
+
+    if ( ! qbt_part_is_exist(dst_part_name))
+    {
+        printf("[sim] %s partition is not exist.\n", dst_part_name);
+        return(1);
+    }
+    for (int i = 0; i < sim_opt.loops; i++)
+    {
+        u64 us;
+        qbt_sim_fal_load(QBOOT_DOWNLOAD_PART_NAME, sim_pkg, sim_pkg_len);
+        qbt_sim_fal_reset_counter();
+        us = qbt_sim_time_us();
+        ok_cnt += (qbt_fw_check(QBOOT_DOWNLOAD_PART_NAME, &fw_info, QBOOT_CHECK_HDR, true)
+                   && qbt_fw_clone(dst_part_name, QBOOT_DOWNLOAD_PART_NAME, &fw_info)) ? 1 : 0;
+        us = qbt_sim_time_us() - us;
+        min_us = (us < min_us) ? us : min_us;
+        total_us += us;
+    }
+    qbt_sim_counter_show(sim_pkg_len, sim_pkg_len);
+    qbt_sim_result_show("clone", ok_cnt, min_us, total_us, 0);
+
+    return(((ok_cnt == sim_opt.loops) && qbt_sim_raw_check(dst_part_name)) ? 0 : 1);
+}
+#endif
+
+static bool qbt_sim_flash_opt(char *arg)//flash:sector[:erase_us[:prog_us[:read_ns]]]
+{
+    const struct fal_flash_dev *flash_dev;
+    qbt_sim_flash_cfg_t cfg = {0};
+    char *name = strtok(arg, ":");
+    char *val[4] = {0};
+
+    for (int i = 0; i < 4; i++)
+    {
+        val[i] = strtok(NULL, ":");
+    }
+    flash_dev = (name != NULL) ? fal_flash_device_find(name) : NULL;
+    if ((flash_dev == NULL) || (val[0] == NULL))
+    {
+        return(false);
+    }
+    cfg.sector_size = strtoul(val[0], NULL, 0);
+    cfg.erase_us = (val[1] != NULL) ? strtoul(val[1], NULL, 0) : 0;
+    cfg.prog_us = (val[2] != NULL) ? strtoul(val[2], NULL, 0) : 0;
+    cfg.read_ns = (val[3] != NULL) ? strtoul(val[3], NULL, 0) : 0;
+
+    return(qbt_sim_fal_config(name, &cfg));
+}
+
+static void qbt_sim_usage(const char *prog)
+{
+    printf("Usage: %s [options] command\n", prog);
+    printf("commands:\n");
+    printf("  check pkg.rbl         - check package body and code in download partition\n");
+    printf("  release pkg.rbl       - write package into download partition and release it\n");
+    printf("  verify part           - verify released code of partition\n");
+    #ifdef QBOOT_USING_SHELL
+    printf("  clone pkg.rbl part    - write package into download partition and clone it to part, compare part with -r pkg.rbl\n");
+    #endif
+    #ifdef QBOOT_USING_STREAM
+    printf("  stream pkg.rbl        - feed package in chunks of random length to the stream release\n");
+    #endif
+    printf("options:\n");
+    printf("  -d dir                - directory of flash images, kept between runs, memory only if not given\n");
+    printf("  -n loops              - repeat the command, default 1\n");
+    printf("  -r [part=]raw.bin     - raw firmware the released partition or part must be same as, can be given %d times\n", QBOOT_SIM_RAW_MAX_NUM);
+    printf("  -f flash:sector[:erase_us[:prog_us[:read_ns]]]\n");
+    printf("                        - sector size and latency of onchip_flash or norflash0, program latency is of 256 bytes\n");
+    printf("  -S                    - sleep for the simulated flash latency\n");
+    printf("  -x                    - programming bits not erased fails\n");
+    printf("  -p writes             - power is lost at the given count of flash writes, use with -d to resume\n");
+    printf("  -c ofs[:val]          - 4 bytes of package body at ofs are set to val, default 0x00100000 as a broken block header\n");
+}
+
+int main(int argc, char **argv)
+{
+    int ch;
+    int rst = 1;
+
+    while ((ch = getopt(argc, argv, "d:n:r:f:Sxp:c:h")) != -1)
+    {
+        switch (ch)
+        {
+        case 'd':
+            sim_opt.image_dir = optarg;
+            break;
+        case 'n':
+            sim_opt.loops = atoi(optarg);
+            break;
+        case 'r':
+            if (sim_opt.raw_num >= QBOOT_SIM_RAW_MAX_NUM)
+            {
+                printf("[sim] too many raw files.\n");
+                return(1);
+            }
+            sim_opt.raw_file[sim_opt.raw_num++] = optarg;
+            break;
+        case 'f':
+            if ( ! qbt_sim_flash_opt(optarg))
+            {
+                printf("[sim] flash option error.\n");
+                return(1);
+            }
+            break;
+        case 'S':
+            qbt_sim_fal_set_sleep(true);
+            break;
+        case 'x':
+            qbt_sim_fal_set_strict(true);
+            break;
+        case 'p':
+            qbt_sim_fal_set_power_loss(strtoul(optarg, NULL, 0));
+            break;
+        case 'c':
+            sim_opt.corrupt_ofs = strtol(optarg, &optarg, 0);
+            if (*optarg == ':')
+            {
+                sim_opt.corrupt_val = strtoul(optarg + 1, NULL, 0);
+            }
+            break;
+        default:
+            qbt_sim_usage(argv[0]);
+            return(1);
+        }
+    }
+    if ((optind + 2 > argc) || (sim_opt.loops <= 0))
+    {
+        qbt_sim_usage(argv[0]);
+        return(1);
+    }
+
+    if (( ! qbt_sim_fal_open(sim_opt.image_dir)) || (fal_init() <= 0))
+    {
+        printf("[sim] flash initialize fail.\n");
+        return(1);
+    }
+
+    if (strcmp(argv[optind], "verify") == 0)
+    {
+        rst = qbt_sim_verify(argv[optind + 1]);
+    }
+    else if ((strcmp(argv[optind], "check") == 0) || (strcmp(argv[optind], "release") == 0))
+    {
+        sim_pkg = qbt_sim_pkg_load(argv[optind + 1], &sim_pkg_len);
+        if (sim_pkg == NULL)
+        {
+            return(1);
+        }
+        rst = (strcmp(argv[optind], "check") == 0) ? qbt_sim_check() : qbt_sim_release();
+        free(sim_pkg);
+    }
+    #ifdef QBOOT_USING_SHELL
+    else if ((strcmp(argv[optind], "clone") == 0) && (optind + 3 <= argc))
+    {
+        sim_pkg = qbt_sim_pkg_load(argv[optind + 1], &sim_pkg_len);
+        if (sim_pkg == NULL)
+        {
+            return(1);
+        }
+        rst = qbt_sim_clone(argv[optind + 2]);
+        free(sim_pkg);
+    }
+    #endif
+    #ifdef QBOOT_USING_STREAM
+    else if (strcmp(argv[optind], "stream") == 0)
+    {
+        sim_pkg = qbt_sim_pkg_load(argv[optind + 1], &sim_pkg_len);
+        if (sim_pkg == NULL)
+        {
+            return(1);
+        }
+        rst = qbt_sim_stream();
+        free(sim_pkg);
+    }
+    #endif
+    else
+    {
+        qbt_sim_usage(argv[0]);
+        return(1);
+    }
+
+    if ( ! qbt_sim_fal_save())
+    {
+        rst = 1;
+    }
+    return(rst);
+}
+
@@ -0,0 +1,50 @@
+/*
+ * qboot_sim.h
+ *
+ * Host simulation of the qboot release engine.
+ *
+ * Change Logs:
+ * Date           Author            Notes
+ * 2026-10-14     qboot             first version
+ */
+
+#ifndef __QBOOT_SIM_H__
+#define __QBOOT_SIM_H__
+
+#include <rtthread.h>
+#include <fal.h>
+#include <typedef.h>
+
+#define QBOOT_SIM_PROG_PAGE_SIZE        256//program latency is counted by page
+
+typedef struct {
+    u32 rd_cnt;
+    u64 rd_bytes;
+    u32 wr_cnt;
+    u64 wr_bytes;
+    u32 er_cnt;
+    u64 er_bytes;
+    u32 prog_err;                       //bits programmed from 0 to 1, flash is not erased
+}qbt_sim_counter_t;
+
+typedef struct {
+    u32 sector_size;
+    u32 erase_us;                       //latency of a sector erase
+    u32 prog_us;                        //latency of a page program
+    u32 read_ns;                        //latency of a byte read
+}qbt_sim_flash_cfg_t;
+
+bool qbt_sim_fal_config(const char *flash_name, const qbt_sim_flash_cfg_t *cfg);
+void qbt_sim_fal_set_sleep(bool sleep);//sleep for the latency, or only count it
+void qbt_sim_fal_set_strict(bool strict);//programming not erased bits fails, or only counted
+void qbt_sim_fal_set_power_loss(u32 write_cnt);//images are saved and the process exits at the write_cnt write, half of it is written
+bool qbt_sim_fal_open(const char *image_dir);//NULL to keep images in memory only
+bool qbt_sim_fal_save(void);
+bool qbt_sim_fal_load(const char *part_name, const u8 *buf, u32 len);//erase the partition and write buf, not counted
+u8 *qbt_sim_fal_mem(const char *part_name);
+void qbt_sim_fal_reset_counter(void);
+const qbt_sim_counter_t *qbt_sim_fal_counter(const char *part_name);
+u64 qbt_sim_fal_latency_us(void);//simulated flash time since counters reset
+
+#endif
+
@@ -0,0 +1,343 @@
+/*
+ * qboot_sim_fal.c
+ *
+ * File backed FAL with NOR flash semantics, configurable sector size and simulated latency.
+ *
+ * Change Logs:
+ * Date           Author            Notes
+ * 2026-10-14     qboot             first version
+ */
+
+#include "qboot_sim.h"
+#include <qboot_map.h>
+#include <unistd.h>
+
+#define QBOOT_SIM_FLASH_NUM             (sizeof(sim_flash) / sizeof(sim_flash[0]))
+#define QBOOT_SIM_PART_NUM              (sizeof(sim_part) / sizeof(sim_part[0]))
+
+typedef struct {
+    struct fal_flash_dev dev;
+    qbt_sim_flash_cfg_t cfg;
+    u8 *mem;
+}qbt_sim_flash_t;
+
+static qbt_sim_flash_t sim_flash[] = {
+    {{"onchip_flash", 0x08000000, 0x100000, 4096}, {4096, 20000, 30, 0}},
+    {{"norflash0",    0x00000000, 0x200000, 4096}, {4096, 45000, 700, 10}},
+};
+
+static const struct fal_partition sim_part[] = {
+    {0, "app",      "onchip_flash", 0x020000, 0x060000, 0},
+    {0, "app_b",    "onchip_flash", 0x080000, 0x060000, 0},
+    {0, "qbtmeta",  "onchip_flash", 0x0E0000, 0x004000, 0},
+    {0, "download", "norflash0",    0x000000, 0x080000, 0},
+    {0, "factory",  "norflash0",    0x080000, 0x080000, 0},
+    {0, "swap",     "norflash0",    0x100000, 0x010000, 0},
+    {0, "res",      "norflash0",    0x120000, 0x040000, 0},
+};
+
+static qbt_sim_counter_t sim_counter[QBOOT_SIM_PART_NUM];
+static const char *sim_image_dir = NULL;
+static bool sim_sleep = false;
+static bool sim_strict = false;
+static u64 sim_latency_ns = 0;
+static bool sim_opened = false;
+static u32 sim_power_loss_cnt = 0;
+static u32 sim_write_cnt = 0;
+
+static qbt_sim_flash_t *qbt_sim_flash_of(const char *flash_name)
+{
+    for (int i = 0; i < QBOOT_SIM_FLASH_NUM; i++)
+    {
+        if (strcmp(sim_flash[i].dev.name, flash_name) == 0)
+        {
+            return(&sim_flash[i]);
+        }
+    }
+    return(NULL);
+}
+
+static int qbt_sim_part_index(const struct fal_partition *part)
+{
+    int idx = part - sim_part;
+    return(((idx >= 0) && (idx < QBOOT_SIM_PART_NUM)) ? idx : -1);
+}
+
+static void qbt_sim_latency(u64 ns)
+{
+    rt_base_t level = rt_hw_interrupt_disable();//the pipeline threads access flash too
+    sim_latency_ns += ns;
+    rt_hw_interrupt_enable(level);
+    if (sim_sleep && (ns >= 1000))
+    {
+        usleep(ns / 1000);
+    }
+}
+
+static void qbt_sim_image_path(char *path, size_t size, const qbt_sim_flash_t *flash)
+{
+    snprintf(path, size, "%s/%s.bin", sim_image_dir, flash->dev.name);
+}
+
+bool qbt_sim_fal_config(const char *flash_name, const qbt_sim_flash_cfg_t *cfg)
+{
+    qbt_sim_flash_t *flash = qbt_sim_flash_of(flash_name);
+
+    if ((flash == NULL) || sim_opened || (cfg->sector_size == 0) || (flash->dev.len % cfg->sector_size != 0))
+    {
+        return(false);
+    }
+    flash->cfg = *cfg;
+    flash->dev.blk_size = cfg->sector_size;
+    return(true);
+}
+
+void qbt_sim_fal_set_sleep(bool sleep)
+{
+    sim_sleep = sleep;
+}
+
+void qbt_sim_fal_set_strict(bool strict)
+{
+    sim_strict = strict;
+}
+
+void qbt_sim_fal_set_power_loss(u32 write_cnt)
+{
+    sim_power_loss_cnt = write_cnt;
+    sim_write_cnt = 0;
+}
+
+bool qbt_sim_fal_open(const char *image_dir)
+{
+    char path[512];
+
+    sim_image_dir = image_dir;
+    for (int i = 0; i < QBOOT_SIM_FLASH_NUM; i++)
+    {
+        FILE *fp;
+        qbt_sim_flash_t *flash = &sim_flash[i];
+        flash->mem = malloc(flash->dev.len);
+        if (flash->mem == NULL)
+        {
+            return(false);
+        }
+        memset(flash->mem, 0xFF, flash->dev.len);
+        if (sim_image_dir == NULL)
+        {
+            continue;
+        }
+        qbt_sim_image_path(path, sizeof(path), flash);
+        fp = fopen(path, "rb");
+        if (fp != NULL)//keep the contents of last run
+        {
+            size_t len = fread(flash->mem, 1, flash->dev.len, fp);
+            fclose(fp);
+            if (len != flash->dev.len)
+            {
+                printf("[sim] %s size error, reset to blank.\n", path);
+                memset(flash->mem, 0xFF, flash->dev.len);
+            }
+        }
+    }
+    sim_opened = true;
+    return(true);
+}
+
+bool qbt_sim_fal_save(void)
+{
+    char path[512];
+
+    if (sim_image_dir == NULL)
+    {
+        return(true);
+    }
+    for (int i = 0; i < QBOOT_SIM_FLASH_NUM; i++)
+    {
+        FILE *fp;
+        qbt_sim_image_path(path, sizeof(path), &sim_flash[i]);
+        fp = fopen(path, "wb");
+        if ((fp == NULL) || (fwrite(sim_flash[i].mem, 1, sim_flash[i].dev.len, fp) != sim_flash[i].dev.len))
+        {
+            printf("[sim] save %s fail.\n", path);
+            if (fp != NULL)
+            {
+                fclose(fp);
+            }
+            return(false);
+        }
+        fclose(fp);
+    }
+    return(true);
+}
+
+u8 *qbt_sim_fal_mem(const char *part_name)
+{
+    const struct fal_partition *part = fal_partition_find(part_name);
+    return((part == NULL) ? NULL : qbt_sim_flash_of(part->flash_name)->mem + part->offset);
+}
+
+bool qbt_sim_fal_load(const char *part_name, const u8 *buf, u32 len)
+{
+    const struct fal_partition *part = fal_partition_find(part_name);
+    u8 *mem = qbt_sim_fal_mem(part_name);
+
+    if ((part == NULL) || (len > part->len))
+    {
+        return(false);
+    }
+    memset(mem, 0xFF, part->len);
+    memcpy(mem, buf, len);
+    return(true);
+}
+
+void qbt_sim_fal_reset_counter(void)
+{
+    memset(sim_counter, 0, sizeof(sim_counter));
+    sim_latency_ns = 0;
+}
+
+const qbt_sim_counter_t *qbt_sim_fal_counter(const char *part_name)
+{
+    const struct fal_partition *part = fal_partition_find(part_name);
+    return((part == NULL) ? NULL : &sim_counter[qbt_sim_part_index(part)]);
+}
+
+u64 qbt_sim_fal_latency_us(void)
+{
+    return(sim_latency_ns / 1000);
+}
+
+#ifdef QBOOT_USING_MAPPED_READ
+const u8 *qbt_map_flash_addr(const struct fal_flash_dev *flash)//only the on chip flash is mapped, as it is on target
+{
+    qbt_sim_flash_t *sim = qbt_sim_flash_of(flash->name);
+    return(((sim != NULL) && (sim == &sim_flash[0])) ? sim->mem : NULL);
+}
+#endif
+
+int fal_init(void)
+{
+    if ( ! sim_opened && ! qbt_sim_fal_open(NULL))
+    {
+        return(-1);
+    }
+    return(QBOOT_SIM_PART_NUM);
+}
+
+const struct fal_flash_dev *fal_flash_device_find(const char *name)
+{
+    qbt_sim_flash_t *flash = qbt_sim_flash_of(name);
+    return((flash == NULL) ? NULL : &flash->dev);
+}
+
+const struct fal_partition *fal_partition_find(const char *name)
+{
+    for (int i = 0; i < QBOOT_SIM_PART_NUM; i++)
+    {
+        if (strcmp(sim_part[i].name, name) == 0)
+        {
+            return(&sim_part[i]);
+        }
+    }
+    return(NULL);
+}
+
+const struct fal_partition *fal_get_partition_table(size_t *len)
+{
+    *len = QBOOT_SIM_PART_NUM;
+    return(sim_part);
+}
+
+int fal_partition_read(const struct fal_partition *part, uint32_t addr, uint8_t *buf, size_t size)
+{
+    qbt_sim_flash_t *flash = qbt_sim_flash_of(part->flash_name);
+    qbt_sim_counter_t *cnt = &sim_counter[qbt_sim_part_index(part)];
+
+    if (addr + size > part->len)
+    {
+        printf("[sim] read out of %s, addr = %08X, size = %d\n", part->name, addr, (int)size);
+        return(-1);
+    }
+    memcpy(buf, flash->mem + part->offset + addr, size);
+    cnt->rd_cnt++;
+    cnt->rd_bytes += size;
+    qbt_sim_latency((u64)size * flash->cfg.read_ns);
+
+    return(size);
+}
+
+int fal_partition_write(const struct fal_partition *part, uint32_t addr, const uint8_t *buf, size_t size)
+{
+    qbt_sim_flash_t *flash = qbt_sim_flash_of(part->flash_name);
+    qbt_sim_counter_t *cnt = &sim_counter[qbt_sim_part_index(part)];
+    u8 *mem = flash->mem + part->offset + addr;
+    u32 pages;
+
+    if (addr + size > part->len)
+    {
+        printf("[sim] write out of %s, addr = %08X, size = %d\n", part->name, addr, (int)size);
+        return(-1);
+    }
+    if ((sim_power_loss_cnt > 0) && (++sim_write_cnt >= sim_power_loss_cnt))
+    {
+        size /= 2;//half of the datas are programmed when power is lost
+    }
+    for (size_t i = 0; i < size; i++)
+    {
+        if ((mem[i] & buf[i]) != buf[i])//nor flash only clears bits
+        {
+            if (cnt->prog_err == 0)
+            {
+                printf("[sim] program not erased %s, addr = %08X\n", part->name, (u32)(addr + i));
+            }
+            cnt->prog_err++;
+            if (sim_strict)
+            {
+                return(-1);
+            }
+        }
+        mem[i] &= buf[i];
+    }
+    if ((sim_power_loss_cnt > 0) && (sim_write_cnt >= sim_power_loss_cnt))
+    {
+        printf("\n[sim] power lost at write %u, %s addr = %08X\n", sim_write_cnt, part->name, addr);
+        fflush(stdout);
+        qbt_sim_fal_save();
+        _exit(2);
+    }
+    pages = ((part->offset + addr + size + QBOOT_SIM_PROG_PAGE_SIZE - 1) / QBOOT_SIM_PROG_PAGE_SIZE) - ((part->offset + addr) / QBOOT_SIM_PROG_PAGE_SIZE);
+    cnt->wr_cnt++;
+    cnt->wr_bytes += size;
+    qbt_sim_latency((u64)pages * flash->cfg.prog_us * 1000);
+
+    return(size);
+}
+
+int fal_partition_erase(const struct fal_partition *part, uint32_t addr, size_t size)
+{
+    qbt_sim_flash_t *flash = qbt_sim_flash_of(part->flash_name);
+    qbt_sim_counter_t *cnt = &sim_counter[qbt_sim_part_index(part)];
+    u32 sector = flash->cfg.sector_size;
+    u32 begin, end;
+
+    if (addr + size > part->len)
+    {
+        printf("[sim] erase out of %s, addr = %08X, size = %d\n", part->name, addr, (int)size);
+        return(-1);
+    }
+    begin = (part->offset + addr) / sector * sector;//fal erases the whole sectors
+    end = (part->offset + addr + size + sector - 1) / sector * sector;
+    memset(flash->mem + begin, 0xFF, end - begin);
+    cnt->er_cnt++;
+    cnt->er_bytes += end - begin;
+    qbt_sim_latency((u64)((end - begin) / sector) * flash->cfg.erase_us * 1000);
+
+    return(size);
+}
+
+int fal_partition_erase_all(const struct fal_partition *part)
+{
+    return(fal_partition_erase(part, 0, part->len));
+}
+
@@ -0,0 +1,253 @@
+/*
+ * qboot_sim_rt.c
+ *
+ * RT-Thread kernel, device and crclib functions used by qboot, on POSIX threads.
+ *
+ * Change Logs:
+ * Date           Author            Notes
+ * 2026-10-14     qboot             first version
+ */
+
+#include <rtthread.h>
+#include <rtdevice.h>
+#include <shell.h>
+#include <crc32.h>
+#include <pthread.h>
+#include <semaphore.h>
+#include <errno.h>
+#include <time.h>
+#include <unistd.h>
+#include <zlib.h>
+#ifdef __GLIBC__
+#include <malloc.h>
+#endif
+
+typedef struct {
+    struct rt_thread parent;
+    pthread_t tid;
+    void (*entry)(void *);
+    void *parameter;
+}qbt_sim_thread_t;
+
+typedef struct {
+    struct rt_semaphore parent;
+    sem_t sem;
+}qbt_sim_sem_t;
+
+static struct rt_thread sim_main_thread;
+static __thread rt_thread_t sim_cur_thread = &sim_main_thread;
+
+rt_tick_t rt_tick_get(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return((rt_tick_t)ts.tv_sec * RT_TICK_PER_SECOND + ts.tv_nsec / (1000000000 / RT_TICK_PER_SECOND));
+}
+
+rt_tick_t rt_tick_from_millisecond(rt_int32_t ms)
+{
+    return((rt_tick_t)ms * RT_TICK_PER_SECOND / 1000);
+}
+
+rt_err_t rt_thread_mdelay(rt_int32_t ms)
+{
+    usleep(ms * 1000);
+    return(RT_EOK);
+}
+
+rt_thread_t rt_thread_self(void)
+{
+    return(sim_cur_thread);
+}
+
+static void *qbt_sim_thread_entry(void *parameter)
+{
+    qbt_sim_thread_t *thread = parameter;
+    sim_cur_thread = &thread->parent;
+    thread->entry(thread->parameter);
+    return(NULL);
+}
+
+rt_thread_t rt_thread_create(const char *name, void (*entry)(void *), void *parameter, rt_uint32_t stack_size, rt_uint8_t priority, rt_uint32_t tick)
+{
+    qbt_sim_thread_t *thread = calloc(1, sizeof(qbt_sim_thread_t));
+    if (thread == NULL)
+    {
+        return(RT_NULL);
+    }
+    thread->entry = entry;
+    thread->parameter = parameter;
+    return(&thread->parent);
+}
+
+rt_err_t rt_thread_startup(rt_thread_t thread)
+{
+    qbt_sim_thread_t *sim_thread = (qbt_sim_thread_t *)thread;
+    if (pthread_create(&sim_thread->tid, NULL, qbt_sim_thread_entry, sim_thread) != 0)
+    {
+        return(-RT_ERROR);
+    }
+    pthread_detach(sim_thread->tid);
+    return(RT_EOK);
+}
+
+rt_err_t rt_thread_delete(rt_thread_t thread)
+{
+    return(RT_EOK);//the thread returns from its entry by itself
+}
+
+rt_err_t rt_thread_detach(rt_thread_t thread)
+{
+    return(RT_EOK);
+}
+
+rt_thread_t rt_thread_find(char *name)
+{
+    return(RT_NULL);
+}
+
+rt_sem_t rt_sem_create(const char *name, rt_uint32_t value, rt_uint8_t flag)
+{
+    qbt_sim_sem_t *sem = calloc(1, sizeof(qbt_sim_sem_t));
+    if (sem == NULL)
+    {
+        return(RT_NULL);
+    }
+    sem_init(&sem->sem, 0, value);
+    return(&sem->parent);
+}
+
+rt_err_t rt_sem_delete(rt_sem_t sem)
+{
+    sem_destroy(&((qbt_sim_sem_t *)sem)->sem);
+    free(sem);
+    return(RT_EOK);
+}
+
+rt_err_t rt_sem_detach(rt_sem_t sem)
+{
+    return(RT_EOK);
+}
+
+rt_err_t rt_sem_take(rt_sem_t sem, rt_int32_t timeout)
+{
+    qbt_sim_sem_t *sim_sem = (qbt_sim_sem_t *)sem;
+    struct timespec ts;
+
+    if (timeout < 0)
+    {
+        while (sem_wait(&sim_sem->sem) != 0)
+        {
+            if (errno != EINTR)
+            {
+                return(-RT_ERROR);
+            }
+        }
+        return(RT_EOK);
+    }
+
+    clock_gettime(CLOCK_REALTIME, &ts);
+    ts.tv_sec += timeout / RT_TICK_PER_SECOND;
+    ts.tv_nsec += (long)(timeout % RT_TICK_PER_SECOND) * (1000000000 / RT_TICK_PER_SECOND);
+    ts.tv_sec += ts.tv_nsec / 1000000000;
+    ts.tv_nsec %= 1000000000;
+    return((sem_timedwait(&sim_sem->sem, &ts) == 0) ? RT_EOK : -RT_ERROR);
+}
+
+rt_err_t rt_sem_release(rt_sem_t sem)
+{
+    sem_post(&((qbt_sim_sem_t *)sem)->sem);
+    return(RT_EOK);
+}
+
+rt_object_t rt_object_find(const char *name, rt_uint8_t type)
+{
+    return(RT_NULL);
+}
+
+int rt_object_is_systemobject(rt_object_t object)
+{
+    return(0);
+}
+
+void rt_memory_info(rt_size_t *total, rt_size_t *used, rt_size_t *max_used)
+{
+    #if defined(__GLIBC__) && (__GLIBC__ * 100 + __GLIBC_MINOR__ >= 233)
+    struct mallinfo2 info = mallinfo2();
+    *total = info.arena;
+    *used = info.uordblks;
+    *max_used = info.uordblks;
+    #else
+    *total = 0;
+    *used = 0;
+    *max_used = 0;
+    #endif
+}
+
+void rt_hw_cpu_reset(void)
+{
+    printf("[sim] cpu reset\n");
+    exit(3);
+}
+
+static pthread_mutex_t sim_irq_lock = PTHREAD_MUTEX_INITIALIZER;
+
+rt_base_t rt_hw_interrupt_disable(void)
+{
+    pthread_mutex_lock(&sim_irq_lock);
+    return(0);
+}
+
+void rt_hw_interrupt_enable(rt_base_t level)
+{
+    pthread_mutex_unlock(&sim_irq_lock);
+}
+
+void rt_pin_mode(rt_base_t pin, rt_base_t mode)
+{
+}
+
+int rt_pin_read(rt_base_t pin)
+{
+    return(1);//factory key is released with pull up
+}
+
+rt_device_t rt_device_find(const char *name)
+{
+    return(RT_NULL);
+}
+
+rt_err_t rt_device_open(rt_device_t dev, rt_uint16_t oflag)
+{
+    return(-RT_ERROR);
+}
+
+rt_err_t rt_device_close(rt_device_t dev)
+{
+    return(RT_EOK);
+}
+
+rt_size_t rt_device_read(rt_device_t dev, rt_base_t pos, void *buffer, rt_size_t size)
+{
+    return(0);
+}
+
+rt_err_t rt_device_set_rx_indicate(rt_device_t dev, rt_err_t (*rx_ind)(rt_device_t dev, rt_size_t size))
+{
+    return(RT_EOK);
+}
+
+void finsh_set_prompt(const char *prompt)
+{
+}
+
+uint32_t crc32_cyc_cal(uint32_t crc, uint8_t *buf, uint32_t len)//crclib keeps the crc without final xor
+{
+    return(~crc32(~crc, buf, len));
+}
+
+uint32_t crc32_cal(uint8_t *buf, uint32_t len)
+{
+    return(crc32(0, buf, len));
+}
+